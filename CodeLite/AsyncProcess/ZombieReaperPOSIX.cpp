@@ -24,6 +24,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "ZombieReaperPOSIX.h"
+#include "asyncprocess.h"
 
 #include "event_notifier.h"
 
@@ -48,6 +49,7 @@ void* ZombieReaperPOSIX::Entry()
         int status(0);
         pid_t pid = ::waitpid((pid_t)-1, &status, WNOHANG);
         if(pid > 0) {
+            IProcess::SetProcessExitCode(pid, WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
             // Notify about this process termination
             wxProcessEvent event(0, pid, status);
             event.SetEventType(wxEVT_CL_PROCESS_TERMINATED);
@@ -37,6 +37,8 @@ class IProcess;
 #include "processreaderthread.h"
 #include "ssh_account_info.h"
 
+#include <atomic>
+#include <stdint.h>
 #include <wx/arrstr.h>
 #include <wx/string.h>
 
@@ -288,20 +290,35 @@ IProcess* CreateSyncProcess(const wxString& cmd, size_t flags, const wxString& w
                               wxEmptyString);
 }
 
+namespace
+{
+// The exit codes of the last processes that terminated, as (pid << 32 | exit code). SetProcessExitCode() is called
+// from the SIGCHLD handler: the table is a ring of lock free atomics, no lock nor allocation is involved
+constexpr size_t EXIT_CODES_COUNT = 256;
+std::atomic<uint64_t> exit_codes[EXIT_CODES_COUNT];
+std::atomic<size_t> exit_codes_next{ 0 };
+} // namespace
+
 // Static methods:
 bool IProcess::GetProcessExitCode(int pid, int& exitCode)
 {
-    wxUnusedVar(pid);
-    wxUnusedVar(exitCode);
-
-    exitCode = 0;
-    return true;
+    // the pids are reused: look for the most recent entry first
+    size_t next = exit_codes_next.load(std::memory_order_acquire);
+    for (size_t i = 0; i < EXIT_CODES_COUNT && i < next; ++i) {
+        uint64_t entry = exit_codes[(next - 1 - i) % EXIT_CODES_COUNT].load(std::memory_order_acquire);
+        if ((int)(uint32_t)(entry >> 32) == pid) {
+            exitCode = (int)(uint32_t)entry;
+            return true;
+        }
+    }
+    return false;
 }
 
 void IProcess::SetProcessExitCode(int pid, int exitCode)
 {
-    wxUnusedVar(pid);
-    wxUnusedVar(exitCode);
+    uint64_t entry = ((uint64_t)(uint32_t)pid << 32) | (uint32_t)exitCode;
+    size_t slot = exit_codes_next.fetch_add(1, std::memory_order_acq_rel) % EXIT_CODES_COUNT;
+    exit_codes[slot].store(entry, std::memory_order_release);
 }
 
 void IProcess::WaitForTerminate(wxString& output)
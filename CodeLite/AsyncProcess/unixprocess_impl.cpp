@@ -156,7 +156,10 @@ void UnixProcessImpl::Cleanup()
         wxKill(GetPid(), GetHardKill() ? wxSIGKILL : wxSIGTERM, NULL, wxKILL_CHILDREN);
         // The Zombie cleanup is done in app.cpp in ::ChildTerminatedSingalHandler() signal handler
         int status(0);
-        waitpid(-1, &status, WNOHANG);
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid > 0) {
+            SetProcessExitCode(pid, WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+        }
     }
 }
 
@@ -484,7 +487,10 @@ void UnixProcessImpl::Terminate()
     wxKill(GetPid(), GetHardKill() ? wxSIGKILL : wxSIGTERM, NULL, wxKILL_CHILDREN);
     int status(0);
     // The real cleanup is done inside ::ChildTerminatedSingalHandler() signal handler (app.cpp)
-    waitpid(-1, &status, WNOHANG);
+    pid_t pid = waitpid(-1, &status, WNOHANG);
+    if (pid > 0) {
+        SetProcessExitCode(pid, WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+    }
 }
 
 bool UnixProcessImpl::WriteToConsole(const wxString& buff)
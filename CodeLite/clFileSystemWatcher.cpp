@@ -3,11 +3,29 @@
 #include <set>
 #include "fileutils.h"
 
+#if !CL_FSW_USE_TIMER
+#include "clFilesCollector.h"
+#include "file_logger.h"
+#include <chrono>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 wxDEFINE_EVENT(wxEVT_FILE_MODIFIED, clFileSystemEvent);
 wxDEFINE_EVENT(wxEVT_FILE_NOT_FOUND, clFileSystemEvent);
+wxDEFINE_EVENT(wxEVT_FILES_CHANGED, clFileSystemEvent);
 
 // In milliseconds
 #define FILE_CHECK_INTERVAL 500
+// The changes are sent once nothing happened for FSW_QUIET_PERIOD, and no later than FSW_MAX_DELAY after the first one
+#define FSW_QUIET_PERIOD 100
+#define FSW_MAX_DELAY 1000
 
 clFileSystemWatcher::clFileSystemWatcher()
     : m_owner(NULL)
@@ -18,19 +36,16 @@ clFileSystemWatcher::clFileSystemWatcher()
 #if CL_FSW_USE_TIMER
     Bind(wxEVT_TIMER, &clFileSystemWatcher::OnTimer, this);
 #else
-    m_watcher.SetOwner(this);
-    Bind(wxEVT_FSWATCHER, &clFileSystemWatcher::OnFileModified, this);
+    m_shutdown.store(false);
+    m_complete.store(true);
 #endif
 }
 
 clFileSystemWatcher::~clFileSystemWatcher()
 {
-#if CL_FSW_USE_TIMER
     Stop();
+#if CL_FSW_USE_TIMER
     Unbind(wxEVT_TIMER, &clFileSystemWatcher::OnTimer, this);
-#else
-    m_watcher.RemoveAll();
-    Unbind(wxEVT_FSWATCHER, &clFileSystemWatcher::OnFileModified, this);
 #endif
 }
 
@@ -46,11 +61,61 @@ void clFileSystemWatcher::SetFile(const wxFileName& filename)
         m_files.insert(std::make_pair(filename.GetFullPath(), f));
     }
 #else
-    m_watcher.RemoveAll();
-    wxFileName dironly = filename;
-    dironly.SetFullName(""); // must be directory only
-    m_watcher.Add(dironly);
-    m_watchedFile = filename; // but we keep the file name for later usage
+    // the worker thread reads the lists: update them while it is stopped
+    bool running = IsRunning();
+    Stop();
+    m_files.clear();
+    m_files.insert(filename.GetFullPath());
+    if(running) {
+        Start();
+    }
+#endif
+}
+
+bool clFileSystemWatcher::AddDirectory(const wxString& path, bool recursive, const wxStringSet_t& excludeFolders)
+{
+#if CL_FSW_USE_TIMER
+    wxUnusedVar(path);
+    wxUnusedVar(recursive);
+    wxUnusedVar(excludeFolders);
+    return false;
+#else
+    bool running = IsRunning();
+    Stop();
+    wxString dir = wxFileName::DirName(path).GetPath();
+    auto iter = std::find_if(m_directories.begin(), m_directories.end(),
+                             [&](const Directory& d) { return d.path == dir; });
+    if(iter == m_directories.end()) {
+        Directory d;
+        d.path = dir;
+        d.recursive = recursive;
+        d.excludeFolders = excludeFolders;
+        m_directories.push_back(d);
+    } else {
+        iter->recursive = recursive;
+        iter->excludeFolders = excludeFolders;
+    }
+    if(running) {
+        Start();
+    }
+    return true;
+#endif
+}
+
+void clFileSystemWatcher::RemoveDirectory(const wxString& path)
+{
+#if CL_FSW_USE_TIMER
+    wxUnusedVar(path);
+#else
+    bool running = IsRunning();
+    Stop();
+    wxString dir = wxFileName::DirName(path).GetPath();
+    m_directories.erase(std::remove_if(m_directories.begin(), m_directories.end(),
+                                       [&](const Directory& d) { return d.path == dir; }),
+                        m_directories.end());
+    if(running) {
+        Start();
+    }
 #endif
 }
 
@@ -62,6 +127,22 @@ void clFileSystemWatcher::Start()
     m_timer = new wxTimer(this);
     m_timer->Start(FILE_CHECK_INTERVAL, true);
 #else
+    Stop();
+
+    m_inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_inotify < 0) {
+        clWARNING() << "File system watcher: inotify_init1 failed:" << strerror(errno) << endl;
+        return;
+    }
+    if(::pipe2(m_wakeupPipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        clWARNING() << "File system watcher: pipe2 failed:" << strerror(errno) << endl;
+        ::close(m_inotify);
+        m_inotify = -1;
+        return;
+    }
+    m_shutdown.store(false);
+    m_complete.store(true);
+    m_thread = new std::thread(&clFileSystemWatcher::WorkerMain, this);
 #endif
 }
 
@@ -73,17 +154,35 @@ void clFileSystemWatcher::Stop()
     }
     wxDELETE(m_timer);
 #else
-    m_watcher.RemoveAll();
+    if(m_thread) {
+        m_shutdown.store(true);
+        char c = 0;
+        if(::write(m_wakeupPipe[1], &c, 1) < 0) {
+            clWARNING() << "File system watcher: failed to wake up the worker thread" << endl;
+        }
+        m_thread->join();
+        wxDELETE(m_thread);
+    }
+    if(m_inotify != -1) {
+        ::close(m_inotify);
+        m_inotify = -1;
+    }
+    for(int& fd : m_wakeupPipe) {
+        if(fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    m_watches.clear();
 #endif
 }
 
 void clFileSystemWatcher::Clear()
 {
-#if CL_FSW_USE_TIMER
     Stop();
     m_files.clear();
-#else
-    m_watcher.RemoveAll();
+#if !CL_FSW_USE_TIMER
+    m_directories.clear();
 #endif
 }
 
@@ -145,15 +244,215 @@ void clFileSystemWatcher::OnTimer(wxTimerEvent& event)
 #endif
 
 #if !CL_FSW_USE_TIMER
-void clFileSystemWatcher::OnFileModified(wxFileSystemWatcherEvent& event)
+bool clFileSystemWatcher::IsUnderDirectory(const wxString& path) const
 {
-    if(event.GetChangeType() == wxFSW_EVENT_MODIFY) {
-        const wxFileName& modpath = event.GetPath();
-        if(modpath == m_watchedFile) {
-            if(GetOwner()) {
-                clFileSystemEvent evt(wxEVT_FILE_MODIFIED);
-                evt.SetPath(modpath.GetFullPath());
-                GetOwner()->AddPendingEvent(evt);
+    for(const Directory& dir : m_directories) {
+        if(path == dir.path) {
+            return true;
+        }
+        if(path.length() > dir.path.length() && path.StartsWith(dir.path) && path[dir.path.length()] == '/') {
+            if(dir.recursive || path.find('/', dir.path.length() + 1) == wxString::npos) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const clFileSystemWatcher::Directory* clFileSystemWatcher::FindRecursiveDirectory(const wxString& path) const
+{
+    for(const Directory& dir : m_directories) {
+        if(dir.recursive && path.StartsWith(dir.path + "/")) {
+            return &dir;
+        }
+    }
+    return nullptr;
+}
+
+bool clFileSystemWatcher::AddWatch(const wxString& dir, const Directory* root)
+{
+    // IN_ATTRIB: `touch`, permissions and timestamps changes are reported as modifications, as the polling did
+    const uint32_t mask = IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                          IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+    std::vector<wxString> Q = { dir };
+    while(!Q.empty()) {
+        wxString path = Q.back();
+        Q.pop_back();
+
+        const wxCharBuffer cpath = path.mb_str(wxConvUTF8);
+        int wd = ::inotify_add_watch(m_inotify, cpath.data(), mask);
+        if(wd < 0) {
+            if(errno == ENOSPC) {
+                clWARNING() << "File system watcher: the inotify watches limit (fs.inotify.max_user_watches) is"
+                            << "reached, not watching:" << path << endl;
+                m_complete.store(false);
+                return false;
+            }
+            continue;
+        }
+        m_watches[wd] = path;
+        if(!root) {
+            continue;
+        }
+
+        DIR* d = ::opendir(cpath.data());
+        if(!d) {
+            continue;
+        }
+        while(struct dirent* entry = ::readdir(d)) {
+            if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            wxString subdir = path + "/" + wxString(entry->d_name, wxConvUTF8);
+            bool isdir = entry->d_type == DT_DIR;
+            if(entry->d_type == DT_UNKNOWN) {
+                // symbolic links are not followed
+                struct stat st;
+                isdir = ::lstat(subdir.mb_str(wxConvUTF8).data(), &st) == 0 && S_ISDIR(st.st_mode);
+            }
+            if(isdir && !clFilesScanner::IsExcludedFolder(root->path, subdir, root->excludeFolders)) {
+                Q.push_back(subdir);
+            }
+        }
+        ::closedir(d);
+    }
+    return true;
+}
+
+void clFileSystemWatcher::WorkerMain()
+{
+    // Watch the folder of each file, since many programs replace a file rather than writing it in place
+    for(const wxString& file : m_files) {
+        AddWatch(wxFileName(file).GetPath(), nullptr);
+    }
+    for(const Directory& dir : m_directories) {
+        AddWatch(dir.path, dir.recursive ? &dir : nullptr);
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    // watched file -> does it exist
+    std::unordered_map<wxString, bool> files;
+    wxStringSet_t changed;
+    bool overflow = false;
+    bool pending = false;
+    Clock::time_point first, last;
+
+    auto flush = [&]() {
+        if(overflow) {
+            // events were lost: report everything
+            for(const wxString& file : m_files) {
+                files[file] = wxFileName::FileExists(file);
+            }
+        }
+        if(m_owner) {
+            for(const auto& vt : files) {
+                clFileSystemEvent evt(vt.second ? wxEVT_FILE_MODIFIED : wxEVT_FILE_NOT_FOUND);
+                evt.SetPath(vt.first);
+                m_owner->QueueEvent(evt.Clone());
+            }
+            if(overflow || !changed.empty()) {
+                wxArrayString paths;
+                if(overflow) {
+                    for(const Directory& dir : m_directories) {
+                        paths.Add(dir.path);
+                    }
+                } else {
+                    paths.Alloc(changed.size());
+                    for(const wxString& path : changed) {
+                        paths.Add(path);
+                    }
+                    paths.Sort();
+                }
+                if(!paths.IsEmpty()) {
+                    clFileSystemEvent evt(wxEVT_FILES_CHANGED);
+                    evt.SetPaths(paths);
+                    m_owner->QueueEvent(evt.Clone());
+                }
+            }
+        }
+        files.clear();
+        changed.clear();
+        overflow = false;
+        pending = false;
+    };
+
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    while(!m_shutdown.load()) {
+        int timeout = -1;
+        if(pending) {
+            Clock::time_point deadline = std::min(last + std::chrono::milliseconds(FSW_QUIET_PERIOD),
+                                                  first + std::chrono::milliseconds(FSW_MAX_DELAY));
+            Clock::time_point now = Clock::now();
+            if(now >= deadline) {
+                flush();
+                continue;
+            }
+            timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+        }
+
+        struct pollfd fds[2] = { { m_inotify, POLLIN, 0 }, { m_wakeupPipe[0], POLLIN, 0 } };
+        int rc = ::poll(fds, 2, timeout);
+        if(rc < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            clWARNING() << "File system watcher: poll failed:" << strerror(errno) << endl;
+            m_complete.store(false);
+            break;
+        }
+        if(!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        ssize_t len = 0;
+        while((len = ::read(m_inotify, buffer, sizeof(buffer))) > 0) {
+            for(char* p = buffer; p < buffer + len;) {
+                const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + ev->len;
+
+                if(ev->mask & IN_Q_OVERFLOW) {
+                    overflow = true;
+                } else {
+                    auto iter = m_watches.find(ev->wd);
+                    if(iter == m_watches.end()) {
+                        continue;
+                    }
+                    if(ev->mask & IN_IGNORED) {
+                        m_watches.erase(iter);
+                        continue;
+                    }
+
+                    wxString path = iter->second;
+                    if(ev->len && ev->name[0]) {
+                        path << "/" << wxString(ev->name, wxConvUTF8);
+                    }
+                    bool is_file = m_files.count(path);
+                    bool is_under_dir = IsUnderDirectory(path);
+                    if(!is_file && !is_under_dir) {
+                        continue;
+                    }
+                    if(is_file) {
+                        // anything but a removal (IN_MODIFY, IN_ATTRIB, IN_CREATE...) is a modification
+                        files[path] = !(ev->mask & (IN_DELETE | IN_MOVED_FROM));
+                    }
+                    if(is_under_dir) {
+                        changed.insert(path);
+                        const Directory* root = nullptr;
+                        if((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO)) &&
+                           (root = FindRecursiveDirectory(path)) != nullptr &&
+                           !clFilesScanner::IsExcludedFolder(root->path, path, root->excludeFolders)) {
+                            // the content of the new folder is reported by the folder path itself
+                            AddWatch(path, root);
+                        }
+                    }
+                }
+
+                Clock::time_point now = Clock::now();
+                if(!pending) {
+                    first = now;
+                    pending = true;
+                }
+                last = now;
             }
         }
     }
@@ -166,6 +465,13 @@ void clFileSystemWatcher::RemoveFile(const wxFileName& filename)
     if(m_files.count(filename.GetFullPath())) {
         m_files.erase(filename.GetFullPath());
     }
+#else
+    bool running = IsRunning();
+    Stop();
+    m_files.erase(filename.GetFullPath());
+    if(running) {
+        Start();
+    }
 #endif
 }
 
@@ -174,6 +480,15 @@ bool clFileSystemWatcher::IsRunning() const
 #if CL_FSW_USE_TIMER
     return m_timer;
 #else
-    return m_watcher.GetWatchedPathsCount();
+    return m_thread != nullptr;
+#endif
+}
+
+bool clFileSystemWatcher::IsComplete() const
+{
+#if CL_FSW_USE_TIMER
+    return true;
+#else
+    return m_complete.load();
 #endif
 }
@@ -7,16 +7,26 @@
 #include <wx/timer.h>
 #include <wx/filename.h>
 
-#ifdef __WXMSW__
-#define CL_FSW_USE_TIMER 1
+#if defined(__linux__)
+#define CL_FSW_USE_TIMER 0
 #else
 #define CL_FSW_USE_TIMER 1
 #endif
 
 #if !CL_FSW_USE_TIMER
-#include <wx/fswatcher.h>
+#include "macros.h"
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #endif
 
+/// Watch files, and on Linux whole directory trees, for changes.
+///
+/// On Linux the watcher is driven by inotify: a worker thread sleeps until the kernel reports a change in one of the
+/// watched directories. Changes are coalesced: the events are sent once the file system stayed quiet for a short
+/// while (or at least once a second during a long burst, e.g. a `git checkout`), with every path reported once. On
+/// the other platforms the watched files are polled with a timer
 class WXDLLIMPEXP_CL clFileSystemWatcher : public wxEvtHandler
 {
 public:
@@ -32,8 +42,22 @@ public:
     clFileSystemWatcher::File::Map_t m_files;
     wxTimer* m_timer;
 #else
-    wxFileSystemWatcher m_watcher;
-    wxFileName m_watchedFile;
+    struct Directory {
+        wxString path;
+        bool recursive = false;
+        /// the sub folders not watched, as in clFilesScanner::Scan()
+        wxStringSet_t excludeFolders;
+    };
+
+    wxStringSet_t m_files;
+    std::vector<Directory> m_directories;
+    int m_inotify = -1;
+    int m_wakeupPipe[2] = { -1, -1 };
+    std::thread* m_thread = nullptr;
+    std::atomic_bool m_shutdown;
+    std::atomic_bool m_complete;
+    /// owned by the worker thread while it runs
+    std::unordered_map<int, wxString> m_watches;
 #endif
 
 public:
@@ -43,7 +67,11 @@ protected:
 #if CL_FSW_USE_TIMER
     void OnTimer(wxTimerEvent& event);
 #else
-    void OnFileModified(wxFileSystemWatcherEvent& event);
+    void WorkerMain();
+    /// watch `dir`, and its sub folders if `root` (the recursive directory it belongs to) is set
+    bool AddWatch(const wxString& dir, const Directory* root);
+    const Directory* FindRecursiveDirectory(const wxString& path) const;
+    bool IsUnderDirectory(const wxString& path) const;
 #endif
 
 public:
@@ -63,10 +91,24 @@ public:
      */
     void RemoveFile(const wxFileName& filename);
 
+    /**
+     * @brief watch the directory `path`, and its sub directories if `recursive` is set, except the ones matching
+     * `excludeFolders` (see clFilesScanner::Scan()). The changes under it are reported with a single
+     * wxEVT_FILES_CHANGED event per burst of changes.
+     * Return false if the platform does not support watching directories
+     */
+    bool AddDirectory(const wxString& path, bool recursive, const wxStringSet_t& excludeFolders = wxStringSet_t());
+
+    /**
+     * @brief stop watching the directory `path`
+     */
+    void RemoveDirectory(const wxString& path);
+
     /**
      * @brief start to watching list of files.
      * This object fires the following events (clFileSystemEvent):
-     * wxEVT_FILE_MODIFIED, wxEVT_FILE_DELETED
+     * wxEVT_FILE_MODIFIED, wxEVT_FILE_NOT_FOUND for the watched files and wxEVT_FILES_CHANGED for the watched
+     * directories
      */
     void Start();
 
@@ -84,9 +126,18 @@ public:
      * @brief is the watcher running?
      */
     bool IsRunning() const;
+
+    /**
+     * @brief false if the watcher failed to watch some of the directories (e.g. the inotify watches limit is reached)
+     * or stopped on an error: the changes under them are not reported, the caller should scan again instead
+     */
+    bool IsComplete() const;
 };
 
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILE_MODIFIED, clFileSystemEvent);
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILE_NOT_FOUND, clFileSystemEvent);
+/// the paths created, modified, deleted or renamed under a watched directory, as GetPaths(). If the kernel dropped
+/// events, the watched directories themselves are reported and should be scanned again
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILES_CHANGED, clFileSystemEvent);
 
 #endif // CLFILESYSTEMWATCHER_H
@@ -66,15 +66,16 @@ bool IsRelPathContainedInSpec(const wxString& rootPath, const wxString& fullPath
     }
     return false;
 }
-} // namespace
 
-size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& filesOutput, const wxString& filespec,
-                            const wxString& excludeFilespec, const wxStringSet_t& excludeFolders)
+/// the scan behind the Scan() overloads that take the exclude folders as a set: `on_file` is called with the folder
+/// (including the trailing separator) and the name of every file collected
+void DoScan(const wxString& rootFolder, const wxString& filespec, const wxString& excludeFilespec,
+            const wxStringSet_t& excludeFolders,
+            const std::function<void(const wxString& dirWithSep, const wxString& filename)>& on_file)
 {
-    filesOutput.clear();
     if (!wxFileName::DirExists(rootFolder)) {
         clDEBUG() << "clFilesScanner: No such dir:" << rootFolder << clEndl;
-        return 0;
+        return;
     }
 
 #ifdef __WXMSW__
@@ -99,15 +100,17 @@ size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& f
             continue;
         }
 
+        wxString dirWithSep = dir.GetNameWithSep();
         wxString filename;
         bool cont = dir.GetFirst(&filename);
         while (cont) {
             // Check to see if this is a folder
             wxString fullpath;
-            fullpath << dir.GetNameWithSep() << filename;
+            fullpath << dirWithSep << filename;
+            wxString matchName = filename;
 
 #ifdef __WXMSW__
-            filename.MakeLower();
+            matchName.MakeLower();
 #endif
             bool isDirectory = wxFileName::DirExists(fullpath);
             // Use FileUtils::RealPath() here to cope with symlinks on Linux
@@ -127,18 +130,98 @@ size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& f
                     Q.push(fullpath);
                 }
 
-            } else if (!isDirectory && FileUtils::WildMatch(excludeSpecArr, filename)) {
+            } else if (!isDirectory && FileUtils::WildMatch(excludeSpecArr, matchName)) {
                 // Do nothing
-            } else if (!isDirectory && FileUtils::WildMatch(specArr, filename)) {
+            } else if (!isDirectory && FileUtils::WildMatch(specArr, matchName)) {
                 // Include this file
-                filesOutput.push_back(fullpath);
+                on_file(dirWithSep, filename);
             }
             cont = dir.GetNext(&filename);
         }
     }
+}
+} // namespace
+
+size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& filesOutput, const wxString& filespec,
+                            const wxString& excludeFilespec, const wxStringSet_t& excludeFolders)
+{
+    filesOutput.clear();
+    DoScan(rootFolder, filespec, excludeFilespec, excludeFolders,
+           [&filesOutput](const wxString& dirWithSep, const wxString& filename) {
+               filesOutput.push_back(dirWithSep + filename);
+           });
+    return filesOutput.size();
+}
+
+size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<clPath>& filesOutput, const wxString& filespec,
+                            const wxString& excludeFilespec, const wxStringSet_t& excludeFolders)
+{
+    filesOutput.clear();
+    // the files of a folder are reported together: intern the folder once, and only the names for the files
+    clPathTable& table = clPathTable::Get();
+    wxString lastDir;
+    clPath lastDirPath;
+    DoScan(rootFolder, filespec, excludeFilespec, excludeFolders,
+           [&](const wxString& dirWithSep, const wxString& filename) {
+               if (!lastDirPath.IsOk() || dirWithSep != lastDir) {
+                   clPath path = table.Intern(dirWithSep + filename);
+                   lastDir = dirWithSep;
+                   lastDirPath = table.GetParent(path);
+                   filesOutput.push_back(path);
+               } else {
+                   filesOutput.push_back(table.Intern(lastDirPath, filename));
+               }
+           });
     return filesOutput.size();
 }
 
+bool clFilesScanner::IsIncluded(const wxString& rootFolder, const wxString& fullpath, const wxString& filespec,
+                                const wxString& excludeFilespec, const wxStringSet_t& excludeFolders)
+{
+    wxFileName fn(fullpath);
+    wxFileName root(rootFolder, "");
+    const wxArrayString& dirs = fn.GetDirs();
+    const wxArrayString& rootDirs = root.GetDirs();
+    if (dirs.size() < rootDirs.size() || fn.GetVolume() != root.GetVolume()) {
+        return false;
+    }
+    for (size_t i = 0; i < rootDirs.size(); ++i) {
+        if (dirs[i] != rootDirs[i]) {
+            return false;
+        }
+    }
+
+    // every folder between the root and the file must pass the folders filter, as in Scan()
+    wxFileName dir = root;
+    for (size_t i = rootDirs.size(); i < dirs.size(); ++i) {
+        dir.AppendDir(dirs[i]);
+        if (IsExcludedFolder(rootFolder, dir.GetPath(), excludeFolders)) {
+            return false;
+        }
+    }
+
+#ifdef __WXMSW__
+    wxArrayString specArr = ::wxStringTokenize(filespec.Lower(), ";,|", wxTOKEN_STRTOK);
+    wxArrayString excludeSpecArr = ::wxStringTokenize(excludeFilespec.Lower(), ";,|", wxTOKEN_STRTOK);
+    wxString filename = fn.GetFullName().Lower();
+#else
+    wxArrayString excludeSpecArr = ::wxStringTokenize(excludeFilespec, ";,|", wxTOKEN_STRTOK);
+    wxArrayString specArr = ::wxStringTokenize(filespec, ";,|", wxTOKEN_STRTOK);
+    wxString filename = fn.GetFullName();
+#endif
+    return !FileUtils::WildMatch(excludeSpecArr, filename) && FileUtils::WildMatch(specArr, filename);
+}
+
+bool clFilesScanner::IsExcludedFolder(const wxString& rootFolder, const wxString& folder,
+                                      const wxStringSet_t& excludeFolders)
+{
+    if (excludeFolders.empty()) {
+        return false;
+    }
+    return excludeFolders.count(FileUtils::RealPath(folder)) ||
+           IsRelPathContainedInSpec(rootFolder, folder, excludeFolders);
+}
+
 size_t clFilesScanner::Scan(const wxString& rootFolder, const wxString& filespec, const wxString& excludeFilespec,
                             const wxString& excludeFoldersSpec, std::function<bool(const wxString&)>&& collect_cb)
 {
@@ -204,6 +287,18 @@ size_t clFilesScanner::ScanNoRecurse(const wxString& rootFolder, clFilesScanner:
                                      const wxString& matchSpec)
 {
     results.clear();
+    return ScanNoRecurse(
+        rootFolder,
+        [&results](const EntryData& ed) {
+            results.push_back(ed);
+            return true;
+        },
+        matchSpec);
+}
+
+size_t clFilesScanner::ScanNoRecurse(const wxString& rootFolder, std::function<bool(const EntryData&)>&& on_entry_cb,
+                                     const wxString& matchSpec)
+{
     if (!wxFileName::DirExists(rootFolder)) {
         clDEBUG() << "clFilesScanner::ScanNoRecurse(): No such dir:" << rootFolder << clEndl;
         return 0;
@@ -216,6 +311,7 @@ size_t clFilesScanner::ScanNoRecurse(const wxString& rootFolder, clFilesScanner:
     }
     wxString dirWithSep = dir.GetNameWithSep();
 
+    size_t count = 0;
     wxString filename;
     bool cont = dir.GetFirst(&filename);
     while (cont) {
@@ -235,11 +331,14 @@ size_t clFilesScanner::ScanNoRecurse(const wxString& rootFolder, clFilesScanner:
                 ed.flags |= kIsHidden;
             }
             ed.fullpath = fullpath;
-            results.push_back(ed);
+            ++count;
+            if (!on_entry_cb(ed)) {
+                break;
+            }
         }
         cont = dir.GetNext(&filename);
     }
-    return results.size();
+    return count;
 }
 
 #ifdef __WXMSW__
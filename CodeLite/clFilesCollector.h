@@ -1,6 +1,7 @@
 #ifndef CLFILESCOLLECTOR_H
 #define CLFILESCOLLECTOR_H
 
+#include "clPathTable.hpp"
 #include "codelite_exports.h"
 #include "macros.h"
 
@@ -47,6 +48,24 @@ public:
      */
     size_t Scan(const wxString& rootFolder, std::vector<wxString>& filesOutput, const wxString& filespec = "*",
                 const wxString& excludeFilespec = "", const wxStringSet_t& excludeFolders = wxStringSet_t());
+    /**
+     * @brief same as above, but the files are interned in the shared path table
+     */
+    size_t Scan(const wxString& rootFolder, std::vector<clPath>& filesOutput, const wxString& filespec = "*",
+                const wxString& excludeFilespec = "", const wxStringSet_t& excludeFolders = wxStringSet_t());
+    /**
+     * @brief return true if Scan() with the same arguments would collect `fullpath`, without scanning anything.
+     * Used to filter the single file changes reported by a file system watcher
+     */
+    static bool IsIncluded(const wxString& rootFolder, const wxString& fullpath, const wxString& filespec = "*",
+                           const wxString& excludeFilespec = "",
+                           const wxStringSet_t& excludeFolders = wxStringSet_t());
+    /**
+     * @brief return true if Scan() from `rootFolder` would not traverse into `folder` because of `excludeFolders`.
+     * Only `folder` itself is checked, not its parent folders
+     */
+    static bool IsExcludedFolder(const wxString& rootFolder, const wxString& folder,
+                                 const wxStringSet_t& excludeFolders);
     /**
      * @brief same as above, but accepts the ignore directories list in a spec format
      */
@@ -65,6 +84,13 @@ public:
      */
     size_t ScanNoRecurse(const wxString& rootFolder, clFilesScanner::EntryData::Vec_t& results,
                          const wxString& matchSpec = "*");
+    /**
+     * @brief same as above, but each entry is passed to `on_entry_cb` as soon as it is read. The scan stops when
+     * `on_entry_cb` returns false
+     * @return number of entries passed to `on_entry_cb`
+     */
+    size_t ScanNoRecurse(const wxString& rootFolder, std::function<bool(const EntryData&)>&& on_entry_cb,
+                         const wxString& matchSpec = "*");
 
     /**
      * @brief a raw version for scanning files
@@ -0,0 +1,512 @@
+#include "clFuzzyMatcher.hpp"
+
+#include <algorithm>
+#include <string.h>
+#include <string_view>
+#include <thread>
+#include <wx/tokenzr.h>
+
+namespace
+{
+constexpr int SCORE_MATCH = 16;
+constexpr int SCORE_CONSECUTIVE = 8;
+constexpr int BONUS_WORD_START = 24;
+constexpr int BONUS_BASENAME = 32;
+constexpr int BONUS_BASENAME_START = 32;
+constexpr int BONUS_BASENAME_CHAR = 4;
+constexpr int BONUS_EXACT_NAME = 64;
+constexpr int PENALTY_GAP_START = 6;
+constexpr int PENALTY_GAP = 1;
+constexpr size_t MAX_GAP_PENALTY = 16;
+
+/// below this number of candidates per thread, a thread costs more than it saves
+constexpr size_t MIN_ENTRIES_PER_THREAD = 16 * 1024;
+
+inline bool IsUpper(char ch) { return ch >= 'A' && ch <= 'Z'; }
+inline bool IsLower(char ch) { return ch >= 'a' && ch <= 'z'; }
+inline char ToLower(char ch) { return IsUpper(ch) ? (ch - 'A' + 'a') : ch; }
+inline bool IsSeparator(char ch) { return ch == '/' || ch == '\\'; }
+inline bool IsWordBreak(char ch)
+{
+    return IsSeparator(ch) || ch == '_' || ch == '-' || ch == '.' || ch == ' ' || ch == ':';
+}
+
+inline bool IsWordStart(const char* text, size_t pos)
+{
+    if (pos == 0) {
+        return true;
+    }
+    char prev = text[pos - 1];
+    return IsWordBreak(prev) || (IsLower(prev) && IsUpper(text[pos]));
+}
+
+inline int MaskBit(char ch)
+{
+    ch = ToLower(ch);
+    if (ch >= 'a' && ch <= 'z') {
+        return ch - 'a';
+    }
+    if (ch >= '0' && ch <= '9') {
+        return 26 + (ch - '0');
+    }
+    switch (ch) {
+    case '.':
+        return 36;
+    case '_':
+        return 37;
+    case '-':
+        return 38;
+    case '/':
+    case '\\':
+        return 39;
+    default:
+        return -1;
+    }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// clFuzzyQuery
+// ----------------------------------------------------------------------------
+
+clFuzzyQuery::clFuzzyQuery(const wxString& filter) { Reset(filter); }
+
+void clFuzzyQuery::Reset(const wxString& filter)
+{
+    m_filter = filter;
+    m_terms.clear();
+    m_mask = 0;
+
+    wxArrayString words = ::wxStringTokenize(filter, " \t", wxTOKEN_STRTOK);
+    m_terms.reserve(words.size());
+    for (const wxString& word : words) {
+        const wxScopedCharBuffer utf8 = word.ToUTF8();
+        Term term;
+        Fold(utf8.data(), utf8.length(), term.text);
+        term.mask = GetMask(term.text.c_str(), term.text.length());
+        m_mask |= term.mask;
+        m_terms.push_back(std::move(term));
+    }
+}
+
+bool clFuzzyQuery::IsNarrowing(const clFuzzyQuery& other) const
+{
+    // extending the last term or adding terms can only remove candidates
+    return !other.IsEmpty() && m_filter.StartsWith(other.m_filter);
+}
+
+uint64_t clFuzzyQuery::GetMask(const char* text, size_t length)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i < length; ++i) {
+        int bit = MaskBit(text[i]);
+        if (bit >= 0) {
+            mask |= (uint64_t(1) << bit);
+        }
+    }
+    return mask;
+}
+
+size_t clFuzzyQuery::GetBasename(const char* text, size_t length)
+{
+    for (size_t i = length; i > 0; --i) {
+        if (IsSeparator(text[i - 1])) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void clFuzzyQuery::Fold(const char* text, size_t length, std::string& folded)
+{
+    size_t offset = folded.length();
+    folded.append(text, length);
+    for (size_t i = offset; i < folded.length(); ++i) {
+        char& ch = folded[i];
+        ch = IsSeparator(ch) ? '/' : ToLower(ch);
+    }
+}
+
+int clFuzzyQuery::ScoreSequence(const char* text, const char* folded, size_t length, size_t basename, size_t start,
+                                const Term& term, bool preferWordStarts, std::vector<size_t>* positions)
+{
+    const std::string& str = term.text;
+    const size_t n = str.length();
+    const size_t mark = positions ? positions->size() : 0;
+
+    int score = 0;
+    size_t matched = 0;
+    size_t wordStarts = 0;
+    size_t prev = std::string::npos;
+    for (size_t pos = start; pos < length && matched < n; ++pos) {
+        if (folded[pos] != str[matched]) {
+            continue;
+        }
+
+        if (preferWordStarts && !IsWordStart(text, pos) && pos != prev + 1) {
+            // skip ahead to the same character starting a word, if any
+            size_t next = pos + 1;
+            while (next < length && !(folded[next] == str[matched] && IsWordStart(text, next))) {
+                ++next;
+            }
+            if (next < length) {
+                pos = next;
+            }
+        }
+
+        score += SCORE_MATCH;
+        if (prev != std::string::npos) {
+            if (pos == prev + 1) {
+                score += SCORE_CONSECUTIVE;
+            } else {
+                score -= PENALTY_GAP_START + int(std::min(pos - prev - 1, MAX_GAP_PENALTY)) * PENALTY_GAP;
+            }
+        }
+        if (IsWordStart(text, pos)) {
+            score += BONUS_WORD_START / 2;
+            ++wordStarts;
+        }
+        if (pos >= basename) {
+            score += BONUS_BASENAME_CHAR;
+        }
+        if (positions) {
+            positions->push_back(pos);
+        }
+        prev = pos;
+        ++matched;
+    }
+
+    if (matched < n) {
+        if (positions) {
+            positions->resize(mark);
+        }
+        return -1;
+    }
+    if (n > 1 && wordStarts == n) {
+        // an acronym, e.g. "ord" for open_resource_dialog
+        score += BONUS_WORD_START;
+    }
+    return std::max(score, 1);
+}
+
+int clFuzzyQuery::ScoreTerm(const char* text, const char* folded, size_t length, size_t basename, const Term& term,
+                            std::vector<size_t>* positions)
+{
+    const std::string& str = term.text;
+    const size_t n = str.length();
+
+    // the term as a whole: keep its best occurrence
+    std::string_view haystack(folded, length);
+    int best = -1;
+    size_t bestPos = std::string::npos;
+    for (size_t pos = haystack.find(str); pos != std::string::npos; pos = haystack.find(str, pos + 1)) {
+        int score = int(n) * SCORE_MATCH + int(n - 1) * SCORE_CONSECUTIVE;
+        if (IsWordStart(text, pos)) {
+            score += BONUS_WORD_START;
+        }
+        if (pos >= basename) {
+            score += BONUS_BASENAME;
+            if (pos == basename) {
+                score += BONUS_BASENAME_START;
+            }
+        }
+        if (score > best) {
+            best = score;
+            bestPos = pos;
+        }
+    }
+
+    if (best >= 0) {
+        if (positions) {
+            for (size_t i = 0; i < n; ++i) {
+                positions->push_back(bestPos + i);
+            }
+        }
+        return best;
+    }
+
+    // the characters of the term in order: within the basename if possible, over the whole text otherwise. The first
+    // occurrence of each character always matches if any does; preferring the occurrences that start words may fail
+    // (e.g. "rn" in "string_r.h") but scores better when it succeeds
+    for (size_t start : { basename, size_t(0) }) {
+        int greedy = ScoreSequence(text, folded, length, basename, start, term, false, positions);
+        if (greedy < 0) {
+            continue;
+        }
+
+        std::vector<size_t> wordStartPositions;
+        int score =
+            ScoreSequence(text, folded, length, basename, start, term, true, positions ? &wordStartPositions : nullptr);
+        if (score > greedy) {
+            if (positions) {
+                positions->resize(positions->size() - n);
+                positions->insert(positions->end(), wordStartPositions.begin(), wordStartPositions.end());
+            }
+            return score;
+        }
+        return greedy;
+    }
+    return -1;
+}
+
+int clFuzzyQuery::Score(const char* text, const char* folded, size_t length, size_t basename,
+                        std::vector<size_t>* positions) const
+{
+    if (m_terms.empty()) {
+        return 0;
+    }
+
+    int total = 0;
+    for (const Term& term : m_terms) {
+        int score = ScoreTerm(text, folded, length, basename, term, positions);
+        if (score < 0) {
+            return -1;
+        }
+        total += score;
+    }
+
+    // a single term naming the file, with or without its extension
+    if (m_terms.size() == 1) {
+        const std::string& str = m_terms[0].text;
+        size_t n = str.length();
+        if (length - basename >= n && memcmp(folded + basename, str.c_str(), n) == 0 &&
+            (length - basename == n || text[basename + n] == '.')) {
+            total += BONUS_EXACT_NAME;
+        }
+    }
+
+    // prefer shallow paths
+    total -= int(std::min(basename, size_t(256)) / 16);
+    return std::max(total, 0);
+}
+
+int clFuzzyQuery::Score(const wxString& text, std::vector<size_t>* positions) const
+{
+    const wxScopedCharBuffer utf8 = text.ToUTF8();
+    const char* data = utf8.data();
+    size_t length = utf8.length();
+    std::string folded;
+    Fold(data, length, folded);
+    int score = Score(data, folded.c_str(), length, GetBasename(data, length), positions);
+    if (score < 0 || !positions || positions->empty()) {
+        return score;
+    }
+
+    // byte offsets => character indexes
+    std::vector<size_t> indexes(length, 0);
+    size_t index = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (i > 0 && (data[i] & 0xC0) != 0x80) {
+            ++index;
+        }
+        indexes[i] = index;
+    }
+    for (size_t& pos : *positions) {
+        pos = indexes[pos];
+    }
+    return score;
+}
+
+// ----------------------------------------------------------------------------
+// clFuzzyMatcher
+// ----------------------------------------------------------------------------
+
+void clFuzzyMatcher::Reserve(size_t count, size_t bytes)
+{
+    m_entries.reserve(count);
+    m_masks.reserve(count);
+    m_buffer.reserve(bytes ? bytes : count * 64);
+    m_folded.reserve(m_buffer.capacity());
+}
+
+size_t clFuzzyMatcher::Add(const wxString& text, int bonus)
+{
+    const wxScopedCharBuffer utf8 = text.ToUTF8();
+    Entry entry;
+    entry.offset = m_buffer.length();
+    entry.length = utf8.length();
+    entry.basename = clFuzzyQuery::GetBasename(utf8.data(), utf8.length());
+    entry.bonus = bonus;
+    m_buffer.append(utf8.data(), utf8.length());
+    clFuzzyQuery::Fold(utf8.data(), utf8.length(), m_folded);
+    m_entries.push_back(entry);
+    m_masks.push_back(clFuzzyQuery::GetMask(utf8.data(), utf8.length()));
+    return m_entries.size() - 1;
+}
+
+void clFuzzyMatcher::SetBonuses(const std::unordered_map<wxString, int>& bonuses)
+{
+    if (bonuses.empty()) {
+        return;
+    }
+
+    std::vector<std::string> keys;
+    keys.reserve(bonuses.size());
+    std::unordered_map<std::string_view, int> table;
+    table.reserve(bonuses.size());
+    for (const auto& vt : bonuses) {
+        const wxScopedCharBuffer utf8 = vt.first.ToUTF8();
+        keys.emplace_back(utf8.data(), utf8.length());
+    }
+    size_t i = 0;
+    for (const auto& vt : bonuses) {
+        table.insert({ std::string_view(keys[i]), vt.second });
+        ++i;
+    }
+
+    for (Entry& entry : m_entries) {
+        auto iter = table.find(std::string_view(m_buffer.data() + entry.offset, entry.length));
+        if (iter != table.end()) {
+            entry.bonus = iter->second;
+        }
+    }
+}
+
+wxString clFuzzyMatcher::GetText(size_t index) const
+{
+    const Entry& entry = m_entries[index];
+    return wxString::FromUTF8(m_buffer.data() + entry.offset, entry.length);
+}
+
+wxString clFuzzyMatcher::GetBasename(size_t index) const
+{
+    const Entry& entry = m_entries[index];
+    return wxString::FromUTF8(m_buffer.data() + entry.offset + entry.basename, entry.length - entry.basename);
+}
+
+void clFuzzyMatcher::Clear()
+{
+    m_buffer.clear();
+    m_folded.clear();
+    m_entries.clear();
+    m_masks.clear();
+}
+
+bool clFuzzyMatcher::IsBetter(const Match& a, const Match& b) const
+{
+    if (a.score != b.score) {
+        return a.score > b.score;
+    }
+    const Entry& ea = m_entries[a.index];
+    const Entry& eb = m_entries[b.index];
+    if (ea.length != eb.length) {
+        return ea.length < eb.length;
+    }
+    return a.index < b.index;
+}
+
+void clFuzzyMatcher::DoFind(const clFuzzyQuery& query, size_t first, size_t last, size_t maxResults,
+                            std::vector<Match>& matches) const
+{
+    // a heap of the best matches so far, the worst one on top
+    auto worse = [this](const Match& a, const Match& b) { return IsBetter(a, b); };
+    const uint64_t mask = query.GetMask();
+    const char* buffer = m_buffer.data();
+    const char* folded = m_folded.data();
+    matches.reserve(maxResults + 1);
+    for (size_t i = first; i < last; ++i) {
+        if ((m_masks[i] & mask) != mask) {
+            continue;
+        }
+
+        const Entry& entry = m_entries[i];
+        int score = query.Score(buffer + entry.offset, folded + entry.offset, entry.length, entry.basename);
+        if (score < 0) {
+            continue;
+        }
+
+        Match match;
+        match.index = i;
+        match.score = score + entry.bonus;
+        if (matches.size() < maxResults) {
+            matches.push_back(match);
+            std::push_heap(matches.begin(), matches.end(), worse);
+        } else if (IsBetter(match, matches.front())) {
+            std::pop_heap(matches.begin(), matches.end(), worse);
+            matches.back() = match;
+            std::push_heap(matches.begin(), matches.end(), worse);
+        }
+    }
+}
+
+std::vector<clFuzzyMatcher::Match> clFuzzyMatcher::Find(const clFuzzyQuery& query, size_t maxResults,
+                                                        size_t threads) const
+{
+    if (query.IsEmpty() || maxResults == 0 || m_entries.empty()) {
+        return {};
+    }
+
+    const size_t count = m_entries.size();
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, std::max(size_t(1), count / MIN_ENTRIES_PER_THREAD));
+    }
+    threads = std::min(threads, count);
+
+    // each thread keeps the best matches of its own slice of the table
+    std::vector<std::vector<Match>> results(threads);
+    std::vector<std::thread*> workers;
+    const size_t chunk = (count + threads - 1) / threads;
+    for (size_t t = 1; t < threads; ++t) {
+        size_t first = std::min(count, t * chunk);
+        size_t last = std::min(count, first + chunk);
+        workers.push_back(new std::thread([this, &query, &results, first, last, maxResults, t]() {
+            DoFind(query, first, last, maxResults, results[t]);
+        }));
+    }
+    DoFind(query, 0, std::min(count, chunk), maxResults, results[0]);
+    for (std::thread* worker : workers) {
+        worker->join();
+        wxDELETE(worker);
+    }
+
+    std::vector<Match> matches;
+    matches.swap(results[0]);
+    for (size_t t = 1; t < threads; ++t) {
+        matches.insert(matches.end(), results[t].begin(), results[t].end());
+    }
+    std::sort(matches.begin(), matches.end(), [this](const Match& a, const Match& b) { return IsBetter(a, b); });
+    if (matches.size() > maxResults) {
+        matches.resize(maxResults);
+    }
+    return matches;
+}
+
+std::vector<clFuzzyMatcher::Match> clFuzzyMatcher::Filter(const clFuzzyQuery& query,
+                                                          const std::vector<Match>* candidates) const
+{
+    std::vector<Match> matches;
+    if (query.IsEmpty()) {
+        return matches;
+    }
+
+    const uint64_t mask = query.GetMask();
+    auto test = [&](size_t i) {
+        if ((m_masks[i] & mask) != mask) {
+            return;
+        }
+        const Entry& entry = m_entries[i];
+        int score = query.Score(m_buffer.data() + entry.offset, m_folded.data() + entry.offset, entry.length,
+                                entry.basename);
+        if (score >= 0) {
+            Match match;
+            match.index = i;
+            match.score = score + entry.bonus;
+            matches.push_back(match);
+        }
+    };
+
+    if (candidates) {
+        matches.reserve(candidates->size());
+        for (const Match& candidate : *candidates) {
+            test(candidate.index);
+        }
+    } else {
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            test(i);
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [this](const Match& a, const Match& b) { return IsBetter(a, b); });
+    return matches;
+}
@@ -0,0 +1,167 @@
+#ifndef CLFUZZYMATCHER_HPP
+#define CLFUZZYMATCHER_HPP
+
+#include "codelite_exports.h"
+#include "wxStringHash.h"
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wx/string.h>
+
+/// A fuzzy filter, parsed once and matched against many candidates.
+///
+/// The filter is split into terms at the whitespace. A candidate matches if every term matches it: the characters of
+/// the term appear in the candidate in the same order, not necessarily next to each other. ASCII letters are compared
+/// case insensitively, the other characters (UTF-8) as they are. The candidates are treated as paths: the last
+/// component (the "basename") is where a match counts the most.
+///
+/// The score of a match rewards terms found as a whole, at the start of a word (after a separator or on a camelCase
+/// hump), in the basename or at its start, and penalises gaps and deep paths
+class WXDLLIMPEXP_CL clFuzzyQuery
+{
+    struct Term {
+        /// lower case UTF-8
+        std::string text;
+        uint64_t mask = 0;
+    };
+
+    std::vector<Term> m_terms;
+    uint64_t m_mask = 0;
+    wxString m_filter;
+
+protected:
+    static int ScoreTerm(const char* text, const char* folded, size_t length, size_t basename, const Term& term,
+                         std::vector<size_t>* positions);
+    static int ScoreSequence(const char* text, const char* folded, size_t length, size_t basename, size_t start,
+                             const Term& term, bool preferWordStarts, std::vector<size_t>* positions);
+
+public:
+    clFuzzyQuery() = default;
+    explicit clFuzzyQuery(const wxString& filter);
+
+    /**
+     * @brief parse `filter`
+     */
+    void Reset(const wxString& filter);
+
+    bool IsEmpty() const { return m_terms.empty(); }
+    const wxString& GetFilter() const { return m_filter; }
+
+    /**
+     * @brief the characters the candidates must contain, see GetMask(const char*, size_t)
+     */
+    uint64_t GetMask() const { return m_mask; }
+
+    /**
+     * @brief does every candidate that matches this query also match `other`? True when this filter extends the
+     * filter of `other`: the survivors of `other` are the only candidates worth testing
+     */
+    bool IsNarrowing(const clFuzzyQuery& other) const;
+
+    /**
+     * @brief return the score of `text` (UTF-8 of `length` bytes, its basename starting at offset `basename`), or -1
+     * if it does not match. `folded` is `text` folded by Fold(). If `positions` is not null, it receives the byte
+     * offsets of the matched characters
+     */
+    int Score(const char* text, const char* folded, size_t length, size_t basename,
+              std::vector<size_t>* positions = nullptr) const;
+
+    /**
+     * @brief convenience: score a wxString. The positions are character indexes in `text`
+     */
+    int Score(const wxString& text, std::vector<size_t>* positions = nullptr) const;
+
+    /**
+     * @brief a bit per ASCII letter, digit and separator found in `text`, for a cheap prefilter: a candidate can only
+     * match if its mask contains the mask of the query
+     */
+    static uint64_t GetMask(const char* text, size_t length);
+
+    /**
+     * @brief the offset of the last path component in `text`
+     */
+    static size_t GetBasename(const char* text, size_t length);
+
+    /**
+     * @brief append to `folded` the form of `text` the terms are compared with: ASCII letters in lower case and '/'
+     * for every path separator. It has the length of `text`
+     */
+    static void Fold(const char* text, size_t length, std::string& folded);
+};
+
+/// A compact table of candidates (typically the files of a workspace) and the ranking of a query against it.
+///
+/// The candidates are stored back to back in a single UTF-8 buffer, next to a folded copy and their character masks:
+/// a query scans memory linearly, discards most candidates with a mask test and searches the others with plain byte
+/// comparisons. Large tables are scored on several threads; only the best matches are kept, so the cost does not
+/// depend on the number of matches
+class WXDLLIMPEXP_CL clFuzzyMatcher
+{
+public:
+    struct Match {
+        size_t index = 0;
+        int score = 0;
+    };
+
+protected:
+    struct Entry {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint32_t basename = 0;
+        int32_t bonus = 0;
+    };
+
+    std::string m_buffer;
+    /// m_buffer, folded
+    std::string m_folded;
+    std::vector<Entry> m_entries;
+    std::vector<uint64_t> m_masks;
+
+protected:
+    void DoFind(const clFuzzyQuery& query, size_t first, size_t last, size_t maxResults,
+                std::vector<Match>& matches) const;
+    bool IsBetter(const Match& a, const Match& b) const;
+
+public:
+    clFuzzyMatcher() = default;
+    ~clFuzzyMatcher() = default;
+
+    /**
+     * @brief reserve room for `count` candidates, of `bytes` UTF-8 bytes in total
+     */
+    void Reserve(size_t count, size_t bytes = 0);
+
+    /**
+     * @brief add a candidate and return its index. `bonus` is added to its score when it matches, e.g. a usage count
+     */
+    size_t Add(const wxString& text, int bonus = 0);
+
+    void SetBonus(size_t index, int bonus) { m_entries[index].bonus = bonus; }
+
+    /**
+     * @brief set the bonus of the candidates listed in `bonuses` (text => bonus) in a single pass
+     */
+    void SetBonuses(const std::unordered_map<wxString, int>& bonuses);
+
+    size_t GetCount() const { return m_entries.size(); }
+    bool IsEmpty() const { return m_entries.empty(); }
+    wxString GetText(size_t index) const;
+    wxString GetBasename(size_t index) const;
+    void Clear();
+
+    /**
+     * @brief return the `maxResults` best matches of `query`, best first. With `threads` 0, the number of threads
+     * depends on the size of the table and the number of cores
+     */
+    std::vector<Match> Find(const clFuzzyQuery& query, size_t maxResults, size_t threads = 0) const;
+
+    /**
+     * @brief return all the matches of `query`, best first. If `candidates` is not null, only these candidates are
+     * scored: e.g. the matches of a query that `query` narrows, see clFuzzyQuery::IsNarrowing()
+     */
+    std::vector<Match> Filter(const clFuzzyQuery& query, const std::vector<Match>* candidates = nullptr) const;
+};
+
+#endif // CLFUZZYMATCHER_HPP
@@ -0,0 +1,162 @@
+#include "clJobServer.hpp"
+
+#include "cl_standard_paths.h"
+#include "file_logger.h"
+
+#include <atomic>
+#include <wx/utils.h>
+
+#ifdef __WXMSW__
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::atomic_int s_serverCounter{ 0 };
+}
+
+clJobServer::~clJobServer() { Destroy(); }
+
+bool clJobServer::IsMakeVersionSupported(int major, int minor)
+{
+#ifdef __WXMSW__
+    return major > 4 || (major == 4 && minor >= 2);
+#else
+    return major > 4 || (major == 4 && minor >= 4);
+#endif
+}
+
+wxString clJobServer::GetMakeFlags() const
+{
+    if (!IsOk()) {
+        return wxEmptyString;
+    }
+
+    wxString flags;
+    flags << "-j" << m_slots << " --jobserver-auth=";
+#ifndef __WXMSW__
+    flags << "fifo:";
+#endif
+    flags << m_name;
+    return flags;
+}
+
+#ifdef __WXMSW__
+bool clJobServer::Create(size_t slots)
+{
+    Destroy();
+    if (slots == 0) {
+        return false;
+    }
+
+    wxString name;
+    name << "codelite_jobserver_" << ::wxGetProcessId() << "_" << s_serverCounter++;
+    LONG tokens = static_cast<LONG>(slots - 1);
+    HANDLE semaphore = ::CreateSemaphoreW(nullptr, tokens, tokens > 0 ? tokens : 1, name.wc_str());
+    if (semaphore == nullptr) {
+        clWARNING() << "Failed to create jobserver semaphore:" << name << endl;
+        return false;
+    }
+
+    m_semaphore = semaphore;
+    m_name = name;
+    m_slots = slots;
+    return true;
+}
+
+void clJobServer::Destroy()
+{
+    if (m_semaphore) {
+        ::CloseHandle(m_semaphore);
+    }
+    m_semaphore = nullptr;
+    m_name.clear();
+    m_slots = 0;
+}
+
+bool clJobServer::TryAcquire()
+{
+    if (!m_semaphore) {
+        return false;
+    }
+    return ::WaitForSingleObject(m_semaphore, 0) == WAIT_OBJECT_0;
+}
+
+void clJobServer::Release()
+{
+    if (m_semaphore) {
+        ::ReleaseSemaphore(m_semaphore, 1, nullptr);
+    }
+}
+
+#else
+bool clJobServer::Create(size_t slots)
+{
+    Destroy();
+    if (slots == 0) {
+        return false;
+    }
+
+    wxString path;
+    path << clStandardPaths::Get().GetTempDir() << "/jobserver." << s_serverCounter++;
+    std::string fifo_path = path.ToStdString(wxConvUTF8);
+    ::unlink(fifo_path.c_str());
+    if (::mkfifo(fifo_path.c_str(), 0600) != 0) {
+        clWARNING() << "Failed to create jobserver FIFO:" << path << "." << strerror(errno) << endl;
+        return false;
+    }
+
+    // open for both reading and writing so the FIFO stays open while the make processes come and go, and reads
+    // from an empty pool return EAGAIN instead of blocking
+    int fd = ::open(fifo_path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        clWARNING() << "Failed to open jobserver FIFO:" << path << "." << strerror(errno) << endl;
+        ::unlink(fifo_path.c_str());
+        return false;
+    }
+
+    m_fd = fd;
+    m_name = path;
+    m_slots = slots;
+    for (size_t i = 1; i < slots; ++i) {
+        Release();
+    }
+    return true;
+}
+
+void clJobServer::Destroy()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        ::unlink(m_name.ToStdString(wxConvUTF8).c_str());
+    }
+    m_fd = -1;
+    m_name.clear();
+    m_slots = 0;
+}
+
+bool clJobServer::TryAcquire()
+{
+    if (m_fd < 0) {
+        return false;
+    }
+    char token = 0;
+    return ::read(m_fd, &token, 1) == 1;
+}
+
+void clJobServer::Release()
+{
+    if (m_fd < 0) {
+        return;
+    }
+    const char token = '+';
+    while (::write(m_fd, &token, 1) < 0 && errno == EINTR) {
+    }
+}
+#endif
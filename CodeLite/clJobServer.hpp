@@ -0,0 +1,66 @@
+#ifndef CLJOBSERVER_HPP
+#define CLJOBSERVER_HPP
+
+#include "codelite_exports.h"
+
+#include <stddef.h>
+#include <wx/string.h>
+
+/// A GNU make compatible jobserver.
+///
+/// The server owns a pool of job slot tokens shared by all the make processes that are given `GetMakeFlags()` in
+/// their environment. Like a make jobserver, the pool holds one token less than the number of slots: the first job runs
+/// on its implicit slot. On POSIX the pool is a named FIFO (GNU make 4.4 and later), on Windows it is a named semaphore
+/// (GNU make 4.2 and later). A named object is used since the build processes do not inherit our file descriptors
+class WXDLLIMPEXP_CL clJobServer
+{
+    wxString m_name;
+    size_t m_slots = 0;
+#ifdef __WXMSW__
+    void* m_semaphore = nullptr;
+#else
+    int m_fd = -1;
+#endif
+
+public:
+    clJobServer() = default;
+    ~clJobServer();
+
+    clJobServer(const clJobServer&) = delete;
+    clJobServer& operator=(const clJobServer&) = delete;
+
+    /**
+     * @brief create the jobserver with `slots` job slots. Any previous server is destroyed
+     */
+    bool Create(size_t slots);
+
+    /**
+     * @brief destroy the jobserver. Tokens still held by processes are lost
+     */
+    void Destroy();
+
+    bool IsOk() const { return !m_name.empty(); }
+    size_t GetSlots() const { return m_slots; }
+
+    /**
+     * @brief take a token from the pool, without blocking. Return false if the pool is empty
+     */
+    bool TryAcquire();
+
+    /**
+     * @brief return a token taken with TryAcquire() to the pool
+     */
+    void Release();
+
+    /**
+     * @brief return the MAKEFLAGS value that makes GNU make join this jobserver
+     */
+    wxString GetMakeFlags() const;
+
+    /**
+     * @brief return true if GNU make version `major`.`minor` can join this kind of jobserver
+     */
+    static bool IsMakeVersionSupported(int major, int minor);
+};
+
+#endif // CLJOBSERVER_HPP
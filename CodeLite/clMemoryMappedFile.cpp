@@ -0,0 +1,117 @@
+#include "clMemoryMappedFile.hpp"
+
+#ifdef __WXMSW__
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+clMemoryMappedFile::~clMemoryMappedFile() { Close(); }
+
+#ifdef __WXMSW__
+bool clMemoryMappedFile::Open(const wxString& path)
+{
+    Close();
+    HANDLE file = ::CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!::GetFileSizeEx(file, &file_size)) {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_opened = true;
+    if (file_size.QuadPart == 0) {
+        // nothing to map
+        return true;
+    }
+
+    HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        Close();
+        return false;
+    }
+    m_mapping = mapping;
+
+    void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        Close();
+        return false;
+    }
+    m_data = reinterpret_cast<const char*>(data);
+    m_size = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void clMemoryMappedFile::Close()
+{
+    if (m_data) {
+        ::UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        ::CloseHandle(m_mapping);
+    }
+    if (m_file) {
+        ::CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_opened = false;
+}
+
+#else
+bool clMemoryMappedFile::Open(const wxString& path)
+{
+    Close();
+    int fd = ::open(path.mb_str(wxConvUTF8).data(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_opened = true;
+    if (st.st_size == 0) {
+        // mmap() does not accept an empty range
+        return true;
+    }
+
+    void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        Close();
+        return false;
+    }
+    m_data = reinterpret_cast<const char*>(data);
+    m_size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void clMemoryMappedFile::Close()
+{
+    if (m_data) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+    m_data = nullptr;
+    m_fd = -1;
+    m_size = 0;
+    m_opened = false;
+}
+#endif
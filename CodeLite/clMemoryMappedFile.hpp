@@ -0,0 +1,45 @@
+#ifndef CLMEMORYMAPPEDFILE_HPP
+#define CLMEMORYMAPPEDFILE_HPP
+
+#include "codelite_exports.h"
+
+#include <stddef.h>
+#include <wx/string.h>
+
+/// A read-only memory mapping of a file
+class WXDLLIMPEXP_CL clMemoryMappedFile
+{
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_opened = false;
+#ifdef __WXMSW__
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+
+public:
+    clMemoryMappedFile() = default;
+    ~clMemoryMappedFile();
+
+    clMemoryMappedFile(const clMemoryMappedFile&) = delete;
+    clMemoryMappedFile& operator=(const clMemoryMappedFile&) = delete;
+
+    /**
+     * @brief map the entire content of `path`. Any previous mapping is released
+     * @return false if the file could not be mapped. An empty file is mapped successfully with size 0
+     */
+    bool Open(const wxString& path);
+
+    /**
+     * @brief release the mapping
+     */
+    void Close();
+
+    bool IsOpened() const { return m_opened; }
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+};
+
+#endif // CLMEMORYMAPPEDFILE_HPP
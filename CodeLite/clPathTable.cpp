@@ -0,0 +1,267 @@
+#include "clPathTable.hpp"
+
+#include <string_view>
+
+#define PATH_TABLE_BLOCK_SIZE (64 * 1024)
+
+namespace
+{
+#ifdef __WXMSW__
+const char NATIVE_SEPARATOR = '\\';
+inline bool IsSeparator(char ch) { return ch == '/' || ch == '\\'; }
+#else
+const char NATIVE_SEPARATOR = '/';
+inline bool IsSeparator(char ch) { return ch == '/'; }
+#endif
+
+/// the length of the first component of `path`
+inline size_t ComponentLength(const char* path, size_t length)
+{
+    size_t len = 0;
+    while (len < length && !IsSeparator(path[len])) {
+        ++len;
+    }
+    return len;
+}
+} // namespace
+
+size_t clPathTable::KeyHash::operator()(const Key& key) const
+{
+    size_t h = std::hash<std::string_view>()(std::string_view(key.name, key.length));
+    return h ^ (std::hash<uint32_t>()(key.parent) + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+clPathTable::clPathTable()
+{
+    // the root node
+    m_nodes.emplace_back();
+}
+
+clPathTable& clPathTable::Get()
+{
+    static clPathTable table;
+    return table;
+}
+
+const char* clPathTable::DoAllocName(const char* name, size_t length)
+{
+    if (length == 0) {
+        return nullptr;
+    }
+
+    if (length > PATH_TABLE_BLOCK_SIZE / 4) {
+        // a dedicated block, placed before the block being filled
+        std::unique_ptr<char[]> block(new char[length]);
+        memcpy(block.get(), name, length);
+        const char* ptr = block.get();
+        m_blocks.insert(m_blocks.empty() ? m_blocks.end() : m_blocks.end() - 1, std::move(block));
+        return ptr;
+    }
+
+    if (m_blocks.empty() || m_blockSize - m_blockUsed < length) {
+        m_blocks.emplace_back(new char[PATH_TABLE_BLOCK_SIZE]);
+        m_blockSize = PATH_TABLE_BLOCK_SIZE;
+        m_blockUsed = 0;
+    }
+    char* ptr = m_blocks.back().get() + m_blockUsed;
+    memcpy(ptr, name, length);
+    m_blockUsed += length;
+    return ptr;
+}
+
+uint32_t clPathTable::DoIntern(uint32_t parent, const char* path, size_t length)
+{
+    uint32_t id = parent;
+    size_t pos = 0;
+    while (true) {
+        size_t len = ComponentLength(path + pos, length - pos);
+        Key key;
+        key.parent = id;
+        key.length = len;
+        key.name = path + pos;
+        auto iter = m_index.find(key);
+        if (iter != m_index.end()) {
+            id = iter->second;
+        } else {
+            Node node;
+            node.parent = id;
+            node.length = len;
+            node.name = DoAllocName(path + pos, len);
+            id = m_nodes.size();
+            m_nodes.push_back(node);
+
+            key.name = node.name;
+            m_index.insert({ key, id });
+        }
+
+        pos += len;
+        if (pos == length) {
+            break;
+        }
+        ++pos; // skip the separator
+    }
+    return id;
+}
+
+uint32_t clPathTable::DoFind(uint32_t parent, const char* path, size_t length) const
+{
+    uint32_t id = parent;
+    size_t pos = 0;
+    while (true) {
+        size_t len = ComponentLength(path + pos, length - pos);
+        Key key;
+        key.parent = id;
+        key.length = len;
+        key.name = path + pos;
+        auto iter = m_index.find(key);
+        if (iter == m_index.end()) {
+            return 0;
+        }
+        id = iter->second;
+
+        pos += len;
+        if (pos == length) {
+            break;
+        }
+        ++pos;
+    }
+    return id;
+}
+
+void clPathTable::DoGetFullPath(uint32_t id, std::string& path) const
+{
+    size_t length = 0;
+    std::vector<uint32_t> chain;
+    for (uint32_t cur = id; cur != 0; cur = m_nodes[cur].parent) {
+        chain.push_back(cur);
+        length += m_nodes[cur].length + 1;
+    }
+
+    path.reserve(path.length() + length);
+    for (auto iter = chain.rbegin(); iter != chain.rend(); ++iter) {
+        if (iter != chain.rbegin()) {
+            path.push_back(NATIVE_SEPARATOR);
+        }
+        const Node& node = m_nodes[*iter];
+        path.append(node.name, node.length);
+    }
+}
+
+clPath clPathTable::Intern(const wxString& fullpath)
+{
+    if (fullpath.empty()) {
+        return clPath();
+    }
+    const wxScopedCharBuffer utf8 = fullpath.ToUTF8();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return clPath(DoIntern(0, utf8.data(), utf8.length()));
+}
+
+clPath clPathTable::Intern(const clPath& parent, const wxString& relpath)
+{
+    if (relpath.empty()) {
+        return parent;
+    }
+    const wxScopedCharBuffer utf8 = relpath.ToUTF8();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return clPath(DoIntern(parent.GetId(), utf8.data(), utf8.length()));
+}
+
+clPath clPathTable::Find(const wxString& fullpath) const
+{
+    if (fullpath.empty()) {
+        return clPath();
+    }
+    const wxScopedCharBuffer utf8 = fullpath.ToUTF8();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return clPath(DoFind(0, utf8.data(), utf8.length()));
+}
+
+wxString clPathTable::GetFullPath(const clPath& path) const
+{
+    std::string str;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DoGetFullPath(path.GetId(), str);
+    }
+    return wxString::FromUTF8(str.c_str(), str.length());
+}
+
+wxString clPathTable::GetFullName(const clPath& path) const
+{
+    if (!path.IsOk()) {
+        return wxEmptyString;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Node& node = m_nodes[path.GetId()];
+    return wxString::FromUTF8(node.name, node.length);
+}
+
+clPath clPathTable::GetParent(const clPath& path) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return clPath(m_nodes[path.GetId()].parent);
+}
+
+bool clPathTable::IsUnder(const clPath& path, const clPath& folder) const
+{
+    if (!folder.IsOk()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t cur = m_nodes[path.GetId()].parent; cur != 0; cur = m_nodes[cur].parent) {
+        if (cur == folder.GetId()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t clPathTable::GetCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nodes.size() - 1;
+}
+
+void clPathTable::ToArrayString(const std::vector<clPath>& paths, wxArrayString& files) const
+{
+    files.reserve(files.size() + paths.size());
+    std::string str;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const clPath& path : paths) {
+        str.clear();
+        DoGetFullPath(path.GetId(), str);
+        files.Add(wxString::FromUTF8(str.c_str(), str.length()));
+    }
+}
+
+void clPathTable::ToFileNames(const std::vector<clPath>& paths, std::vector<wxFileName>& files) const
+{
+    files.reserve(files.size() + paths.size());
+    std::string str;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const clPath& path : paths) {
+        str.clear();
+        DoGetFullPath(path.GetId(), str);
+        files.emplace_back(wxString::FromUTF8(str.c_str(), str.length()));
+    }
+}
+
+void clPathTable::FromArrayString(const wxArrayString& files, std::vector<clPath>& paths)
+{
+    paths.reserve(paths.size() + files.size());
+    for (const wxString& file : files) {
+        paths.push_back(Intern(file));
+    }
+}
+
+clPath::clPath(const wxString& fullpath)
+    : m_id(clPathTable::Get().Intern(fullpath).GetId())
+{
+}
+
+wxString clPath::GetFullPath() const { return clPathTable::Get().GetFullPath(*this); }
+wxString clPath::GetFullName() const { return clPathTable::Get().GetFullName(*this); }
+wxString clPath::GetPath() const { return clPathTable::Get().GetFullPath(GetParent()); }
+clPath clPath::GetParent() const { return clPathTable::Get().GetParent(*this); }
+bool clPath::IsUnder(const clPath& folder) const { return clPathTable::Get().IsUnder(*this, folder); }
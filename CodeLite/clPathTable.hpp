@@ -0,0 +1,157 @@
+#ifndef CLPATHTABLE_HPP
+#define CLPATHTABLE_HPP
+
+#include "codelite_exports.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/// A handle to a path interned in the clPathTable.
+///
+/// The handle is 4 bytes: two handles are equal if and only if they refer to the same path, so comparing and hashing
+/// paths are integer operations. The default handle refers to no path
+class WXDLLIMPEXP_CL clPath
+{
+    uint32_t m_id = 0;
+
+public:
+    clPath() = default;
+    explicit clPath(uint32_t id)
+        : m_id(id)
+    {
+    }
+
+    /**
+     * @brief intern `fullpath` in the shared table
+     */
+    explicit clPath(const wxString& fullpath);
+
+    uint32_t GetId() const { return m_id; }
+    bool IsOk() const { return m_id != 0; }
+
+    wxString GetFullPath() const;
+    /**
+     * @brief the last component of the path
+     */
+    wxString GetFullName() const;
+    /**
+     * @brief the full path of the parent folder
+     */
+    wxString GetPath() const;
+    clPath GetParent() const;
+    /**
+     * @brief is this path inside the folder `folder`, at any depth?
+     */
+    bool IsUnder(const clPath& folder) const;
+    wxFileName ToFileName() const { return wxFileName(GetFullPath()); }
+
+    bool operator==(const clPath& other) const { return m_id == other.m_id; }
+    bool operator!=(const clPath& other) const { return m_id != other.m_id; }
+    /// the order of the handles, not of the paths
+    bool operator<(const clPath& other) const { return m_id < other.m_id; }
+};
+
+namespace std
+{
+template <> struct hash<clPath> {
+    std::size_t operator()(const clPath& path) const { return std::hash<uint32_t>()(path.GetId()); }
+};
+} // namespace std
+
+/// The table of the interned paths, shared by the whole process.
+///
+/// A path is stored as a trie of its components: every folder is stored once, whatever the number of files it holds,
+/// and a file costs its UTF-8 name plus a few bytes. The table only grows: a path interned once stays valid for the
+/// lifetime of the process. Separators are stored as the native one (`/` and `\` on Windows), everything else is
+/// kept as is: the path is not normalised. All the methods are thread safe
+class WXDLLIMPEXP_CL clPathTable
+{
+    struct Node {
+        uint32_t parent = 0;
+        uint32_t length = 0;
+        const char* name = nullptr;
+    };
+
+    struct Key {
+        uint32_t parent = 0;
+        uint32_t length = 0;
+        const char* name = nullptr;
+        bool operator==(const Key& other) const
+        {
+            return parent == other.parent && length == other.length &&
+                   (length == 0 || memcmp(name, other.name, length) == 0);
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    mutable std::mutex m_mutex;
+    /// node 0 is the parent of the first component of every path
+    std::vector<Node> m_nodes;
+    std::unordered_map<Key, uint32_t, KeyHash> m_index;
+    /// the names are allocated in blocks that never move: the nodes and the keys point into them
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    size_t m_blockUsed = 0;
+    size_t m_blockSize = 0;
+
+protected:
+    const char* DoAllocName(const char* name, size_t length);
+    uint32_t DoIntern(uint32_t parent, const char* path, size_t length);
+    uint32_t DoFind(uint32_t parent, const char* path, size_t length) const;
+    void DoGetFullPath(uint32_t id, std::string& path) const;
+
+public:
+    clPathTable();
+    ~clPathTable() = default;
+
+    clPathTable(const clPathTable&) = delete;
+    clPathTable& operator=(const clPathTable&) = delete;
+
+    static clPathTable& Get();
+
+    /**
+     * @brief intern `fullpath`. An empty path returns the default handle
+     */
+    clPath Intern(const wxString& fullpath);
+
+    /**
+     * @brief intern the path `relpath` inside the folder `parent`
+     */
+    clPath Intern(const clPath& parent, const wxString& relpath);
+
+    /**
+     * @brief return the handle of `fullpath` if it was interned, the default handle otherwise. Nothing is added to the
+     * table
+     */
+    clPath Find(const wxString& fullpath) const;
+
+    wxString GetFullPath(const clPath& path) const;
+    wxString GetFullName(const clPath& path) const;
+    clPath GetParent(const clPath& path) const;
+    bool IsUnder(const clPath& path, const clPath& folder) const;
+
+    /**
+     * @brief number of nodes (folders and files) in the table
+     */
+    size_t GetCount() const;
+
+    /**
+     * @brief adapters for the APIs that work with strings: convert a list of paths at once
+     */
+    void ToArrayString(const std::vector<clPath>& paths, wxArrayString& files) const;
+    void ToFileNames(const std::vector<clPath>& paths, std::vector<wxFileName>& files) const;
+    void FromArrayString(const wxArrayString& files, std::vector<clPath>& paths);
+};
+
+#endif // CLPATHTABLE_HPP
@@ -381,6 +381,7 @@ public:
         kClean = (1 << 0),
         kBuild = (1 << 1),
         kCustomProject = (1 << 2),
+        kParallel = (1 << 3), // the output lines are prefixed with the project / configuration that printed them
     };
 
 protected:
@@ -0,0 +1,292 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Throughput and allocation counts of the matchers used by the filtering loops
+// (GotoAnything, Open Resource, the file system workspace excludes, the search
+// filters) on synthetic corpora: 300k file paths and 2M symbol names.
+//
+// Usage: FuzzyMatchBenchmark [--scale <factor>] [--repeat <count>] [--filter <text>]
+//
+//  --scale   multiply the size of the corpora (default: 1.0)
+//  --repeat  run every benchmark <count> times and report the fastest run (default: 3)
+//  --filter  only run the benchmarks whose name contains <text>
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "clAnagram.h"
+#include "clFuzzyMatcher.hpp"
+#include "clWildMatch.hpp"
+#include "fileutils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <random>
+#include <stdio.h>
+#include <vector>
+#include <wx/init.h>
+#include <wx/log.h>
+#include <wx/tokenzr.h>
+
+// Every allocation of the process goes through these (on ELF and Mach-O platforms, the shared libraries included)
+static std::atomic<size_t> allocations_count{ 0 };
+
+void* operator new(size_t size)
+{
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) { return ::operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace
+{
+constexpr size_t PATHS_COUNT = 300000;
+constexpr size_t SYMBOLS_COUNT = 2000000;
+
+const char* WORDS[] = { "tree",   "ctrl",   "panel",  "item",   "text",  "file",   "folder", "view",  "editor",
+                        "manager", "event", "helper", "data",   "model", "row",    "entry",  "list",  "cache",
+                        "parser", "token",  "scope",  "symbol", "index", "query",  "match",  "path",  "workspace",
+                        "project", "build", "config", "thread", "queue", "buffer", "string", "utils", "dialog" };
+const char* FOLDERS[] = { "src",      "include", "lib",     "Plugin",      "CodeLite", "LiteEditor", "tests",
+                          "third_party", "core", "ui",      "net",         "io",       "parser",     "detail",
+                          "impl",     "build",   "docs",    "resources",   "scripts",  "tools",      ".git" };
+const char* EXTENSIONS[] = { ".cpp", ".h", ".hpp", ".c", ".cc", ".txt", ".cmake", ".py", ".json", ".md", ".png" };
+const char* SCOPES[] = { "",          "",         "std::",         "wxString::", "clTreeCtrl::", "FileUtils::",
+                         "LSP::",     "Cxx::",    "clFuzzyQuery::", "ns::detail::", "Project::",   "Workspace::" };
+
+template <typename T, size_t N> const T& pick(std::mt19937& rng, const T (&values)[N]) { return values[rng() % N]; }
+
+/// an identifier of 1 to 4 words, in one of the naming styles found in C++ code
+wxString make_identifier(std::mt19937& rng)
+{
+    size_t count = 1 + rng() % 4;
+    int style = rng() % 3;
+    wxString identifier;
+    if (style == 2) {
+        identifier << "m_";
+    }
+    for (size_t i = 0; i < count; ++i) {
+        wxString word = pick(rng, WORDS);
+        if (style == 1) {
+            // snake_case
+            if (i) {
+                identifier << "_";
+            }
+        } else if (i || style == 0) {
+            // CamelCase, or camelCase for the members
+            word = word.Capitalize();
+        }
+        identifier << word;
+    }
+    return identifier;
+}
+
+void make_paths(size_t count, std::vector<wxString>& paths)
+{
+    std::mt19937 rng(1);
+    paths.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        wxString path = "/home/user/devel/project";
+        size_t depth = 1 + rng() % 6;
+        for (size_t d = 0; d < depth; ++d) {
+            path << "/" << pick(rng, FOLDERS);
+        }
+        path << "/" << make_identifier(rng) << pick(rng, EXTENSIONS);
+        paths.push_back(path);
+    }
+}
+
+void make_symbols(size_t count, std::vector<wxString>& symbols)
+{
+    std::mt19937 rng(2);
+    symbols.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        wxString symbol = pick(rng, SCOPES);
+        symbol << make_identifier(rng);
+        symbols.push_back(symbol);
+    }
+}
+
+struct Corpus {
+    const char* name;
+    const std::vector<wxString>& items;
+    /// FileUtils::FuzzyMatch needle
+    wxString words;
+    /// clAnagram needle
+    wxString anagram;
+    /// clFuzzyQuery filter
+    wxString query;
+};
+
+struct Options {
+    double scale = 1.0;
+    size_t repeat = 3;
+    wxString filter;
+};
+
+/// run `body` (which returns the number of matches) `options.repeat` times and print the fastest run
+void run(const Options& options, const wxString& name, size_t items, const std::function<size_t()>& body)
+{
+    if (!options.filter.empty() && !name.Contains(options.filter)) {
+        return;
+    }
+
+    double best = 0.0;
+    size_t matches = 0;
+    size_t allocations = 0;
+    for (size_t i = 0; i < options.repeat; ++i) {
+        size_t before = allocations_count.load();
+        auto start = std::chrono::steady_clock::now();
+        matches = body();
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        allocations = allocations_count.load() - before;
+        if (i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    double itemsPerSecond = best > 0.0 ? (double)items / best * 1000.0 : 0.0;
+    printf("%-48s %10zu %10.1f %10.2f %10zu %12zu %10.2f\n", name.mb_str(wxConvUTF8).data(), items, best,
+           itemsPerSecond / 1e6, matches, allocations, items ? (double)allocations / items : 0.0);
+    fflush(stdout);
+}
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = (i + 1) < argc;
+        if (strcmp(argv[i], "--scale") == 0 && hasValue) {
+            options.scale = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && hasValue) {
+            options.repeat = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--scale <factor>] [--repeat <count>] [--filter <text>]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.scale > 0.0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    wxInitializer initializer(argc, argv);
+    wxLogNull NOLOG;
+
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<wxString> paths;
+    std::vector<wxString> symbols;
+    make_paths(std::max((size_t)1, (size_t)(PATHS_COUNT * options.scale)), paths);
+    make_symbols(std::max((size_t)1, (size_t)(SYMBOLS_COUNT * options.scale)), symbols);
+    printf("Corpora: %zu paths, %zu symbols\n\n", paths.size(), symbols.size());
+    printf("%-48s %10s %10s %10s %10s %12s %10s\n", "Benchmark", "Items", "Time (ms)", "M items/s", "Matches",
+           "Allocations", "Allocs/item");
+
+    const std::vector<Corpus> corpora = {
+        { "paths", paths, "tree ctrl", "tcp", "tree ctrl" },
+        { "symbols", symbols, "get item", "gitx", "getitem" },
+    };
+
+    for (const Corpus& corpus : corpora) {
+        // FileUtils::FuzzyMatch: every word of the needle is a substring of the haystack, case insensitive
+        run(options, wxString() << "FileUtils::FuzzyMatch/" << corpus.name, corpus.items.size(), [&]() {
+            size_t matches = 0;
+            for (const wxString& haystack : corpus.items) {
+                matches += FileUtils::FuzzyMatch(corpus.words, haystack);
+            }
+            return matches;
+        });
+
+        // clAnagram::MatchesInOrder: the characters of the needle appear in order
+        clAnagram anagram(corpus.anagram, (size_t)eAnagramFlag::kIgnoreWhitespace);
+        run(options, wxString() << "clAnagram::MatchesInOrder/" << corpus.name, corpus.items.size(), [&]() {
+            size_t matches = 0;
+            for (const wxString& haystack : corpus.items) {
+                matches += anagram.MatchesInOrder(haystack);
+            }
+            return matches;
+        });
+    }
+
+    // The file spec and exclude patterns of the file system workspace and of the search filters
+    const wxString fileSpec = "*.cpp;*.h;*.hpp;CMakeLists.txt";
+    run(options, "FileUtils::WildMatch/paths", paths.size(), [&]() {
+        size_t matches = 0;
+        for (const wxString& path : paths) {
+            matches += FileUtils::WildMatch(fileSpec, path);
+        }
+        return matches;
+    });
+
+    wxArrayString fileSpecs = ::wxStringTokenize(fileSpec, ";", wxTOKEN_STRTOK);
+    run(options, "FileUtils::WildMatch(wxArrayString)/paths", paths.size(), [&]() {
+        size_t matches = 0;
+        for (const wxString& path : paths) {
+            matches += FileUtils::WildMatch(fileSpecs, path);
+        }
+        return matches;
+    });
+
+    clFileExtensionMatcher extensionMatcher(fileSpec);
+    run(options, "clFileExtensionMatcher::matches/paths", paths.size(), [&]() {
+        size_t matches = 0;
+        for (const wxString& path : paths) {
+            matches += extensionMatcher.matches(path);
+        }
+        return matches;
+    });
+
+    clPathExcluder pathExcluder("*/build/*;*/.git/*;*/third_party/*");
+    run(options, "clPathExcluder::is_exclude_path/paths", paths.size(), [&]() {
+        size_t matches = 0;
+        for (const wxString& path : paths) {
+            matches += pathExcluder.is_exclude_path(path);
+        }
+        return matches;
+    });
+
+    // The ranked matcher: building the table, then finding the best matches
+    for (const Corpus& corpus : corpora) {
+        clFuzzyMatcher matcher;
+        auto build = [&]() {
+            matcher.Clear();
+            matcher.Reserve(corpus.items.size());
+            for (const wxString& text : corpus.items) {
+                matcher.Add(text);
+            }
+            return matcher.GetCount();
+        };
+        run(options, wxString() << "clFuzzyMatcher::Add/" << corpus.name, corpus.items.size(), build);
+        if (matcher.IsEmpty()) {
+            // the benchmark above was filtered out
+            build();
+        }
+
+        clFuzzyQuery query(corpus.query);
+        run(options, wxString() << "clFuzzyMatcher::Find(1 thread)/" << corpus.name, corpus.items.size(),
+            [&]() { return matcher.Find(query, 100, 1).size(); });
+        run(options, wxString() << "clFuzzyMatcher::Find/" << corpus.name, corpus.items.size(),
+            [&]() { return matcher.Find(query, 100).size(); });
+        run(options, wxString() << "clFuzzyMatcher::Filter/" << corpus.name, corpus.items.size(),
+            [&]() { return matcher.Filter(query).size(); });
+    }
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include "BuildLogStore.hpp"
+
+#include "StringUtils.h"
+#include "cl_standard_paths.h"
+#include "file_logger.h"
+#include "fileutils.h"
+
+#include <algorithm>
+#include <memory>
+#include <wx/filefn.h>
+#include <wx/regex.h>
+
+BuildLogStore::BuildLogStore() {}
+
+BuildLogStore::~BuildLogStore() { Clear(); }
+
+bool BuildLogStore::EnsureFileOpened()
+{
+    if (m_fp) {
+        return true;
+    }
+
+    if (m_path.empty()) {
+        wxString tmpdir = clStandardPaths::Get().GetTempDir();
+        wxFileName::Mkdir(tmpdir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        m_path = FileUtils::CreateTempFileName(tmpdir, "build-log", "txt").GetFullPath();
+    }
+
+    m_fp = wxFopen(m_path, "w+b");
+    if (!m_fp) {
+        clWARNING() << "Failed to open build log file:" << m_path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool BuildLogStore::EnsureMapped()
+{
+    if (m_mapping.IsOpened() && m_mappedBytes == m_bytesWritten) {
+        return true;
+    }
+
+    // the log grew since it was mapped, remap it
+    if (m_fp) {
+        fflush(m_fp);
+    }
+    if (!m_mapping.Open(m_path)) {
+        m_mappedBytes = 0;
+        return false;
+    }
+    m_mappedBytes = m_mapping.GetSize();
+    return m_mappedBytes == m_bytesWritten;
+}
+
+void BuildLogStore::Clear()
+{
+    m_mapping.Close();
+    m_mappedBytes = 0;
+    if (m_fp) {
+        fclose(m_fp);
+        m_fp = nullptr;
+    }
+    if (!m_path.empty()) {
+        FileUtils::RemoveFile(m_path);
+        m_path.clear();
+    }
+
+    m_bytesWritten = 0;
+    m_offsets.clear();
+    m_kinds.clear();
+    m_lineProject.clear();
+    m_styled.clear();
+    m_styledCount = 0;
+    m_projects.clear();
+    m_boundaries.clear();
+    m_diagnostics.clear();
+    m_errorCount = 0;
+    m_warningCount = 0;
+}
+
+unsigned int BuildLogStore::GetProjectIndex(const wxString& project)
+{
+    // a build log mentions a handful of projects, and the current one is almost always the last one
+    for (size_t i = m_projects.size(); i > 0; --i) {
+        if (m_projects[i - 1] == project) {
+            return i - 1;
+        }
+    }
+    m_projects.push_back(project);
+    return m_projects.size() - 1;
+}
+
+size_t BuildLogStore::AppendLine(const wxString& line, const wxString& project, eLineKind kind,
+                                 const Diagnostic* diagnostic, const wxString& styled)
+{
+    size_t line_number = m_offsets.size();
+    m_offsets.push_back(m_bytesWritten);
+    m_kinds.push_back(kind);
+    m_lineProject.push_back(GetProjectIndex(project));
+    bool is_styled = !styled.empty() && styled != line;
+    m_styled.push_back(is_styled);
+    if (is_styled) {
+        ++m_styledCount;
+    }
+
+    switch (kind) {
+    case kError:
+        ++m_errorCount;
+        break;
+    case kWarning:
+        ++m_warningCount;
+        break;
+    case kProjectBoundary:
+        m_boundaries.push_back(line_number);
+        break;
+    default:
+        break;
+    }
+
+    if (diagnostic) {
+        m_diagnostics.insert({ line_number, *diagnostic });
+    }
+
+    if (EnsureFileOpened()) {
+        const wxScopedCharBuffer utf8 = is_styled ? styled.ToUTF8() : line.ToUTF8();
+        fwrite(utf8.data(), 1, utf8.length(), m_fp);
+        fputc('\n', m_fp);
+        m_bytesWritten += utf8.length() + 1;
+    }
+    return line_number;
+}
+
+wxString BuildLogStore::GetLine(size_t n)
+{
+    if (n >= m_styled.size() || !m_styled[n]) {
+        return DoGetLine(n);
+    }
+    wxString text;
+    StringUtils::StripTerminalColouring(DoGetLine(n), text);
+    return text;
+}
+
+wxString BuildLogStore::DoGetLine(size_t n)
+{
+    if (n >= m_offsets.size() || !EnsureMapped() || m_mapping.GetData() == nullptr) {
+        return wxEmptyString;
+    }
+
+    size_t start = m_offsets[n];
+    size_t end = (n + 1 < m_offsets.size()) ? m_offsets[n + 1] : m_bytesWritten;
+    if (end <= start) {
+        return wxEmptyString;
+    }
+    // exclude the line terminator
+    return wxString::FromUTF8(m_mapping.GetData() + start, end - start - 1);
+}
+
+const wxString& BuildLogStore::GetLineProject(size_t n) const
+{
+    static const wxString empty_string;
+    if (n >= m_lineProject.size()) {
+        return empty_string;
+    }
+    return m_projects[m_lineProject[n]];
+}
+
+const BuildLogStore::Diagnostic* BuildLogStore::GetDiagnostic(size_t n) const
+{
+    auto iter = m_diagnostics.find(n);
+    if (iter == m_diagnostics.end()) {
+        return nullptr;
+    }
+    return &iter->second;
+}
+
+bool BuildLogStore::Matches(size_t n, const Filter& filter, wxRegEx* re, const wxString* text)
+{
+    if (n >= m_offsets.size()) {
+        return false;
+    }
+
+    // check the cheap conditions first
+    if (filter.kinds && (m_kinds[n] & filter.kinds) == 0) {
+        return false;
+    }
+
+    if (!filter.project.empty() && m_projects[m_lineProject[n]] != filter.project) {
+        return false;
+    }
+
+    if (re && re->IsValid() && !re->Matches(text ? *text : GetLine(n))) {
+        return false;
+    }
+    return true;
+}
+
+std::vector<size_t> BuildLogStore::FilterLines(const Filter& filter, size_t limit)
+{
+    std::vector<size_t> result;
+    std::unique_ptr<wxRegEx> re;
+    if (!filter.pattern.empty()) {
+        re.reset(new wxRegEx(filter.pattern, wxRE_DEFAULT | wxRE_ICASE));
+        if (!re->IsValid()) {
+            return result;
+        }
+    }
+
+    // when filtering by project, only scan the lines that belong to the project
+    unsigned int project_index = 0;
+    if (!filter.project.empty()) {
+        auto where = std::find(m_projects.begin(), m_projects.end(), filter.project);
+        if (where == m_projects.end()) {
+            return result;
+        }
+        project_index = std::distance(m_projects.begin(), where);
+    }
+
+    for (size_t i = 0; i < m_offsets.size() && result.size() < limit; ++i) {
+        if (!filter.project.empty() && m_lineProject[i] != project_index) {
+            continue;
+        }
+        if (Matches(i, filter, re.get())) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+bool BuildLogStore::SaveTo(const wxString& path)
+{
+    if (m_offsets.empty()) {
+        return FileUtils::WriteFileContent(path, wxEmptyString);
+    }
+
+    if (m_styledCount == 0) {
+        if (m_fp) {
+            fflush(m_fp);
+        }
+        return ::wxCopyFile(m_path, path, true);
+    }
+
+    // strip the colouring
+    FILE* fp = wxFopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < m_offsets.size() && ok; ++i) {
+        const wxScopedCharBuffer utf8 = GetLine(i).ToUTF8();
+        ok = fwrite(utf8.data(), 1, utf8.length(), fp) == utf8.length() && fputc('\n', fp) != EOF;
+    }
+    return fclose(fp) == 0 && ok;
+}
@@ -0,0 +1,133 @@
+#ifndef BUILDLOGSTORE_HPP
+#define BUILDLOGSTORE_HPP
+
+#include "clMemoryMappedFile.hpp"
+#include "compiler.h"
+
+#include <stdio.h>
+#include <unordered_map>
+#include <vector>
+#include <wx/string.h>
+
+class wxRegEx;
+
+/// The line store of the build output.
+///
+/// Lines are appended to a spill file in the temp folder and read back through a read-only memory mapping, so the size
+/// of the log is bounded by the disk rather than by the memory. A line is stored as it is displayed, with its terminal
+/// colouring, and the colouring is stripped when the plain text is read back. While lines are
+/// added, errors, warnings and "Building project" boundaries are indexed so the log can be filtered by severity,
+/// project or a regular expression without re-parsing it
+class BuildLogStore
+{
+public:
+    enum eLineKind : unsigned char {
+        kNormal = 0,
+        kWarning = (1 << 0),
+        kError = (1 << 1),
+        kProjectBoundary = (1 << 2),
+    };
+
+    struct Diagnostic {
+        Compiler::PatternMatch match_pattern;
+        wxString root_dir;
+        wxString toolchain;
+    };
+
+    struct Filter {
+        /// mask of eLineKind, 0 means: any line
+        size_t kinds = 0;
+        /// show only lines of this project, empty means: all projects
+        wxString project;
+        /// regular expression to match against the line, empty means: match all
+        wxString pattern;
+
+        bool IsEmpty() const { return kinds == 0 && project.empty() && pattern.empty(); }
+    };
+
+private:
+    wxString m_path;
+    FILE* m_fp = nullptr;
+    size_t m_bytesWritten = 0;
+    std::vector<size_t> m_offsets;
+    std::vector<unsigned char> m_kinds;
+    std::vector<unsigned int> m_lineProject;
+    /// is the line stored with its terminal colouring?
+    std::vector<bool> m_styled;
+    size_t m_styledCount = 0;
+    std::vector<wxString> m_projects;
+    std::vector<size_t> m_boundaries;
+    size_t m_errorCount = 0;
+    size_t m_warningCount = 0;
+    std::unordered_map<size_t, Diagnostic> m_diagnostics;
+
+    clMemoryMappedFile m_mapping;
+    size_t m_mappedBytes = 0;
+
+protected:
+    bool EnsureFileOpened();
+    bool EnsureMapped();
+    unsigned int GetProjectIndex(const wxString& project);
+    /// line `n` as stored in the spill file
+    wxString DoGetLine(size_t n);
+
+public:
+    BuildLogStore();
+    ~BuildLogStore();
+
+    /**
+     * @brief remove all lines and truncate the spill file
+     */
+    void Clear();
+
+    /**
+     * @brief append a line and index it. `line` is the text without the terminal colouring, `styled` the same text as
+     * displayed (empty if it has no colouring). Return the line number
+     */
+    size_t AppendLine(const wxString& line, const wxString& project, eLineKind kind = kNormal,
+                      const Diagnostic* diagnostic = nullptr, const wxString& styled = wxEmptyString);
+
+    size_t GetLineCount() const { return m_offsets.size(); }
+    size_t GetErrorCount() const { return m_errorCount; }
+    size_t GetWarningCount() const { return m_warningCount; }
+
+    /**
+     * @brief return line `n` read from the spill file, without the terminal colouring
+     */
+    wxString GetLine(size_t n);
+    /**
+     * @brief return line `n` as it was displayed, with its terminal colouring
+     */
+    wxString GetStyledLine(size_t n) { return DoGetLine(n); }
+    eLineKind GetLineKind(size_t n) const { return n < m_kinds.size() ? (eLineKind)m_kinds[n] : kNormal; }
+    const wxString& GetLineProject(size_t n) const;
+    const Diagnostic* GetDiagnostic(size_t n) const;
+
+    /**
+     * @brief return the line numbers of the "Building project" lines
+     */
+    const std::vector<size_t>& GetProjectBoundaries() const { return m_boundaries; }
+
+    /**
+     * @brief return the names of the projects seen in the log, by order of appearance
+     */
+    const std::vector<wxString>& GetProjects() const { return m_projects; }
+
+    /**
+     * @brief return true if line `n` passes `filter`. If the filter has a pattern, `re` must be compiled from it.
+     * When the caller already holds the line content, it can pass it in `text` to avoid reading it from the file
+     */
+    bool Matches(size_t n, const Filter& filter, wxRegEx* re, const wxString* text = nullptr);
+
+    /**
+     * @brief return the numbers of all lines matching the filter, up to `limit` results
+     */
+    std::vector<size_t> FilterLines(const Filter& filter, size_t limit = wxString::npos);
+
+    /**
+     * @brief write the log, without the terminal colouring, to `path`
+     */
+    bool SaveTo(const wxString& path);
+};
+
+#endif // BUILDLOGSTORE_HPP
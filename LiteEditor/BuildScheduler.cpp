@@ -0,0 +1,622 @@
+#include "BuildScheduler.hpp"
+
+#include "StringUtils.h"
+#include "build_config.h"
+#include "clean_request.h"
+#include "cl_config.h"
+#include "compile_request.h"
+#include "custombuildrequest.h"
+#include "environmentconfig.h"
+#include "event_notifier.h"
+#include "file_logger.h"
+#include "macros.h"
+#include "pluginmanager.h"
+#include "procutils.h"
+#include "shell_command.h"
+#include "workspace.h"
+
+#include <algorithm>
+#include <wx/filename.h>
+#include <wx/regex.h>
+#include <wx/thread.h>
+
+#define SCHEDULER_POLL_INTERVAL 100 // ms
+
+namespace
+{
+bool IsCleanCommand(const QueueCommand& command)
+{
+    return command.GetKind() == QueueCommand::kClean ||
+           (command.GetKind() == QueueCommand::kCustomBuild && command.GetCustomBuildTarget().CmpNoCase("clean") == 0);
+}
+} // namespace
+
+BuildScheduler::BuildScheduler()
+{
+    m_timer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &BuildScheduler::OnTimer, this, m_timer->GetId());
+    Bind(wxEVT_BUILD_PROCESS_ADDLINE, &BuildScheduler::OnJobAddLine, this);
+    Bind(wxEVT_BUILD_PROCESS_ENDED, &BuildScheduler::OnJobEnded, this);
+}
+
+BuildScheduler::~BuildScheduler()
+{
+    Unbind(wxEVT_TIMER, &BuildScheduler::OnTimer, this, m_timer->GetId());
+    Unbind(wxEVT_BUILD_PROCESS_ADDLINE, &BuildScheduler::OnJobAddLine, this);
+    Unbind(wxEVT_BUILD_PROCESS_ENDED, &BuildScheduler::OnJobEnded, this);
+    m_timer->Stop();
+    wxDELETE(m_timer);
+    while (!m_probeThreads.empty()) {
+        JoinProbeThread(m_probeThreads.begin()->first);
+    }
+}
+
+bool BuildScheduler::Start(const std::list<QueueCommand>& commands)
+{
+    if (IsRunning() || commands.empty()) {
+        return false;
+    }
+
+    for (const auto& command : commands) {
+        std::unique_ptr<Job> job(new Job(command));
+        job->prefix = MakeLinePrefix(command.GetProject(), command.GetConfiguration());
+        BuildConfigPtr bldConf =
+            clCxxWorkspaceST::Get()->GetProjBuildConf(command.GetProject(), command.GetConfiguration());
+        if (bldConf) {
+            job->compiler = bldConf->GetCompiler();
+            BuilderPtr builder = bldConf->GetBuilder();
+            job->workspace_builder = builder && builder->IsWorkspaceBuilder();
+        }
+        m_jobs.push_back(std::move(job));
+    }
+    BuildGraph();
+
+    int slots = clConfig::Get().Read(kConfigBuildSchedulerSlots, (int)wxThread::GetCPUCount());
+    m_slots = slots > 0 ? slots : 1;
+    int max_jobs = clConfig::Get().Read(kConfigBuildSchedulerMaxJobs, (int)m_slots);
+    m_maxJobs = wxMax(1, wxMin(max_jobs, (int)m_slots));
+    m_running = 0;
+    m_implicitSlotUsed = false;
+    m_finishing = false;
+
+    if (!m_jobServer.Create(m_slots)) {
+        clWARNING() << "Build scheduler: jobserver is not available, splitting" << m_slots << "slots between"
+                    << m_maxJobs << "jobs" << endl;
+    }
+
+    // the build tab sees the batch as a single build
+    const QueueCommand& first = commands.front();
+    clBuildEvent start_event(wxEVT_BUILD_PROCESS_STARTED);
+    start_event.SetCleanLog(first.GetCleanLog());
+    start_event.SetProjectName(first.GetProject());
+    start_event.SetConfigurationName(first.GetConfiguration());
+    start_event.SetToolchain(m_jobs[0]->compiler ? m_jobs[0]->compiler->GetName() : wxString());
+    start_event.SetFlag(clBuildEvent::kClean, IsCleanCommand(first));
+    start_event.SetFlag(clBuildEvent::kParallel, true);
+    EventNotifier::Get()->AddPendingEvent(start_event);
+
+    // the jobs start once we know which make tools can join the jobserver: `make --version` is not run on the main
+    // thread
+    std::vector<wxString> tools;
+    if (m_jobServer.IsOk()) {
+        for (const auto& job : m_jobs) {
+            if (!job->compiler || job->command.GetKind() == QueueCommand::kCustomBuild) {
+                continue;
+            }
+            wxString exe = GetMakeExecutable(job->compiler->GetTool("MAKE"));
+            if (!exe.empty() && m_jobServerSupport.count(exe) == 0 &&
+                std::find(tools.begin(), tools.end(), exe) == tools.end()) {
+                tools.push_back(exe);
+            }
+        }
+    }
+
+    if (tools.empty()) {
+        Schedule();
+    } else {
+        ProbeMakeTools(tools);
+    }
+    return true;
+}
+
+void BuildScheduler::ProbeMakeTools(const std::vector<wxString>& tools)
+{
+    // a probe still running for a previous build is not waited for: its result is kept, but it does not start the jobs
+    size_t probe_id = ++m_probeId;
+    m_probeThreads[probe_id] = new std::thread([this, tools, probe_id]() {
+        std::unordered_map<wxString, bool> results;
+        for (const wxString& exe : tools) {
+            results.insert({ exe, IsJobServerSupported(exe) });
+        }
+        CallAfter([this, results, probe_id]() { OnMakeToolsProbed(results, probe_id); });
+    });
+}
+
+void BuildScheduler::OnMakeToolsProbed(const std::unordered_map<wxString, bool>& results, size_t probe_id)
+{
+    // the thread is done once it delivered its result
+    JoinProbeThread(probe_id);
+    m_jobServerSupport.insert(results.begin(), results.end());
+
+    // the build may have been stopped, or another one started, while probing
+    if (probe_id == m_probeId && IsRunning()) {
+        Schedule();
+    }
+}
+
+void BuildScheduler::JoinProbeThread(size_t probe_id)
+{
+    auto iter = m_probeThreads.find(probe_id);
+    if (iter == m_probeThreads.end()) {
+        return;
+    }
+    std::thread* thr = iter->second;
+    m_probeThreads.erase(iter);
+    thr->join();
+    wxDELETE(thr);
+}
+
+void BuildScheduler::Stop()
+{
+    for (auto& job : m_jobs) {
+        if (job->state == kJobPending) {
+            job->state = kJobSkipped;
+        }
+    }
+
+    for (auto& job : m_jobs) {
+        if (job->state == kJobRunning && job->shell && job->shell->IsBusy()) {
+            // the end event is handled by OnJobEnded
+            job->shell->Stop();
+        }
+    }
+    Schedule();
+}
+
+void BuildScheduler::BuildGraph()
+{
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        Job& job = *m_jobs[i];
+        if (IsCleanCommand(job.command)) {
+            // cleaning does not depend on the build order
+            continue;
+        }
+
+        wxString errmsg;
+        ProjectPtr project = clCxxWorkspaceST::Get()->FindProjectByName(job.command.GetProject(), errmsg);
+        if (!project) {
+            continue;
+        }
+
+        wxArrayString dependencies = project->GetDependencies(job.command.GetConfiguration());
+        for (const wxString& dependency : dependencies) {
+            // prefer the job building the dependency with the same configuration, if there is none, wait for all
+            // the jobs building the dependency
+            std::vector<size_t> candidates;
+            for (size_t j = 0; j < m_jobs.size(); ++j) {
+                const Job& other = *m_jobs[j];
+                if (j == i || other.command.GetProject() != dependency || IsCleanCommand(other.command)) {
+                    continue;
+                }
+                if (other.command.GetConfiguration() == job.command.GetConfiguration()) {
+                    candidates = { j };
+                    break;
+                }
+                candidates.push_back(j);
+            }
+            job.dependencies.insert(job.dependencies.end(), candidates.begin(), candidates.end());
+        }
+    }
+}
+
+bool BuildScheduler::IsReady(const Job& job, bool* skip) const
+{
+    *skip = false;
+    bool ready = true;
+    for (size_t dependency : job.dependencies) {
+        switch (m_jobs[dependency]->state) {
+        case kJobSucceeded:
+            break;
+        case kJobFailed:
+        case kJobSkipped:
+            *skip = true;
+            return false;
+        default:
+            ready = false;
+            break;
+        }
+    }
+    return ready;
+}
+
+bool BuildScheduler::IsProjectBusy(const Job& job) const
+{
+    if (job.command.GetKind() == QueueCommand::kCustomBuild) {
+        return false;
+    }
+
+    // the generated makefile of a project is shared by all its configurations, and a workspace builder drives
+    // a single build for all the projects
+    for (const auto& other : m_jobs) {
+        if (other->state != kJobRunning || other->command.GetKind() == QueueCommand::kCustomBuild) {
+            continue;
+        }
+        if (other->command.GetProject() == job.command.GetProject() ||
+            (job.workspace_builder && other->workspace_builder)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BuildScheduler::AcquireSlot(bool* holds_token)
+{
+    *holds_token = false;
+    if (m_running >= m_maxJobs) {
+        return false;
+    }
+
+    if (!m_implicitSlotUsed) {
+        m_implicitSlotUsed = true;
+        return true;
+    }
+
+    if (!m_jobServer.IsOk()) {
+        return true;
+    }
+
+    // compete with the running make processes for a token
+    *holds_token = m_jobServer.TryAcquire();
+    return *holds_token;
+}
+
+void BuildScheduler::Schedule()
+{
+    bool waiting_for_slot = false;
+    bool progress = true;
+    while (progress && !waiting_for_slot) {
+        progress = false;
+        for (auto& job : m_jobs) {
+            if (job->state != kJobPending) {
+                continue;
+            }
+
+            bool skip = false;
+            if (!IsReady(*job, &skip)) {
+                if (skip) {
+                    job->state = kJobSkipped;
+                    ForwardLines(*job, _("Skipped: a dependency of this project failed to build\n"), true);
+                    progress = true;
+                }
+                continue;
+            }
+
+            if (IsProjectBusy(*job)) {
+                continue;
+            }
+
+            bool holds_token = false;
+            if (!AcquireSlot(&holds_token)) {
+                // when the jobserver pool is empty, poll it until a make process returns a token
+                waiting_for_slot = m_running > 0 && m_running < m_maxJobs;
+                break;
+            }
+
+            job->holds_token = holds_token;
+            job->state = kJobRunning;
+            ++m_running;
+            if (!StartJob(*job)) {
+                job->failed = true;
+                JobEnded(*job);
+                progress = true;
+            }
+        }
+    }
+
+    if (m_running == 0) {
+        // nothing is running and nothing can start: what is left waits on a dependency cycle
+        for (auto& job : m_jobs) {
+            if (job->state == kJobPending) {
+                job->state = kJobSkipped;
+                ForwardLines(*job, _("Skipped: circular dependency between the projects\n"), true);
+            }
+        }
+
+        if (!m_finishing && IsRunning()) {
+            // let the output already posted by the jobs reach the build tab first
+            m_finishing = true;
+            CallAfter(&BuildScheduler::Finish);
+        }
+
+    } else if (waiting_for_slot && !m_timer->IsRunning()) {
+        m_timer->StartOnce(SCHEDULER_POLL_INTERVAL);
+    }
+}
+
+wxString BuildScheduler::GetMakeExecutable(const wxString& make_tool)
+{
+    wxString tool = EnvironmentConfig::Instance()->ExpandVariables(make_tool, true);
+    tool.Trim().Trim(false);
+
+    wxString exe;
+    if (tool.StartsWith("\"")) {
+        exe = tool.Mid(1).BeforeFirst('"');
+    } else {
+        exe = tool.BeforeFirst(' ');
+    }
+
+    // nmake (or a script setting up the environment for it) can not join the jobserver
+    wxString name = wxFileName(exe).GetName().Lower();
+    if (!name.Contains("make") || name == "nmake") {
+        return wxEmptyString;
+    }
+    return exe;
+}
+
+bool BuildScheduler::IsJobServerSupported(const wxString& make_exe)
+{
+    // runs on the probing thread
+    wxRegEx re_version(R"(GNU Make ([0-9]+)\.([0-9]+))");
+    wxString output = ProcUtils::SafeExecuteCommand(StringUtils::WrapWithDoubleQuotes(make_exe) + " --version");
+    bool supported = false;
+    if (re_version.IsValid() && re_version.Matches(output)) {
+        long major = 0, minor = 0;
+        re_version.GetMatch(output, 1).ToCLong(&major);
+        re_version.GetMatch(output, 2).ToCLong(&minor);
+        supported = clJobServer::IsMakeVersionSupported(major, minor);
+    }
+    clDEBUG() << "Build scheduler:" << make_exe << "can join the jobserver:" << supported << endl;
+    return supported;
+}
+
+bool BuildScheduler::CanJoinJobServer(const wxString& make_tool) const
+{
+    auto iter = m_jobServerSupport.find(GetMakeExecutable(make_tool));
+    return iter != m_jobServerSupport.end() && iter->second;
+}
+
+bool BuildScheduler::StartJob(Job& job)
+{
+    ShellCommand* shell = nullptr;
+    switch (job.command.GetKind()) {
+    case QueueCommand::kClean:
+        shell = new CleanRequest(job.command);
+        break;
+    case QueueCommand::kCustomBuild:
+        shell = new CustomBuildRequest(job.command, wxEmptyString);
+        break;
+    case QueueCommand::kBuild:
+    case QueueCommand::kRebuild:
+        shell = new CompileRequest(job.command);
+        break;
+    default:
+        ForwardLines(job, _("Command is not supported by a parallel build\n"), true);
+        return false;
+    }
+    job.shell.reset(shell);
+    shell->SetEventSink(this);
+
+    if (job.command.GetKind() != QueueCommand::kCustomBuild) {
+        // make joins the jobserver only if it was not given its own -j
+        if (job.compiler && m_jobServer.IsOk() && CanJoinJobServer(job.compiler->GetTool("MAKE"))) {
+            shell->SetProcessEnvironment({ { "MAKEFLAGS", m_jobServer.GetMakeFlags() } });
+            shell->SetCommandFilter([](const wxString& cmd) { return ReplaceJobsFlag(cmd, wxEmptyString); });
+
+        } else {
+            wxString jobs_flag;
+            jobs_flag << "-j" << wxMax((size_t)1, m_slots / m_maxJobs);
+            shell->SetCommandFilter([jobs_flag](const wxString& cmd) { return ReplaceJobsFlag(cmd, jobs_flag); });
+        }
+    }
+
+    shell->Process(PluginManager::Get());
+    if (!shell->IsBusy()) {
+        // the command printed the reason (if any) to the build output
+        clDEBUG() << "Build scheduler: command for" << job.prefix << "did not start" << endl;
+        return false;
+    }
+    return true;
+}
+
+void BuildScheduler::JobEnded(Job& job)
+{
+    ForwardLines(job, wxEmptyString, true);
+    job.state = job.failed ? kJobFailed : kJobSucceeded;
+    --m_running;
+    if (job.holds_token) {
+        m_jobServer.Release();
+        job.holds_token = false;
+    } else {
+        m_implicitSlotUsed = false;
+    }
+}
+
+BuildScheduler::Job* BuildScheduler::FindJob(wxObject* shell) const
+{
+    for (const auto& job : m_jobs) {
+        if (shell && job->shell.get() == shell) {
+            return job.get();
+        }
+    }
+    return nullptr;
+}
+
+void BuildScheduler::OnJobAddLine(clBuildEvent& event)
+{
+    Job* job = FindJob(event.GetEventObject());
+    CHECK_PTR_RET(job);
+    ForwardLines(*job, event.GetString(), false);
+}
+
+void BuildScheduler::OnJobEnded(clBuildEvent& event)
+{
+    Job* job = FindJob(event.GetEventObject());
+    CHECK_PTR_RET(job);
+    if (job->state != kJobRunning) {
+        return;
+    }
+
+    // the exit code decides. Where the platform did not report it, fall back to the errors seen in the output
+    int exit_code = 0;
+    if (job->shell && job->shell->GetExitCode(exit_code)) {
+        job->failed = exit_code != 0;
+    } else {
+        job->failed = job->error_reported;
+    }
+    JobEnded(*job);
+    Schedule();
+}
+
+void BuildScheduler::OnTimer(wxTimerEvent& event)
+{
+    wxUnusedVar(event);
+    Schedule();
+}
+
+void BuildScheduler::ForwardLines(Job& job, const wxString& text, bool flush)
+{
+    static wxRegEx re_make_error(R"(make(\[[0-9]+\])?(\.exe)?: \*\*\*)");
+
+    job.partial_line << text;
+    wxString output;
+    size_t start = 0;
+    while (start < job.partial_line.length()) {
+        size_t end = job.partial_line.find('\n', start);
+        if (end == wxString::npos && !flush) {
+            break;
+        }
+
+        wxString line = job.partial_line.Mid(start, end == wxString::npos ? wxString::npos : end - start);
+        start = end == wxString::npos ? job.partial_line.length() : end + 1;
+        output << job.prefix << line << "\n";
+
+        // only used when the exit code of the command is not known
+        wxString stripped_line;
+        StringUtils::StripTerminalColouring(line, stripped_line);
+        Compiler::PatternMatch match;
+        if ((job.compiler && job.compiler->Matches(stripped_line, &match) && match.sev == Compiler::kSevError) ||
+            re_make_error.Matches(stripped_line)) {
+            job.error_reported = true;
+        }
+    }
+    job.partial_line.erase(0, start);
+
+    if (output.empty()) {
+        return;
+    }
+    clBuildEvent add_line_event(wxEVT_BUILD_PROCESS_ADDLINE);
+    add_line_event.SetString(output);
+    EventNotifier::Get()->AddPendingEvent(add_line_event);
+}
+
+void BuildScheduler::Finish()
+{
+    m_finishing = false;
+    if (m_running > 0) {
+        return;
+    }
+
+    m_timer->Stop();
+    m_jobServer.Destroy();
+    m_jobs.clear();
+
+    clBuildEvent event(wxEVT_BUILD_PROCESS_ENDED);
+    EventNotifier::Get()->AddPendingEvent(event);
+}
+
+wxString BuildScheduler::MakeLinePrefix(const wxString& project, const wxString& config)
+{
+    wxString prefix;
+    prefix << "[" << project << "|" << config << "] ";
+    return prefix;
+}
+
+bool BuildScheduler::ParseLinePrefix(const wxString& line, wxString* project, wxString* config, wxString* text)
+{
+    if (!line.StartsWith("[")) {
+        return false;
+    }
+
+    size_t end = line.find("] ");
+    if (end == wxString::npos) {
+        return false;
+    }
+
+    wxString tag = line.Mid(1, end - 1);
+    if (!tag.Contains("|")) {
+        return false;
+    }
+
+    if (project) {
+        *project = tag.BeforeFirst('|');
+    }
+    if (config) {
+        *config = tag.AfterFirst('|');
+    }
+    if (text) {
+        *text = line.Mid(end + 2);
+    }
+    return true;
+}
+
+wxString BuildScheduler::ReplaceJobsFlag(const wxString& command, const wxString& replacement)
+{
+    wxString result;
+    size_t i = 0;
+    const size_t count = command.length();
+    while (i < count) {
+        wxChar ch = command[i];
+        if (ch == '"' || ch == '\'') {
+            // copy quoted strings as-is
+            size_t end = command.find(ch, i + 1);
+            end = end == wxString::npos ? count : end + 1;
+            result << command.Mid(i, end - i);
+            i = end;
+            continue;
+        }
+
+        bool word_start = (i == 0 || wxIsspace(command[i - 1]));
+        if (word_start && ch == '-') {
+            size_t end = i;
+            while (end < count && !wxIsspace(command[end])) {
+                ++end;
+            }
+
+            wxString word = command.Mid(i, end - i);
+            bool is_jobs_flag = false;
+            if (word == "-j" || word == "--jobs") {
+                // the number of jobs is optional and can be passed as a separate argument
+                is_jobs_flag = true;
+                size_t num_start = end;
+                while (num_start < count && command[num_start] == ' ') {
+                    ++num_start;
+                }
+                size_t num_end = num_start;
+                while (num_end < count && wxIsdigit(command[num_end])) {
+                    ++num_end;
+                }
+                if (num_end > num_start && (num_end == count || wxIsspace(command[num_end]))) {
+                    end = num_end;
+                }
+            } else if (word.StartsWith("-j") && word.Mid(2).IsNumber()) {
+                is_jobs_flag = true;
+            } else if (word.StartsWith("--jobs=") && word.Mid(7).IsNumber()) {
+                is_jobs_flag = true;
+            }
+
+            if (is_jobs_flag) {
+                result << replacement;
+                i = end;
+                if (replacement.empty()) {
+                    while (i < count && command[i] == ' ') {
+                        ++i;
+                    }
+                }
+                continue;
+            }
+        }
+        result << ch;
+        ++i;
+    }
+    return result;
+}
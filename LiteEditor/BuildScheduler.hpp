@@ -0,0 +1,131 @@
+#ifndef BUILDSCHEDULER_HPP
+#define BUILDSCHEDULER_HPP
+
+#include "clJobServer.hpp"
+#include "cl_command_event.h"
+#include "compiler.h"
+#include "queuecommand.h"
+
+#include <list>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <wx/event.h>
+#include <wx/timer.h>
+
+class ShellCommand;
+
+#define kConfigBuildSchedulerEnabled "BuildScheduler/Enabled"
+#define kConfigBuildSchedulerSlots "BuildScheduler/Slots"
+#define kConfigBuildSchedulerMaxJobs "BuildScheduler/MaxParallelJobs"
+
+/// Runs the commands of a batch build concurrently.
+///
+/// A command starts once the commands building its dependencies (as set in the "Build Order" dialog) ended
+/// successfully. The number of commands running at the same time, and the number of compilations they run, is bounded
+/// by a global budget of job slots: the slots are served by a `clJobServer` which the make processes join, instead of
+/// each of them running with its own `-j`.
+/// The output of the commands is forwarded to the build tab as a single build, each line prefixed with the project
+/// and configuration of the command that printed it
+class BuildScheduler : public wxEvtHandler
+{
+    enum eJobState {
+        kJobPending,
+        kJobRunning,
+        kJobSucceeded,
+        kJobFailed,
+        kJobSkipped,
+    };
+
+    struct Job {
+        QueueCommand command;
+        std::vector<size_t> dependencies;
+        eJobState state = kJobPending;
+        std::unique_ptr<ShellCommand> shell;
+        wxString prefix;
+        wxString partial_line;
+        CompilerPtr compiler;
+        bool holds_token = false;
+        bool failed = false;
+        /// the output reported an error, used when the exit code of the command is not known
+        bool error_reported = false;
+        bool workspace_builder = false;
+
+        Job(const QueueCommand& cmd)
+            : command(cmd)
+        {
+        }
+    };
+
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    clJobServer m_jobServer;
+    wxTimer* m_timer = nullptr;
+    size_t m_maxJobs = 1;
+    size_t m_slots = 1;
+    size_t m_running = 0;
+    bool m_implicitSlotUsed = false;
+    bool m_finishing = false;
+    /// make executable -> can it join the jobserver. Filled once per executable, by a background thread
+    std::unordered_map<wxString, bool> m_jobServerSupport;
+    /// the `make --version` probes, by probe id. A probe is joined once its result is delivered: the UI thread never
+    /// waits for a running probe, except on destruction
+    std::unordered_map<size_t, std::thread*> m_probeThreads;
+    size_t m_probeId = 0;
+
+protected:
+    void OnJobAddLine(clBuildEvent& event);
+    void OnJobEnded(clBuildEvent& event);
+    void OnTimer(wxTimerEvent& event);
+
+    Job* FindJob(wxObject* shell) const;
+    void BuildGraph();
+    void Schedule();
+    bool IsReady(const Job& job, bool* skip) const;
+    bool IsProjectBusy(const Job& job) const;
+    bool AcquireSlot(bool* holds_token);
+    bool StartJob(Job& job);
+    void JobEnded(Job& job);
+    void ForwardLines(Job& job, const wxString& text, bool flush);
+    void Finish();
+    bool CanJoinJobServer(const wxString& make_tool) const;
+    void ProbeMakeTools(const std::vector<wxString>& tools);
+    void OnMakeToolsProbed(const std::unordered_map<wxString, bool>& results, size_t probe_id);
+    void JoinProbeThread(size_t probe_id);
+    static wxString GetMakeExecutable(const wxString& make_tool);
+    static bool IsJobServerSupported(const wxString& make_exe);
+
+public:
+    BuildScheduler();
+    virtual ~BuildScheduler();
+
+    /**
+     * @brief start building `commands`. Return false if a build is already running
+     */
+    bool Start(const std::list<QueueCommand>& commands);
+
+    /**
+     * @brief kill the running commands and drop the pending ones
+     */
+    void Stop();
+
+    bool IsRunning() const { return !m_jobs.empty(); }
+
+    /**
+     * @brief return the prefix of the lines printed by a command building `project` / `config`
+     */
+    static wxString MakeLinePrefix(const wxString& project, const wxString& config);
+
+    /**
+     * @brief if `line` starts with a command prefix, return true and split it into its project, configuration and
+     * the text printed by the command
+     */
+    static bool ParseLinePrefix(const wxString& line, wxString* project, wxString* config, wxString* text);
+
+    /**
+     * @brief replace the `-jN` / `--jobs=N` arguments of `command` with `replacement` (removed if empty)
+     */
+    static wxString ReplaceJobsFlag(const wxString& command, const wxString& replacement);
+};
+
+#endif // BUILDSCHEDULER_HPP
@@ -1,5 +1,6 @@
 #include "BuildTab.hpp"
 
+#include "BuildScheduler.hpp"
 #include "ColoursAndFontsManager.h"
 #include "StringUtils.h"
 #include "build_settings_config.h"
@@ -14,6 +15,7 @@
 #include "mainbook.h"
 #include "manager.h"
 #include "shell_command.h"
+#include "workspace.h"
 
 #include <wx/app.h>
 #include <wx/filedlg.h>
@@ -32,6 +34,9 @@ struct LineClientData {
     wxString toolchain;
 };
 
+/// the maximum number of lines shown in the view when a filter is applied
+constexpr size_t FILTERED_LINES_MAX = 100000;
+
 } // namespace
 
 BuildTab::BuildTab(wxWindow* parent)
@@ -40,9 +45,41 @@ BuildTab::BuildTab(wxWindow* parent)
     SetSizer(new wxBoxSizer(wxVERTICAL));
     GetSizer()->Fit(this);
 
+    // the filter bar
+    wxBoxSizer* filter_sizer = new wxBoxSizer(wxHORIZONTAL);
+    m_choiceSeverity = new wxChoice(this, wxID_ANY);
+    m_choiceSeverity->Append(_("All lines"));
+    m_choiceSeverity->Append(_("Errors"));
+    m_choiceSeverity->Append(_("Warnings"));
+    m_choiceSeverity->Append(_("Errors and warnings"));
+    m_choiceSeverity->SetSelection(0);
+
+    m_choiceProject = new wxChoice(this, wxID_ANY);
+    m_choiceProject->Append(_("All projects"));
+    m_choiceProject->SetSelection(0);
+
+    m_searchCtrl = new wxSearchCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+                                    wxTE_PROCESS_ENTER);
+    m_searchCtrl->SetDescriptiveText(_("Filter the build log using a regular expression"));
+    m_searchCtrl->ShowCancelButton(true);
+
+    filter_sizer->Add(m_choiceSeverity, 0, wxALIGN_CENTER_VERTICAL | wxALL, 2);
+    filter_sizer->Add(m_choiceProject, 0, wxALIGN_CENTER_VERTICAL | wxALL, 2);
+    filter_sizer->Add(m_searchCtrl, 1, wxALIGN_CENTER_VERTICAL | wxALL, 2);
+    GetSizer()->Add(filter_sizer, 0, wxEXPAND);
+
     m_view = new clTerminalViewCtrl(this);
     GetSizer()->Add(m_view, 1, wxEXPAND);
 
+    m_choiceSeverity->Bind(wxEVT_CHOICE, &BuildTab::OnFilterChanged, this);
+    m_choiceProject->Bind(wxEVT_CHOICE, &BuildTab::OnFilterChanged, this);
+    m_searchCtrl->Bind(wxEVT_TEXT_ENTER, &BuildTab::OnFilterChanged, this);
+    m_searchCtrl->Bind(wxEVT_SEARCHCTRL_SEARCH_BTN, &BuildTab::OnFilterChanged, this);
+    m_searchCtrl->Bind(wxEVT_SEARCHCTRL_CANCEL_BTN, [this](wxCommandEvent& event) {
+        m_searchCtrl->ChangeValue(wxEmptyString);
+        OnFilterChanged(event);
+    });
+
     // Event handling
     EventNotifier::Get()->Bind(wxEVT_BUILD_PROCESS_STARTED, &BuildTab::OnBuildStarted, this);
     EventNotifier::Get()->Bind(wxEVT_BUILD_PROCESS_ADDLINE, &BuildTab::OnBuildAddLine, this);
@@ -72,6 +109,7 @@ void BuildTab::OnBuildStarted(clBuildEvent& e)
 {
     e.Skip();
     m_buildInProgress = true;
+    m_parallelBuild = e.HasFlag(clBuildEvent::kParallel);
     m_currentRootDir.clear();
     m_currentProjectName.clear();
 
@@ -95,6 +133,7 @@ void BuildTab::OnBuildStarted(clBuildEvent& e)
 
     // clean the last used compiler
     m_activeCompiler = nullptr;
+    m_jobCompilers.clear();
     m_error_count = m_warn_count = 0;
 
     // get the toolchain from the event and attempt to load the compiler
@@ -106,11 +145,16 @@ void BuildTab::OnBuildStarted(clBuildEvent& e)
     } else {
       clDEBUG() << "Compiler not selected in the workspace build settings or not available" << endl;
 
-      // toolchain not selected in build configuration or unavailable
-      m_view->AppendItem(_("\n"));
-      m_view->AppendItem(WrapLineInColour(_("> WARNING: No toolchain selected. Build log highlighting will not be available!\n"), AnsiColours::Yellow()));
-      m_view->AppendItem(WrapLineInColour(_("           Check toolchain properly selected in the workspace build settings.\n"), AnsiColours::Yellow()));
-      m_view->AppendItem(_("\n"));
+      // toolchain not selected in build configuration or unavailable. The banner goes to the log as well, so the
+      // text filter keeps it. It is not a compiler warning: it is not counted, nor reached by the warnings navigation
+      const wxString warning_lines[] = {
+          wxEmptyString, _("> WARNING: No toolchain selected. Build log highlighting will not be available!"),
+          _("           Check toolchain properly selected in the workspace build settings."), wxEmptyString
+      };
+      for(const wxString& text : warning_lines) {
+          wxString line = text.empty() ? text : WrapLineInColour(text, AnsiColours::Yellow());
+          AppendViewLine(m_log.AppendLine(text, wxEmptyString, BuildLogStore::kNormal, nullptr, line), text, line);
+      }
     }
 
     // notify the plugins that the build had started
@@ -183,45 +227,66 @@ void BuildTab::ProcessBuffer(bool last_line)
         }
         line.Trim();
 
+        // remove the terminal ascii colouring escape code
+        wxString stripped_line;
+        StringUtils::StripTerminalColouring(line, stripped_line);
+
+        // in a parallel build, the line starts with the project / configuration of the job that printed it, and is
+        // matched with the compiler of that job
+        wxString line_project = GetCurrentProjectName();
+        wxString line_config;
+        wxString text = stripped_line;
+        CompilerPtr compiler = m_activeCompiler;
+        if(m_parallelBuild && BuildScheduler::ParseLinePrefix(stripped_line, &line_project, &line_config, &text)) {
+            compiler = GetJobCompiler(line_project, line_config);
+        }
+
         // easy path: check for common makefile messages
         if(line.Lower().Contains("entering directory") || line.Lower().Contains("leaving directory")) {
             line = WrapLineInColour(line, AnsiColours::Gray());
-            m_view->AppendItem(line);
+            AppendViewLine(m_log.AppendLine(stripped_line, line_project, BuildLogStore::kNormal, nullptr, line),
+                           stripped_line, line);
 
         } else if(line.Lower().Contains("building project")) {
-            ProcessBuildingProjectLine(line);
+            ProcessBuildingProjectLine(text);
+            line_project = GetCurrentProjectName();
+            AddProjectChoice(line_project);
             line = WrapLineInColour(line, AnsiColours::NormalText(), true);
-            m_view->AppendItem(line);
+            size_t n =
+                m_log.AppendLine(stripped_line, line_project, BuildLogStore::kProjectBoundary, nullptr, line);
+            AppendViewLine(n, stripped_line, line);
 
         } else if(false && m_activeCompiler && (m_activeCompiler->GetName() == "rustc") &&
                   line.Lower().Contains("compiling") && ProcessCargoBuildLine(line)) {
             // for now, I have disabled ("false") this check since in Cargo workspace, the path
             // reported by the compiler is relative to the root workspace and not to
             // the internal project
-            m_view->AppendItem(line);
+            AppendViewLine(m_log.AppendLine(stripped_line, line_project, BuildLogStore::kNormal, nullptr, line),
+                           stripped_line, line);
 
          } else if(cnt > PROCESSBUFFER_FMT_LINES_MAX) {
             // Do not heavy process big lines count, no one will read results.
-            m_view->AppendItem(line);
+            AppendViewLine(m_log.AppendLine(stripped_line, line_project, BuildLogStore::kNormal, nullptr, line),
+                           stripped_line, line);
 
         } else {
             std::unique_ptr<LineClientData> m(new LineClientData);
             m->message = line;
             m->root_dir = m_currentRootDir; // maybe empty string
 
-            // remove the terminal ascii colouring escape code
-            wxString modified_line;
-            StringUtils::StripTerminalColouring(line, modified_line);
-            bool lineHasColours = (line.length() != modified_line.length());
-            if(!m_activeCompiler || !m_activeCompiler->Matches(modified_line, &m->match_pattern)) {
+            bool lineHasColours = (line.length() != stripped_line.length());
+            BuildLogStore::eLineKind kind = BuildLogStore::kNormal;
+            if(!compiler || !compiler->Matches(text, &m->match_pattern)) {
                 m.reset();
             } else {
                 switch(m->match_pattern.sev) {
                 case Compiler::kSevError:
                     m_error_count++;
+                    kind = BuildLogStore::kError;
                     break;
                 case Compiler::kSevWarning:
                     m_warn_count++;
+                    kind = BuildLogStore::kWarning;
                     break;
                 default:
                     break;
@@ -238,12 +303,18 @@ void BuildTab::ProcessBuffer(bool last_line)
             // Associate the match info with the line in the view
             // this will be used later when selecting lines
             // Note: its OK to pass null here
+            BuildLogStore::Diagnostic diagnostic;
             if(m) {
                 // set the line project name
-                m->toolchain = m_activeCompiler->GetName();
-                m->project_name = GetCurrentProjectName();
+                m->toolchain = compiler->GetName();
+                m->project_name = line_project;
+
+                diagnostic.match_pattern = m->match_pattern;
+                diagnostic.root_dir = m->root_dir;
+                diagnostic.toolchain = m->toolchain;
             }
-            m_view->AppendItem(line, wxNOT_FOUND, wxNOT_FOUND, (wxUIntPtr)m.release());
+            size_t n = m_log.AppendLine(stripped_line, line_project, kind, m ? &diagnostic : nullptr, line);
+            AppendViewLine(n, stripped_line, line, (wxUIntPtr)m.release());
         }
     }
 
@@ -262,12 +333,34 @@ void BuildTab::Cleanup()
     m_buffer.clear();
     ClearView();
     m_activeCompiler = nullptr;
+    m_jobCompilers.clear();
     m_error_count = 0;
     m_warn_count = 0;
     m_buildInterrupted = false;
     m_currentProjectName.clear();
 }
 
+CompilerPtr BuildTab::GetJobCompiler(const wxString& project, const wxString& config)
+{
+    wxString key;
+    key << project << "|" << config;
+    auto iter = m_jobCompilers.find(key);
+    if(iter != m_jobCompilers.end()) {
+        return iter->second;
+    }
+
+    CompilerPtr compiler;
+    BuildConfigPtr bldConf = clCxxWorkspaceST::Get()->GetProjBuildConf(project, config);
+    if(bldConf) {
+        compiler = bldConf->GetCompiler();
+    }
+    if(!compiler) {
+        compiler = m_activeCompiler;
+    }
+    m_jobCompilers.insert({ key, compiler });
+    return compiler;
+}
+
 void BuildTab::AppendLine(const wxString& text)
 {
     m_buffer << text;
@@ -275,6 +368,18 @@ void BuildTab::AppendLine(const wxString& text)
 }
 
 void BuildTab::ClearView()
+{
+    ClearViewLines();
+    m_log.Clear();
+    m_buffer.clear();
+
+    m_choiceProject->Clear();
+    m_choiceProject->Append(_("All projects"));
+    m_choiceProject->SetSelection(0);
+    m_filter.project.clear();
+}
+
+void BuildTab::ClearViewLines()
 {
     m_view->DeleteAllItems([](wxUIntPtr d) {
         if(d) {
@@ -282,7 +387,95 @@ void BuildTab::ClearView()
             wxDELETE(p);
         }
     });
-    m_buffer.clear();
+}
+
+void BuildTab::AppendViewLine(size_t n, const wxString& stripped_line, const wxString& line, wxUIntPtr data)
+{
+    if(!m_filter.IsEmpty() && !m_log.Matches(n, m_filter, m_filterRe.get(), &stripped_line)) {
+        LineClientData* p = reinterpret_cast<LineClientData*>(data);
+        wxDELETE(p);
+        return;
+    }
+    m_view->AppendItem(line, wxNOT_FOUND, wxNOT_FOUND, data);
+}
+
+void BuildTab::AddProjectChoice(const wxString& project)
+{
+    if(project.empty() || m_choiceProject->FindString(project, true) != wxNOT_FOUND) {
+        return;
+    }
+    m_choiceProject->Append(project);
+}
+
+void BuildTab::OnFilterChanged(wxCommandEvent& event)
+{
+    wxUnusedVar(event);
+    ApplyFilter();
+}
+
+void BuildTab::ApplyFilter()
+{
+    switch(m_choiceSeverity->GetSelection()) {
+    case 1:
+        m_filter.kinds = BuildLogStore::kError;
+        break;
+    case 2:
+        m_filter.kinds = BuildLogStore::kWarning;
+        break;
+    case 3:
+        m_filter.kinds = BuildLogStore::kError | BuildLogStore::kWarning;
+        break;
+    default:
+        m_filter.kinds = 0;
+        break;
+    }
+
+    int project_sel = m_choiceProject->GetSelection();
+    m_filter.project = project_sel > 0 ? m_choiceProject->GetString(project_sel) : wxString();
+    m_filter.pattern = m_searchCtrl->GetValue();
+
+    m_filterRe.reset();
+    if(!m_filter.pattern.empty()) {
+        m_filterRe.reset(new wxRegEx(m_filter.pattern, wxRE_DEFAULT | wxRE_ICASE));
+        if(!m_filterRe->IsValid()) {
+            // filter by the other conditions only
+            clGetManager()->SetStatusMessage(_("Invalid regular expression: ") + m_filter.pattern, 5);
+            m_filterRe.reset();
+            m_filter.pattern.clear();
+        }
+    }
+
+    // re-populate the view from the log. Without a filter, the whole log is shown
+    bool unfiltered = m_filter.IsEmpty();
+    std::vector<size_t> lines = m_log.FilterLines(m_filter, unfiltered ? wxString::npos : FILTERED_LINES_MAX + 1);
+    bool truncated = !unfiltered && lines.size() > FILTERED_LINES_MAX;
+    if(truncated) {
+        lines.pop_back();
+    }
+
+    m_view->Begin();
+    ClearViewLines();
+    for(size_t n : lines) {
+        LineClientData* cd = nullptr;
+        const BuildLogStore::Diagnostic* diagnostic = m_log.GetDiagnostic(n);
+        if(diagnostic) {
+            cd = new LineClientData;
+            cd->message = m_log.GetLine(n);
+            cd->root_dir = diagnostic->root_dir;
+            cd->match_pattern = diagnostic->match_pattern;
+            cd->toolchain = diagnostic->toolchain;
+            cd->project_name = m_log.GetLineProject(n);
+        }
+        // the line as it was displayed, with its colours
+        m_view->AppendItem(m_log.GetStyledLine(n), wxNOT_FOUND, wxNOT_FOUND, (wxUIntPtr)cd);
+    }
+
+    if(truncated) {
+        m_view->AppendItem(WrapLineInColour(
+            wxString() << _("... more than ") << FILTERED_LINES_MAX << _(" matching lines, refine the filter"),
+            AnsiColours::Gray()));
+    }
+    m_view->Commit();
 }
 
 wxString BuildTab::WrapLineInColour(const wxString& line, int colour, bool fold_font) const
@@ -396,16 +589,6 @@ void BuildTab::OnContextMenu(wxDataViewEvent& e)
 
 void BuildTab::SaveBuildLog()
 {
-    // get the content
-    wxString content;
-    content.reserve(16 * 1024); // 16K
-
-    for(size_t i = 0; i < m_view->GetItemCount(); ++i) {
-        wxString str;
-        StringUtils::StripTerminalColouring(m_view->GetItemText(m_view->RowToItem(i)), str);
-        content << str << "\n";
-    }
-
     wxString path = ::wxFileSelector();
     if(path.empty()) {
         return;
@@ -417,7 +600,11 @@ void BuildTab::SaveBuildLog()
             return;
         }
     }
-    FileUtils::WriteFileContent(path, content);
+
+    // the log is already kept on disk, without the terminal colouring
+    if(!m_log.SaveTo(path)) {
+        ::wxMessageBox(_("Failed to save the build log to:\n") + path, "CodeLite", wxICON_ERROR | wxOK | wxCENTRE);
+    }
 }
 
 void BuildTab::CopySelections()
@@ -438,16 +625,14 @@ void BuildTab::CopySelections()
 
 void BuildTab::CopyAll()
 {
-    if(m_view->IsEmpty()) {
+    if(m_log.GetLineCount() == 0) {
         return;
     }
 
     wxString content;
     content.reserve(16 * 1024); // reserve 16K
-    for(size_t i = 0; i < m_view->GetItemCount(); ++i) {
-        wxString str;
-        StringUtils::StripTerminalColouring(m_view->GetItemText(m_view->RowToItem(i)), str);
-        content << str << "\n";
+    for(size_t i = 0; i < m_log.GetLineCount(); ++i) {
+        content << m_log.GetLine(i) << "\n";
     }
     ::CopyToClipboard(content);
 }
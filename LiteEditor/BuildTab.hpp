@@ -1,6 +1,7 @@
 #ifndef BUILDTAB_HPP
 #define BUILDTAB_HPP
 
+#include "BuildLogStore.hpp"
 #include "buildtabsettingsdata.h"
 #include "clAnsiEscapeCodeColourBuilder.hpp"
 #include "clTerminalViewCtrl.hpp"
@@ -8,21 +9,35 @@
 #include "cl_editor.h"
 #include "compiler.h"
 
+#include <memory>
+#include <unordered_map>
+#include <wx/choice.h>
 #include <wx/panel.h>
+#include <wx/regex.h>
+#include <wx/srchctrl.h>
 #include <wx/stopwatch.h>
 
 class BuildTab : public wxPanel
 {
     clTerminalViewCtrl* m_view = nullptr;
+    wxChoice* m_choiceSeverity = nullptr;
+    wxChoice* m_choiceProject = nullptr;
+    wxSearchCtrl* m_searchCtrl = nullptr;
     BuildTabSettingsData m_buildTabSettings;
+    BuildLogStore m_log;
+    BuildLogStore::Filter m_filter;
+    std::unique_ptr<wxRegEx> m_filterRe;
     wxStopWatch m_sw;
 
     // cleanable properties (between builds)
     bool m_buildInProgress = false;
+    bool m_parallelBuild = false;
     wxString m_buffer;
     wxStopWatch m_buffer_sw;
     long m_buffer_time = 0;
     CompilerPtr m_activeCompiler;
+    /// in a parallel build, the compiler of each job, by line prefix
+    std::unordered_map<wxString, CompilerPtr> m_jobCompilers;
     size_t m_error_count = 0;
     size_t m_warn_count = 0;
     bool m_buildInterrupted = false;
@@ -45,12 +60,20 @@ protected:
     void ProcessBuildingProjectLine(const wxString& line);
     bool ProcessCargoBuildLine(const wxString& line);
     const wxString& GetCurrentProjectName() const { return m_currentProjectName; }
+    CompilerPtr GetJobCompiler(const wxString& project, const wxString& config);
     wxString WrapLineInColour(const wxString& line, int colour, bool fold_font = false) const;
     void SaveBuildLog();
     void CopySelections();
     void CopyAll();
     wxString CreateSummaryLine();
 
+    /// add log line `n` to the view, unless it is hidden by the current filter. Takes ownership of `data`
+    void AppendViewLine(size_t n, const wxString& stripped_line, const wxString& line, wxUIntPtr data = 0);
+    void ClearViewLines();
+    void AddProjectChoice(const wxString& project);
+    void OnFilterChanged(wxCommandEvent& event);
+    void ApplyFilter();
+
 public:
     BuildTab(wxWindow* parent);
     ~BuildTab();
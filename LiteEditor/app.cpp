@@ -171,8 +171,8 @@ void ChildTerminatedSingalHandler(int signo)
     while (true) {
         pid_t pid = ::waitpid(-1, &status, WNOHANG);
         if (pid > 0) {
-            // waitpid succeeded
-            IProcess::SetProcessExitCode(pid, WEXITSTATUS(status));
+            // waitpid succeeded. A process killed by a signal exits with 128 + the signal number, as in the shell
+            IProcess::SetProcessExitCode(pid, WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
 
         } else {
             break;
@@ -4114,9 +4114,17 @@ void clMainFrame::OnBatchBuild(wxCommandEvent& e)
 {
     BatchBuildDlg* batchBuild = new BatchBuildDlg(this);
     if (batchBuild->ShowModal() == wxID_OK) {
+        std::list<QueueCommand> commands = batchBuild->GetBuildInfoList();
+        if (commands.size() > 1 && clConfig::Get().Read(kConfigBuildSchedulerEnabled, true)) {
+            // build the independent projects concurrently
+            ManagerST::Get()->ProcessCommandsInParallel(commands);
+            batchBuild->Destroy();
+            return;
+        }
+
         // build the projects
         // add all build items to queue
-        for (const auto& queueCommand : batchBuild->GetBuildInfoList()) {
+        for (const auto& queueCommand : commands) {
             ManagerST::Get()->PushQueueCommand(queueCommand);
         }
     }
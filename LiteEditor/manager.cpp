@@ -828,10 +828,7 @@ void Manager::GetWorkspaceFiles(wxArrayString& files)
         if (V.empty()) {
             return;
         }
-        files.Alloc(V.size());
-        for (const auto& f : V) {
-            files.Add(f.GetFullPath());
-        }
+        clPathTable::Get().ToArrayString(V, files);
         return;
     } else {
         if (!IsWorkspaceOpen()) {
@@ -854,16 +851,13 @@ void Manager::GetWorkspaceFiles(std::vector<wxFileName>& files, bool absPath)
         if (V.empty()) {
             return;
         }
-        files.reserve(V.size());
-        if (absPath) {
-            files.insert(files.end(), V.begin(), V.end());
-        } else {
+        size_t first = files.size();
+        clPathTable::Get().ToFileNames(V, files);
+        if (!absPath) {
             const wxFileName& fnWorkspace = clFileSystemWorkspace::Get().GetFileName();
             wxString path = fnWorkspace.GetPath();
-            for (const auto& f : V) {
-                wxFileName fn(f);
-                fn.MakeRelativeTo(path);
-                files.push_back(fn);
+            for (size_t i = first; i < files.size(); ++i) {
+                files[i].MakeRelativeTo(path);
             }
         }
     } else {
@@ -2525,7 +2519,7 @@ bool Manager::IsBuildInProgress() const
 {
     clBuildEvent buildEvent(wxEVT_GET_IS_BUILD_IN_PROGRESS);
     EventNotifier::Get()->ProcessEvent(buildEvent);
-    return buildEvent.IsRunning() || (m_shellProcess && m_shellProcess->IsBusy());
+    return buildEvent.IsRunning() || (m_shellProcess && m_shellProcess->IsBusy()) || m_buildScheduler.IsRunning();
 }
 
 void Manager::StopBuild()
@@ -2541,11 +2535,22 @@ void Manager::StopBuild()
     if (m_shellProcess && m_shellProcess->IsBusy()) {
         m_shellProcess->Stop();
     }
+    if (m_buildScheduler.IsRunning()) {
+        m_buildScheduler.Stop();
+    }
     m_buildQueue.clear();
 }
 
 void Manager::PushQueueCommand(const QueueCommand& buildInfo) { m_buildQueue.push_back(buildInfo); }
 
+void Manager::ProcessCommandsInParallel(const std::list<QueueCommand>& commands)
+{
+    if (IsBuildInProgress()) {
+        return;
+    }
+    m_buildScheduler.Start(commands);
+}
+
 void Manager::ProcessCommandQueue()
 {
     if (m_buildQueue.empty()) {
@@ -25,6 +25,7 @@
 #ifndef MANAGER_H
 #define MANAGER_H
 
+#include "BuildScheduler.hpp"
 #include "async_executable_cmd.h"
 #include "breakpointsmgr.h"
 #include "clDebuggerTerminal.h"
@@ -98,6 +99,7 @@ protected:
     long m_tipWinPos;
     int m_frameLineno;
     std::list<QueueCommand> m_buildQueue;
+    BuildScheduler m_buildScheduler;
     wxArrayString m_dbgWatchExpressions;
     DisplayVariableDlg* m_watchDlg;
     bool m_retagInProgress;
@@ -614,6 +616,12 @@ public:
      */
     void ProcessCommandQueue();
 
+    /**
+     * @brief run the build jobs concurrently, as allowed by their dependencies. The batch is reported to the
+     * build tab as a single build
+     */
+    void ProcessCommandsInParallel(const std::list<QueueCommand>& commands);
+
     /**
      * @brief build the entire workspace. This operation is equal to
      * manually right clicking on each project in the workspace and selecting
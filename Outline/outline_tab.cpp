@@ -9,6 +9,7 @@
 #include "imanager.h"
 #include "macros.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <wx/colour.h>
 #include <wx/stc/stc.h>
@@ -20,6 +21,9 @@ const wxString CLASS_SYMBOL = wxT("\u2394");
 const wxString VARIABLE_SYMBOL = wxT("\u2027");
 const wxString MODULE_SYMBOL = wxT("{}");
 const wxString ENUMERATOR_SYMBOL = wxT("#");
+
+// the symbols are rendered once the editor was not modified for this long
+constexpr int UPDATE_IDLE_DELAY_MS = 500;
 } // namespace
 
 using namespace LSP;
@@ -30,6 +34,10 @@ OutlineTab::OutlineTab(wxWindow* parent)
     EventNotifier::Get()->Bind(wxEVT_LSP_DOCUMENT_SYMBOLS_QUICK_OUTLINE, &OutlineTab::OnOutlineSymbols, this);
     EventNotifier::Get()->Bind(wxEVT_ACTIVE_EDITOR_CHANGED, &OutlineTab::OnActiveEditorChanged, this);
     EventNotifier::Get()->Bind(wxEVT_ALL_EDITORS_CLOSED, &OutlineTab::OnAllEditorsClosed, this);
+    EventNotifier::Get()->Bind(wxEVT_EDITOR_MODIFIED, &OutlineTab::OnEditorModified, this);
+
+    m_updateTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &OutlineTab::OnUpdateTimer, this, m_updateTimer->GetId());
 }
 
 OutlineTab::~OutlineTab()
@@ -37,6 +45,11 @@ OutlineTab::~OutlineTab()
     EventNotifier::Get()->Unbind(wxEVT_LSP_DOCUMENT_SYMBOLS_QUICK_OUTLINE, &OutlineTab::OnOutlineSymbols, this);
     EventNotifier::Get()->Unbind(wxEVT_ACTIVE_EDITOR_CHANGED, &OutlineTab::OnActiveEditorChanged, this);
     EventNotifier::Get()->Unbind(wxEVT_ALL_EDITORS_CLOSED, &OutlineTab::OnAllEditorsClosed, this);
+    EventNotifier::Get()->Unbind(wxEVT_EDITOR_MODIFIED, &OutlineTab::OnEditorModified, this);
+
+    m_updateTimer->Stop();
+    Unbind(wxEVT_TIMER, &OutlineTab::OnUpdateTimer, this, m_updateTimer->GetId());
+    wxDELETE(m_updateTimer);
 }
 
 void OutlineTab::OnOutlineSymbols(LSPEvent& event)
@@ -45,15 +58,56 @@ void OutlineTab::OnOutlineSymbols(LSPEvent& event)
     if(!IsShown()) {
         return;
     }
+
+    if(IsTyping()) {
+        // keep only the latest symbols, they are rendered once the user stops typing
+        m_pendingSymbols = event.GetSymbolsInformation();
+        m_pendingFileName = event.GetFileName();
+        m_hasPendingSymbols = true;
+        m_updateTimer->StartOnce(UPDATE_IDLE_DELAY_MS);
+        return;
+    }
     RenderSymbols(event.GetSymbolsInformation(), event.GetFileName());
 }
 
-void OutlineTab::RenderSymbols(const std::vector<LSP::SymbolInformation>& symbols, const wxString& filename)
+void OutlineTab::OnEditorModified(clCommandEvent& event)
 {
-    ClearView();
+    event.Skip();
+    m_lastModified = std::chrono::steady_clock::now();
+}
 
+bool OutlineTab::IsTyping() const
+{
+    auto elapsed = std::chrono::steady_clock::now() - m_lastModified;
+    return elapsed < std::chrono::milliseconds(UPDATE_IDLE_DELAY_MS);
+}
+
+void OutlineTab::OnUpdateTimer(wxTimerEvent& event)
+{
+    wxUnusedVar(event);
+    if(!m_hasPendingSymbols) {
+        return;
+    }
+    if(IsTyping()) {
+        m_updateTimer->StartOnce(UPDATE_IDLE_DELAY_MS);
+        return;
+    }
+
+    std::vector<LSP::SymbolInformation> symbols;
+    symbols.swap(m_pendingSymbols);
+    m_hasPendingSymbols = false;
+    if(IsShown()) {
+        RenderSymbols(symbols, m_pendingFileName);
+    }
+}
+
+void OutlineTab::RenderSymbols(const std::vector<LSP::SymbolInformation>& symbols, const wxString& filename)
+{
     auto editor = clGetManager()->GetActiveEditor();
-    CHECK_PTR_RET(editor);
+    if(!editor) {
+        ClearView();
+        return;
+    }
 
     wxString remote_path;
     if(editor->IsRemoteFile()) {
@@ -66,26 +120,28 @@ void OutlineTab::RenderSymbols(const std::vector<LSP::SymbolInformation>& symbol
         return;
     }
 
+    // the symbols of the file already displayed are merged into the view, so it does not flicker nor lose its
+    // selection and scroll position
+    bool incremental = (filename == m_currentSymbolsFileName) && !m_rows.empty() && !symbols.empty();
+    if(!incremental) {
+        ClearView();
+    }
+
     m_currentSymbolsFileName = filename;
     m_symbols = symbols;
 
-    auto lexer = ColoursAndFontsManager::Get().GetLexer("python");
-    if(symbols.empty()) {
-        clAnsiEscapeCodeColourBuilder builder;
-        builder.SetTheme(lexer->IsDark() ? eColourTheme::DARK : eColourTheme::LIGHT);
-        builder.Add(_("Language Server is still not ready... "), AnsiColours::NormalText(), false);
-        builder.Add(_("(hit ESCAPE key to dismiss)"), AnsiColours::Gray(), false);
-        m_dvListCtrl->AddLine(builder.GetString(), false, (wxUIntPtr)0);
-        return;
+    std::vector<Row> rows;
+    BuildRows(rows);
+    if(incremental) {
+        UpdateView(rows);
+    } else {
+        RebuildView(rows);
     }
+}
 
-    m_dvListCtrl->Begin();
-    m_dvListCtrl->SetScrollToBottom(false);
-
-    // reduce the outline font size
-    wxFont font = lexer->GetFontForStyle(0, m_dvListCtrl);
-    font.SetFractionalPointSize(static_cast<double>(font.GetPointSize()) * 0.8);
-    m_dvListCtrl->SetDefaultFont(font);
+void OutlineTab::BuildRows(std::vector<Row>& rows) const
+{
+    auto lexer = ColoursAndFontsManager::Get().GetLexer("python");
 
     // build the tree
     wxColour class_colour = lexer->GetProperty(wxSTC_P_WORD2).GetFgColour();
@@ -97,9 +153,11 @@ void OutlineTab::RenderSymbols(const std::vector<LSP::SymbolInformation>& symbol
     constexpr int INITIAL_DEPTH = 0;
     constexpr int DEPTH_WIDTH = 2;
 
+    rows.reserve(m_symbols.size());
     std::unordered_set<wxString> containers;
     clAnsiEscapeCodeColourBuilder builder;
-    for(const SymbolInformation& si : m_symbols) {
+    for(size_t i = 0; i < m_symbols.size(); ++i) {
+        const SymbolInformation& si = m_symbols[i];
         builder.Clear();
 
         if(!si.GetContainerName().empty() && containers.count(si.GetContainerName()) == 0) {
@@ -107,7 +165,12 @@ void OutlineTab::RenderSymbols(const std::vector<LSP::SymbolInformation>& symbol
             containers.insert(si.GetContainerName());
             builder.Add(CLASS_SYMBOL + " ", AnsiColours::NormalText());
             builder.Add(si.GetContainerName(), class_colour, true);
-            m_dvListCtrl->AddLine(builder.GetString(), false, (wxUIntPtr)&si);
+
+            Row row;
+            row.key << "|" << si.GetContainerName();
+            row.text = builder.GetString();
+            row.symbol = i;
+            rows.push_back(row);
             builder.Clear();
         }
 
@@ -158,12 +221,112 @@ void OutlineTab::RenderSymbols(const std::vector<LSP::SymbolInformation>& symbol
             builder.Add(si.GetName(), variable_colour);
             break;
         }
-        m_dvListCtrl->AddLine(builder.GetString(), false, (wxUIntPtr)&si);
+
+        Row row;
+        row.key << (int)si.GetKind() << "|" << si.GetContainerName() << "|" << si.GetName();
+        row.text = builder.GetString();
+        row.symbol = i;
+        rows.push_back(row);
+    }
+}
+
+void OutlineTab::RebuildView(std::vector<Row>& rows)
+{
+    auto lexer = ColoursAndFontsManager::Get().GetLexer("python");
+    if(m_symbols.empty()) {
+        clAnsiEscapeCodeColourBuilder builder;
+        builder.SetTheme(lexer->IsDark() ? eColourTheme::DARK : eColourTheme::LIGHT);
+        builder.Add(_("Language Server is still not ready... "), AnsiColours::NormalText(), false);
+        builder.Add(_("(hit ESCAPE key to dismiss)"), AnsiColours::Gray(), false);
+        m_dvListCtrl->AddLine(builder.GetString(), false, (wxUIntPtr)0);
+        return;
+    }
+
+    m_dvListCtrl->Begin();
+    m_dvListCtrl->SetScrollToBottom(false);
+
+    // reduce the outline font size
+    wxFont font = lexer->GetFontForStyle(0, m_dvListCtrl);
+    font.SetFractionalPointSize(static_cast<double>(font.GetPointSize()) * 0.8);
+    m_dvListCtrl->SetDefaultFont(font);
+
+    for(const Row& row : rows) {
+        m_dvListCtrl->AddLine(row.text, false, (wxUIntPtr)&m_symbols[row.symbol]);
     }
     if(!m_dvListCtrl->IsEmpty()) {
         m_dvListCtrl->SelectRow(0);
     }
     m_dvListCtrl->Commit();
+    m_rows.swap(rows);
+}
+
+void OutlineTab::UpdateView(std::vector<Row>& rows)
+{
+    // the lines before and after the edited part of the file are unchanged
+    size_t prefix = 0;
+    while(prefix < m_rows.size() && prefix < rows.size() && m_rows[prefix].key == rows[prefix].key) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while(suffix < (m_rows.size() - prefix) && suffix < (rows.size() - prefix) &&
+          m_rows[m_rows.size() - 1 - suffix].key == rows[rows.size() - 1 - suffix].key) {
+        ++suffix;
+    }
+
+    // in between, the longest common subsequence of the keys is kept and the other lines are removed or inserted
+    size_t oldCount = m_rows.size() - suffix - prefix;
+    size_t newCount = rows.size() - suffix - prefix;
+    constexpr size_t MAX_LCS_CELLS = 4 * 1024 * 1024;
+    if((oldCount + 1) * (newCount + 1) > MAX_LCS_CELLS) {
+        // too many changes to diff them, e.g. another version of the file was loaded
+        m_dvListCtrl->DeleteAllItems();
+        RebuildView(rows);
+        return;
+    }
+
+    // lcs[i * (newCount + 1) + j]: the length of the LCS of the old lines from i and the new lines from j
+    std::vector<unsigned int> lcs((oldCount + 1) * (newCount + 1), 0);
+    auto LCS = [&](size_t i, size_t j) -> unsigned int& { return lcs[i * (newCount + 1) + j]; };
+    for(size_t i = oldCount; i > 0; --i) {
+        for(size_t j = newCount; j > 0; --j) {
+            if(m_rows[prefix + i - 1].key == rows[prefix + j - 1].key) {
+                LCS(i - 1, j - 1) = LCS(i, j) + 1;
+            } else {
+                LCS(i - 1, j - 1) = std::max(LCS(i, j - 1), LCS(i - 1, j));
+            }
+        }
+    }
+
+    m_dvListCtrl->Begin();
+    size_t i = 0;
+    size_t j = 0;
+    size_t row = prefix;
+    while(i < oldCount || j < newCount) {
+        if(i < oldCount && j < newCount && m_rows[prefix + i].key == rows[prefix + j].key) {
+            if(m_rows[prefix + i].text != rows[prefix + j].text) {
+                m_dvListCtrl->SetItemText(m_dvListCtrl->RowToItem(row), rows[prefix + j].text);
+            }
+            ++i;
+            ++j;
+            ++row;
+        } else if(j < newCount && (i == oldCount || LCS(i, j + 1) >= LCS(i + 1, j))) {
+            wxDataViewItem previous = (row == 0) ? wxDataViewItem(m_dvListCtrl->GetRootItem().GetID())
+                                                 : m_dvListCtrl->RowToItem(row - 1);
+            m_dvListCtrl->InsertItem(previous, rows[prefix + j].text);
+            ++j;
+            ++row;
+        } else {
+            m_dvListCtrl->DeleteItem(row);
+            ++i;
+        }
+    }
+
+    // the symbols were replaced: point every line to its new symbol
+    for(size_t n = 0; n < rows.size(); ++n) {
+        m_dvListCtrl->SetItemData(m_dvListCtrl->RowToItem(n), (wxUIntPtr)&m_symbols[rows[n].symbol]);
+    }
+    m_dvListCtrl->Commit();
+    m_rows.swap(rows);
 }
 
 void OutlineTab::OnAllEditorsClosed(wxCommandEvent& event)
@@ -184,6 +347,11 @@ void OutlineTab::ClearView()
     m_currentSymbolsFileName.clear();
     m_dvListCtrl->DeleteAllItems();
     m_symbols.clear();
+    m_rows.clear();
+
+    m_updateTimer->Stop();
+    m_pendingSymbols.clear();
+    m_hasPendingSymbols = false;
 }
 
 void OutlineTab::OnItemSelected(wxDataViewEvent& event)
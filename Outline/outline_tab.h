@@ -3,20 +3,46 @@
 
 #include "LSP/LSPEvent.h"
 #include "LSP/basic_types.h"
+#include "cl_command_event.h"
 #include "wxcrafter.h"
 
+#include <chrono>
 #include <vector>
+#include <wx/timer.h>
 
 class OutlineTab : public OutlineTabBaseClass
 {
+    /// a line of the view
+    struct Row {
+        /// identifies the symbol: its kind, container and name
+        wxString key;
+        wxString text;
+        /// the symbol selected by this line (the first member of a container line)
+        size_t symbol = 0;
+    };
+
     wxString m_currentSymbolsFileName;
     std::vector<LSP::SymbolInformation> m_symbols;
+    std::vector<Row> m_rows;
+
+    // the symbols received while the user is typing are applied once the editor is idle
+    wxTimer* m_updateTimer = nullptr;
+    std::chrono::steady_clock::time_point m_lastModified;
+    std::vector<LSP::SymbolInformation> m_pendingSymbols;
+    wxString m_pendingFileName;
+    bool m_hasPendingSymbols = false;
 
 private:
     void OnOutlineSymbols(LSPEvent& event);
     void OnActiveEditorChanged(wxCommandEvent& event);
     void OnAllEditorsClosed(wxCommandEvent& event);
+    void OnEditorModified(clCommandEvent& event);
+    void OnUpdateTimer(wxTimerEvent& event);
+    bool IsTyping() const;
     void RenderSymbols(const std::vector<LSP::SymbolInformation>& symbols, const wxString& filename);
+    void BuildRows(std::vector<Row>& rows) const;
+    void RebuildView(std::vector<Row>& rows);
+    void UpdateView(std::vector<Row>& rows);
     void ClearView();
 
 public:
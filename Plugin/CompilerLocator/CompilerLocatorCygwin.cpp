@@ -25,6 +25,7 @@
 
 #include "CompilerLocatorCygwin.h"
 
+#include "CompilersDetectorCache.hpp"
 #include "file_logger.h"
 #include "globals.h"
 #include "procutils.h"
@@ -140,7 +141,8 @@ wxString CompilerLocatorCygwin::GetGCCVersion(const wxString& gccBinary)
     static wxRegEx reVersion("([0-9]+\\.[0-9]+\\.[0-9]+)");
     wxString command;
     command << gccBinary << " --version";
-    wxString versionString = ProcUtils::SafeExecuteCommand(command);
+    wxString versionString = CompilersDetectorCache::Get().Query(
+        gccBinary, "--version", [&command]() { return ProcUtils::SafeExecuteCommand(command); });
     if(!versionString.IsEmpty() && reVersion.Matches(versionString)) {
         return reVersion.GetMatch(versionString);
     }
@@ -25,11 +25,13 @@
 
 #include "CompilerLocatorMSVC.h"
 
+#include "CompilersDetectorCache.hpp"
 #include "StdToWX.h"
 #include "compiler.h"
 #include "globals.h"
 
 #include <wx/regex.h>
+#include <wx/tokenzr.h>
 
 CompilerLocatorMSVC::CompilerLocatorMSVC()
     : // We only deal with x86/x64 Native Tools here for simplicity
@@ -152,9 +154,18 @@ void CompilerLocatorMSVC::AddTools(const wxString& name, const wxString& platfor
     wxString command = "CMD.EXE /V:ON /C ";
     command << vcVarsCmd << " " << vcVarsArgs << " & echo !INCLUDE! & echo !LIB! & where cl.exe";
 
+    // running vcvarsall.bat takes seconds: reuse its output while it is not upgraded
     wxArrayString output;
     wxArrayString errors;
-    wxExecute(command, output, errors);
+    wxString cached;
+    if(CompilersDetectorCache::Get().Lookup(fnVCvars.GetFullPath(), command, cached)) {
+        output = ::wxStringTokenize(cached, "\n", wxTOKEN_RET_EMPTY_ALL);
+    } else {
+        wxExecute(command, output, errors);
+        if(errors.IsEmpty()) {
+            CompilersDetectorCache::Get().Store(fnVCvars.GetFullPath(), command, wxJoin(output, '\n', 0));
+        }
+    }
 
     if(output.size() >= 2) {
         wxString includePath = output[0];
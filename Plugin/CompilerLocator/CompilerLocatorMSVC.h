@@ -44,6 +44,7 @@ public:
     virtual ~CompilerLocatorMSVC();
     virtual bool Locate();
     virtual CompilerPtr Locate(const wxString& folder) { return NULL; }
+    virtual bool IsThreadSafe() const { return false; }
 
 protected:
     virtual void CheckUninstRegKey(const wxString& displayName, const wxString& installFolder,
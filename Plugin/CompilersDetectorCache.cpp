@@ -0,0 +1,166 @@
+#include "CompilersDetectorCache.hpp"
+
+#include "JSON.h"
+#include "cl_standard_paths.h"
+#include "file_logger.h"
+
+#include <wx/datetime.h>
+
+CompilersDetectorCache::CompilersDetectorCache()
+{
+    m_file = wxFileName(clStandardPaths::Get().GetUserDataDir(), "CompilersDetectorCache.json");
+    m_file.AppendDir("config");
+    Load();
+}
+
+CompilersDetectorCache& CompilersDetectorCache::Get()
+{
+    static CompilersDetectorCache cache;
+    return cache;
+}
+
+bool CompilersDetectorCache::GetStamp(const wxString& binary, time_t& modified, size_t& size)
+{
+    wxFileName fn(binary);
+    if (!fn.FileExists()) {
+        return false;
+    }
+    modified = fn.GetModificationTime().GetTicks();
+    size = fn.GetSize().GetValue();
+    return true;
+}
+
+void CompilersDetectorCache::Load()
+{
+    if (!m_file.FileExists()) {
+        return;
+    }
+
+    JSON root(m_file);
+    if (!root.isOk()) {
+        return;
+    }
+
+    JSONItem binaries = root.toElement().namedObject("binaries");
+    int count = binaries.arraySize();
+    for (int i = 0; i < count; ++i) {
+        JSONItem item = binaries.arrayItem(i);
+        wxString path = item.namedObject("path").toString();
+        if (path.empty()) {
+            continue;
+        }
+
+        Binary binary;
+        binary.modified = item.namedObject("modified").toSize_t();
+        binary.size = item.namedObject("size").toSize_t();
+        JSONItem results = item.namedObject("results");
+        int resultsCount = results.arraySize();
+        for (int j = 0; j < resultsCount; ++j) {
+            JSONItem result = results.arrayItem(j);
+            binary.results.insert({ result.namedObject("query").toString(), result.namedObject("output").toString() });
+        }
+        m_binaries.insert({ path, binary });
+    }
+    clDEBUG() << "Loaded the compilers cache:" << m_binaries.size() << "binaries" << endl;
+}
+
+bool CompilersDetectorCache::Lookup(const wxString& binary, const wxString& query, wxString& output)
+{
+    time_t modified = 0;
+    size_t size = 0;
+    if (!GetStamp(binary, modified, size)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_binaries.find(binary);
+    if (iter == m_binaries.end()) {
+        return false;
+    }
+
+    if (iter->second.modified != modified || iter->second.size != size) {
+        // the toolchain was upgraded: all its results are stale
+        m_binaries.erase(iter);
+        m_modified = true;
+        return false;
+    }
+
+    auto result = iter->second.results.find(query);
+    if (result == iter->second.results.end()) {
+        return false;
+    }
+    output = result->second;
+    return true;
+}
+
+void CompilersDetectorCache::Store(const wxString& binary, const wxString& query, const wxString& output)
+{
+    time_t modified = 0;
+    size_t size = 0;
+    if (!GetStamp(binary, modified, size)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Binary& entry = m_binaries[binary];
+    if (entry.modified != modified || entry.size != size) {
+        entry.results.clear();
+        entry.modified = modified;
+        entry.size = size;
+    }
+    entry.results[query] = output;
+    m_modified = true;
+}
+
+wxString CompilersDetectorCache::Query(const wxString& binary, const wxString& query,
+                                       const std::function<wxString()>& run)
+{
+    wxString output;
+    if (Lookup(binary, query, output)) {
+        return output;
+    }
+    output = run();
+    Store(binary, query, output);
+    return output;
+}
+
+void CompilersDetectorCache::Save()
+{
+    JSON root(cJSON_Object);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_modified) {
+            return;
+        }
+
+        JSONItem binaries = JSONItem::createArray("binaries");
+        for (const auto& vt : m_binaries) {
+            JSONItem item = JSONItem::createObject();
+            item.addProperty("path", vt.first);
+            item.addProperty("modified", (long)vt.second.modified);
+            item.addProperty("size", vt.second.size);
+
+            JSONItem results = JSONItem::createArray("results");
+            for (const auto& result : vt.second.results) {
+                JSONItem resultItem = JSONItem::createObject();
+                resultItem.addProperty("query", result.first);
+                resultItem.addProperty("output", result.second);
+                results.arrayAppend(resultItem);
+            }
+            item.append(results);
+            binaries.arrayAppend(item);
+        }
+        root.toElement().append(binaries);
+        m_modified = false;
+    }
+
+    m_file.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+    root.save(m_file);
+}
+
+void CompilersDetectorCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_binaries.clear();
+    m_modified = true;
+}
@@ -0,0 +1,70 @@
+#ifndef COMPILERSDETECTORCACHE_HPP
+#define COMPILERSDETECTORCACHE_HPP
+
+#include "codelite_exports.h"
+#include "wxStringHash.h"
+
+#include <functional>
+#include <mutex>
+#include <time.h>
+#include <unordered_map>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/// The results of the commands the compiler locators run to query a toolchain: its version, the environment set by
+/// its setup script, its search paths...
+///
+/// The results are stored per binary, and stay valid as long as the binary keeps its modification time and size: a
+/// toolchain that was not upgraded is not queried again. The cache is saved in the user's configuration folder and
+/// reloaded on the next start. All the methods are thread safe
+class WXDLLIMPEXP_SDK CompilersDetectorCache
+{
+    struct Binary {
+        time_t modified = 0;
+        size_t size = 0;
+        /// query => output
+        std::unordered_map<wxString, wxString> results;
+    };
+
+    wxFileName m_file;
+    std::mutex m_mutex;
+    std::unordered_map<wxString, Binary> m_binaries;
+    bool m_modified = false;
+
+protected:
+    static bool GetStamp(const wxString& binary, time_t& modified, size_t& size);
+    void Load();
+
+public:
+    CompilersDetectorCache();
+    ~CompilersDetectorCache() = default;
+
+    static CompilersDetectorCache& Get();
+
+    /**
+     * @brief return the output of `query` stored for `binary`, if the binary did not change since it was stored
+     */
+    bool Lookup(const wxString& binary, const wxString& query, wxString& output);
+
+    /**
+     * @brief store the output of `query` for the current version of `binary`
+     */
+    void Store(const wxString& binary, const wxString& query, const wxString& output);
+
+    /**
+     * @brief return the cached output of `query`, or call `run` and store its output
+     */
+    wxString Query(const wxString& binary, const wxString& query, const std::function<wxString()>& run);
+
+    /**
+     * @brief write the cache to the disk, if it was modified
+     */
+    void Save();
+
+    /**
+     * @brief forget all the results, e.g. to force a full scan
+     */
+    void Clear();
+};
+
+#endif // COMPILERSDETECTORCACHE_HPP
@@ -34,6 +34,7 @@
 #include "CompilerLocator/CompilerLocatorMSYS2.hpp"
 #include "CompilerLocator/CompilerLocatorMSYS2Clang.hpp"
 #include "CompilerLocator/CompilerLocatorRustc.hpp"
+#include "CompilersDetectorCache.hpp"
 #include "GCCMetadata.hpp"
 #include "JSON.h"
 #include "build_settings_config.h"
@@ -43,6 +44,8 @@
 #include "fileutils.h"
 #include "macros.h"
 
+#include <thread>
+#include <vector>
 #include <wx/arrstr.h>
 #include <wx/busyinfo.h>
 #include <wx/choicdlg.h>
@@ -91,9 +94,33 @@ bool CompilersDetectorManager::Locate()
     wxStringSet_t S;
 
     clDEBUG() << "scanning for compilers..." << endl;
-    for(auto locator : m_detectors) {
-        if(locator->Locate()) {
-            for(auto compiler : locator->GetCompilers()) {
+
+    // The locators do not depend on each other: run them all at once, each on its own thread. The locators that must
+    // stay on the main thread run here meanwhile
+    std::vector<char> found(m_detectors.size(), 0);
+    std::vector<std::thread*> threads;
+    for(size_t i = 0; i < m_detectors.size(); ++i) {
+        ICompilerLocator::Ptr_t locator = m_detectors[i];
+        if(locator->IsThreadSafe()) {
+            threads.push_back(new std::thread([locator, i, &found]() { found[i] = locator->Locate(); }));
+        }
+    }
+
+    for(size_t i = 0; i < m_detectors.size(); ++i) {
+        if(!m_detectors[i]->IsThreadSafe()) {
+            found[i] = m_detectors[i]->Locate();
+        }
+    }
+
+    for(std::thread* thr : threads) {
+        thr->join();
+        wxDELETE(thr);
+    }
+
+    // Merge the results in the order of the locators, so duplicates are resolved as if they ran one after the other
+    for(size_t i = 0; i < m_detectors.size(); ++i) {
+        if(found[i]) {
+            for(auto compiler : m_detectors[i]->GetCompilers()) {
                 /* Resolve symlinks and detect compiler duplication, e.g.:
                  *   /usr/bin/g++ (GCC)
                  *     -> /usr/bin/g++-9 (GCC-9)
@@ -115,6 +142,7 @@ bool CompilersDetectorManager::Locate()
     for(auto compiler : m_compilersFound) {
         MSWFixClangToolChain(compiler, m_compilersFound);
     }
+    CompilersDetectorCache::Get().Save();
 
     clDEBUG() << "scanning for compilers...completed" << endl;
     return !m_compilersFound.empty();
@@ -54,6 +54,17 @@
 
 wxDEFINE_EVENT(wxEVT_FS_SCAN_COMPLETED, clFileSystemEvent);
 wxDEFINE_EVENT(wxEVT_FS_NEW_WORKSPACE_FILE_CREATED, clFileSystemEvent);
+
+namespace
+{
+/// the files found by CacheFiles(), interned by the scanning thread
+struct ScanResult : public wxClientData {
+    std::vector<clPath> files;
+    /// the generation of the scan, see clFileSystemWorkspace::m_scanGeneration
+    size_t generation = 0;
+};
+} // namespace
+
 clFileSystemWorkspace::clFileSystemWorkspace(bool dummy)
     : m_dummy(dummy)
 {
@@ -94,6 +105,9 @@ clFileSystemWorkspace::clFileSystemWorkspace(bool dummy)
         EventNotifier::Get()->Bind(wxEVT_DBG_UI_START, &clFileSystemWorkspace::OnDebug, this);
 
         EventNotifier::Get()->Bind(wxEVT_FILE_CREATED, &clFileSystemWorkspace::OnFileSystemUpdated, this);
+
+        m_watcher.SetOwner(this);
+        Bind(wxEVT_FILES_CHANGED, &clFileSystemWorkspace::OnFilesChanged, this);
     }
 }
 
@@ -138,6 +152,9 @@ clFileSystemWorkspace::~clFileSystemWorkspace()
         EventNotifier::Get()->Unbind(wxEVT_DBG_UI_START, &clFileSystemWorkspace::OnDebug, this);
 
         EventNotifier::Get()->Unbind(wxEVT_FILE_CREATED, &clFileSystemWorkspace::OnFileSystemUpdated, this);
+
+        m_watcher.Clear();
+        Unbind(wxEVT_FILES_CHANGED, &clFileSystemWorkspace::OnFilesChanged, this);
     }
 }
 
@@ -168,10 +185,7 @@ wxString clFileSystemWorkspace::GetProjectFromFile(const wxFileName& filename) c
 void clFileSystemWorkspace::GetWorkspaceFiles(wxArrayString& files) const
 {
     files.clear();
-    files.Alloc(m_files.GetSize());
-    for (const wxFileName& file : m_files) {
-        files.Add(file.GetFullPath());
-    }
+    clPathTable::Get().ToArrayString(m_files.GetFiles(), files);
 }
 
 wxArrayString clFileSystemWorkspace::GetWorkspaceProjects() const { return {}; }
@@ -190,45 +204,42 @@ void clFileSystemWorkspace::CacheFiles(bool force)
     if (!m_files.IsEmpty()) {
         m_files.Clear();
     }
+    ++m_scanGeneration;
     std::thread thr(
-        [=](const wxString& rootFolder) {
+        [](const wxString& rootFolder, const wxString& mask, const wxStringSet_t& excludeFolders, size_t generation) {
             clFilesScanner fs;
-            std::vector<wxString> files;
-            wxStringSet_t excludeFolders = { ".git/", ".svn/", ".codelite/", ".ctagsd/" };
-
-            wxString excludePaths = GetExcludeFolders();
-            wxArrayString paths = StringUtils::BuildArgv(excludePaths);
-            if (!paths.IsEmpty()) {
-                for (wxString& excludePath : paths) {
-                    excludePath.Trim().Trim(false);
-                    if (excludePath.EndsWith("/") || excludePath.EndsWith("\\")) {
-                        excludePath.RemoveLast();
-                    }
-                    if (excludePath.IsEmpty()) {
-                        continue;
-                    }
-
-                    wxFileName fnpath(excludePath, "");
-                    excludeFolders.insert(fnpath.GetPath());
-                }
-            }
-
-            fs.Scan(rootFolder, files, GetFilesMask(), "", excludeFolders);
+            ScanResult* result = new ScanResult();
+            result->generation = generation;
+            fs.Scan(rootFolder, result->files, mask, "", excludeFolders);
             clFileSystemEvent event(wxEVT_FS_SCAN_COMPLETED);
-            wxArrayString arrfiles;
-            arrfiles.Alloc(files.size());
-            for (const wxString& s : files) {
-                wxFileName f(s);
-                arrfiles.Add(f.GetFullPath());
-            }
-
-            event.SetPaths(arrfiles);
+            event.SetClientObject(result);
             EventNotifier::Get()->QueueEvent(event.Clone());
         },
-        GetDir());
+        GetDir(), GetFilesMask(), GetExcludeFoldersSet(), m_scanGeneration);
     thr.detach();
 }
 
+wxStringSet_t clFileSystemWorkspace::GetExcludeFoldersSet() const
+{
+    wxStringSet_t excludeFolders = { ".git/", ".svn/", ".codelite/", ".ctagsd/" };
+
+    wxString excludePaths = GetExcludeFolders();
+    wxArrayString paths = StringUtils::BuildArgv(excludePaths);
+    for (wxString& excludePath : paths) {
+        excludePath.Trim().Trim(false);
+        if (excludePath.EndsWith("/") || excludePath.EndsWith("\\")) {
+            excludePath.RemoveLast();
+        }
+        if (excludePath.IsEmpty()) {
+            continue;
+        }
+
+        wxFileName fnpath(excludePath, "");
+        excludeFolders.insert(fnpath.GetPath());
+    }
+    return excludeFolders;
+}
+
 void clFileSystemWorkspace::OnBuildStarting(clBuildEvent& event)
 {
     event.Skip();
@@ -292,6 +303,10 @@ void clFileSystemWorkspace::Save(bool parse)
     // trigger a file scan
     if (parse) {
         CacheFiles();
+        // watch the folders with the new exclude list
+        if (m_watcher.IsRunning()) {
+            m_watcher.AddDirectory(GetDir(), true, GetExcludeFoldersSet());
+        }
     }
 }
 
@@ -325,8 +340,11 @@ void clFileSystemWorkspace::DoOpen()
         m_backtickCache.reset(nullptr);
     }
 
-    // load the new cache
+    // load the new cache, and refresh the backticks of the completion flags in the background
     m_backtickCache.reset(new clBacktickCache(GetDir()));
+    if (GetSettings().GetSelectedConfig()) {
+        GetSettings().GetSelectedConfig()->PrefetchUserCompletionFlags(GetDir(), m_backtickCache);
+    }
 
     // Init the view
     GetView()->Clear();
@@ -350,8 +368,13 @@ void clFileSystemWorkspace::DoOpen()
     // and finally, request codelite to keep this workspace in the recently opened workspace list
     clGetManager()->AddWorkspaceToRecentlyUsedList(m_filename);
 
-    // Cache the source files from the workspace directories
+    // Cache the source files from the workspace directories, and keep the cache up to date from the file system
+    // changes where the platform supports it
     CacheFiles();
+    m_watcher.Clear();
+    if (m_watcher.AddDirectory(GetDir(), true, GetExcludeFoldersSet())) {
+        m_watcher.Start();
+    }
 
     // mark the workspace as loaded before restoring the session
     m_isLoaded = true;
@@ -375,7 +398,10 @@ void clFileSystemWorkspace::DoClose()
     // Store the session
     clGetManager()->StoreWorkspaceSession(m_filename);
 
-    // avoid any file re-cache, we are closing
+    // avoid any file re-cache, we are closing. The scans still running are ignored
+    m_watcher.Clear();
+    m_pendingChanges.clear();
+    m_scanCompletedGeneration = ++m_scanGeneration;
     Save(false);
     DoClear();
 
@@ -435,11 +461,25 @@ void clFileSystemWorkspace::New(const wxString& folder, const wxString& name) {
 
 void clFileSystemWorkspace::OnScanCompleted(clFileSystemEvent& event)
 {
-    clDEBUG() << "FSW: CacheFiles completed. Found" << event.GetPaths().size() << "files";
+    ScanResult* result = dynamic_cast<ScanResult*>(event.GetClientObject());
+    CHECK_PTR_RET(result);
+    if (result->generation != m_scanGeneration) {
+        // a newer scan is running, or the workspace was closed: its result supersedes this one
+        clDEBUG() << "FSW: ignoring the result of a stale scan" << endl;
+        return;
+    }
+    clDEBUG() << "FSW: CacheFiles completed. Found" << result->files.size() << "files";
+    m_scanCompletedGeneration = result->generation;
     m_files.Clear();
-    m_files.Alloc(event.GetPaths().size());
-    for (const wxString& filename : event.GetPaths()) {
-        m_files.Add(filename);
+    m_files.Alloc(result->files.size());
+    for (const clPath& path : result->files) {
+        m_files.Add(path);
+    }
+
+    // the scan may have missed the changes reported while it was running
+    if (!m_pendingChanges.empty()) {
+        DoApplyFileChanges(m_pendingChanges);
+        m_pendingChanges.clear();
     }
     clGetManager()->SetStatusMessage(_("File system scan completed"));
 
@@ -907,11 +947,21 @@ void clFileSystemWorkspace::OnSourceControlPulled(clSourceControlEvent& event)
     clDEBUG() << "Refreshing tree + re-parsing";
     GetView()->RefreshTree();
 
-    // Re-Cache the files and trigger a workspace parse
-    CacheFiles(true);
+    // Re-Cache the files and trigger a workspace parse. When the whole folder is watched, the files cache is already up
+    // to date
+    if (m_watcher.IsRunning() && m_watcher.IsComplete()) {
+        Parse(false);
+    } else {
+        CacheFiles(true);
+    }
 }
 
-void clFileSystemWorkspace::FileSystemUpdated() { CacheFiles(true); }
+void clFileSystemWorkspace::FileSystemUpdated()
+{
+    if (!m_watcher.IsRunning() || !m_watcher.IsComplete()) {
+        CacheFiles(true);
+    }
+}
 
 void clFileSystemWorkspace::OnDebug(clDebugEvent& event)
 {
@@ -1063,6 +1113,74 @@ void clFileSystemWorkspace::OnFileSystemUpdated(clFileSystemEvent& event)
     }
 }
 
+void clFileSystemWorkspace::OnFilesChanged(clFileSystemEvent& event)
+{
+    if (!IsOpen()) {
+        return;
+    }
+
+    wxStringSet_t paths{ event.GetPaths().begin(), event.GetPaths().end() };
+    if (IsScanInProgress()) {
+        m_pendingChanges.insert(paths.begin(), paths.end());
+        return;
+    }
+
+    if (DoApplyFileChanges(paths)) {
+        clDEBUG() << "FSW: files cache updated." << m_files.GetSize() << "files" << endl;
+        Parse(false);
+
+        clWorkspaceEvent event_scan{ wxEVT_WORKSPACE_FILES_SCANNED };
+        EventNotifier::Get()->ProcessEvent(event_scan);
+    }
+}
+
+bool clFileSystemWorkspace::DoApplyFileChanges(const wxStringSet_t& paths)
+{
+    wxString rootFolder = GetDir();
+    wxString mask = GetFilesMask();
+    wxStringSet_t excludeFolders = GetExcludeFoldersSet();
+
+    bool modified = false;
+    for (const wxString& path : paths) {
+        if (path == rootFolder) {
+            // the watcher lost track of the changes, scan everything again
+            m_pendingChanges.clear();
+            CacheFiles(true);
+            return false;
+        }
+
+        if (wxFileName::DirExists(path)) {
+            // a folder was created or moved into the workspace
+            if (!clFilesScanner::IsIncluded(rootFolder, wxFileName(path, "dummy").GetFullPath(), "*", "",
+                                            excludeFolders)) {
+                continue;
+            }
+            clFilesScanner fs;
+            std::vector<wxString> files;
+            fs.Scan(path, files, mask, "", excludeFolders);
+            // the relative exclude folders are relative to the workspace folder, not to the scanned folder
+            for (const wxString& file : files) {
+                if (!m_files.Contains(file) &&
+                    clFilesScanner::IsIncluded(rootFolder, file, mask, "", excludeFolders)) {
+                    m_files.Add(file);
+                    modified = true;
+                }
+            }
+
+        } else if (wxFileName::FileExists(path)) {
+            if (!m_files.Contains(path) && clFilesScanner::IsIncluded(rootFolder, path, mask, "", excludeFolders)) {
+                m_files.Add(path);
+                modified = true;
+            }
+
+        } else if (m_files.Remove(path) || m_files.RemoveFolder(path) > 0) {
+            // a file or a folder was deleted or moved away
+            modified = true;
+        }
+    }
+    return modified;
+}
+
 void clFileSystemWorkspace::CreateCompileFlagsFile()
 {
     wxBusyCursor bc;
@@ -8,6 +8,7 @@
 #include "clDebuggerTerminal.h"
 #include "clFileCache.hpp"
 #include "clFileSystemEvent.h"
+#include "clFileSystemWatcher.h"
 #include "clFileSystemWorkspaceConfig.hpp"
 #include "clShellHelper.hpp"
 #include "cl_command_event.h"
@@ -39,9 +40,22 @@ class WXDLLIMPEXP_SDK clFileSystemWorkspace : public IWorkspace
     int m_execPID = wxNOT_FOUND;
     clBacktickCache::ptr_t m_backtickCache;
     clShellHelper m_shell_helper;
+    clFileSystemWatcher m_watcher;
+    /// incremented by each CacheFiles(): only the result of the last scan is kept
+    size_t m_scanGeneration = 0;
+    /// the generation of the last scan applied to the files cache
+    size_t m_scanCompletedGeneration = 0;
+    /// the changes reported by the watcher while a scan is running
+    wxStringSet_t m_pendingChanges;
 
 protected:
     void CacheFiles(bool force = false);
+    bool IsScanInProgress() const { return m_scanCompletedGeneration != m_scanGeneration; }
+    wxStringSet_t GetExcludeFoldersSet() const;
+    /**
+     * @brief update the files cache from the paths reported by the watcher. Return true if the cache was modified
+     */
+    bool DoApplyFileChanges(const wxStringSet_t& paths);
     wxString GetTargetCommand(const wxString& target) const;
     void DoPrintBuildMessage(const wxString& message);
     clEnvList_t GetEnvList();
@@ -76,6 +90,7 @@ protected:
     void OnSourceControlPulled(clSourceControlEvent& event);
     void OnDebug(clDebugEvent& event);
     void OnFileSystemUpdated(clFileSystemEvent& event);
+    void OnFilesChanged(clFileSystemEvent& event);
     void OnReloadWorkspace(clCommandEvent& event);
 
 protected:
@@ -167,7 +182,7 @@ public:
      */
     bool IsOpen() const { return m_isLoaded; }
 
-    const std::vector<wxFileName>& GetFiles() const { return m_files.GetFiles(); }
+    const std::vector<clPath>& GetFiles() const { return m_files.GetFiles(); }
 
     wxString GetName() const override { return m_filename.GetName(); }
     void SetName(const wxString& name) { m_settings.SetName(name); }
@@ -183,7 +198,8 @@ public:
 
     /**
      * @brief call this to update the workspace once a file system changes.
-     * this method will re-cache the files + parse the workspace
+     * this method will re-cache the files + parse the workspace. When the workspace folder is watched, the cache is
+     * already kept up to date from the watcher events and nothing is done.
      * Note that this method does NOT update the UI in anyways.
      */
     void FileSystemUpdated();
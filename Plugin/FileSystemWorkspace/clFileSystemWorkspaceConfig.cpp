@@ -1,6 +1,7 @@
 #include "clFileSystemWorkspaceConfig.hpp"
 
 #include "Debugger/debuggermanager.h"
+#include "GCCMetadata.hpp"
 #include "ICompilerLocator.h"
 #include "StdToWX.h"
 #include "build_settings_config.h"
@@ -135,10 +136,10 @@ clFileSystemWorkspaceConfig::Ptr_t clFileSystemWorkspaceConfig::Clone() const
     return clFileSystemWorkspaceConfig::Ptr_t(new clFileSystemWorkspaceConfig(*this));
 }
 
-static wxArrayString GetExtraFlags(CompilerPtr compiler)
+static wxArrayString GetExtraFlags(CompilerPtr compiler, const wxString& flags)
 {
     if (compiler->HasMetadata()) {
-        auto md = compiler->GetMetadata();
+        auto md = compiler->GetMetadata(flags);
         if (!md.GetTarget().IsEmpty()) {
             return StdToWX::ToArrayString({ "-target", md.GetTarget() });
         }
@@ -153,7 +154,9 @@ wxArrayString clFileSystemWorkspaceConfig::GetCompilerOptions(clBacktickCache::p
     // Add the compiler paths
     CompilerPtr compiler = BuildSettingsConfigST::Get()->GetCompiler(GetCompiler());
     if (compiler) {
-        wxArrayString compilerPaths = compiler->GetDefaultIncludePaths();
+        // the user flags that change the compiler's own search paths (-m32, --sysroot...)
+        wxString metadataFlags = GCCMetadata::GetMetadataFlags(wxJoin(m_compileFlags, ' ', 0));
+        wxArrayString compilerPaths = compiler->GetDefaultIncludePaths(metadataFlags);
         if (!compiler->GetGlobalIncludePath().IsEmpty()) {
             wxArrayString globalIncludePaths =
                 ::wxStringTokenize(compiler->GetGlobalIncludePath(), ";", wxTOKEN_STRTOK);
@@ -164,7 +167,7 @@ wxArrayString clFileSystemWorkspaceConfig::GetCompilerOptions(clBacktickCache::p
         }
         searchPaths.insert(searchPaths.end(), compilerPaths.begin(), compilerPaths.end());
 
-        auto extraFlags = GetExtraFlags(compiler);
+        auto extraFlags = GetExtraFlags(compiler, metadataFlags);
         if (!extraFlags.empty()) {
             searchPaths.insert(searchPaths.end(), extraFlags.begin(), extraFlags.end());
         }
@@ -172,6 +175,18 @@ wxArrayString clFileSystemWorkspaceConfig::GetCompilerOptions(clBacktickCache::p
     return searchPaths;
 }
 
+void clFileSystemWorkspaceConfig::PrefetchUserCompletionFlags(const wxString& workingDirectory,
+                                                              clBacktickCache::ptr_t backticks) const
+{
+    CHECK_PTR_RET(backticks);
+    for (const auto& line : m_compileFlags) {
+        wxString backtick = line.AfterFirst('`').BeforeLast('`');
+        if (!backtick.empty()) {
+            backticks->Prefetch(backtick, workingDirectory);
+        }
+    }
+}
+
 wxArrayString clFileSystemWorkspaceConfig::ExpandUserCompletionFlags(const wxString& workingDirectory,
                                                                      clBacktickCache::ptr_t backticks,
                                                                      bool withPrefix) const
@@ -192,8 +207,8 @@ wxArrayString clFileSystemWorkspaceConfig::ExpandUserCompletionFlags(const wxStr
         }
         wxString backtick_expanded;
         if (!backtick.empty()) {
-            if (backticks && backticks->HasCommand(backtick)) {
-                backtick_expanded = backticks->GetExpanded(backtick);
+            if (backticks) {
+                backtick_expanded = backticks->Expand(backtick, workingDirectory);
             } else {
                 // we got backtick, expand it
                 DirSaver ds;
@@ -204,11 +219,6 @@ wxArrayString clFileSystemWorkspaceConfig::ExpandUserCompletionFlags(const wxStr
                 clDEBUG() << "Running command:" << backtick << clEndl;
                 backtick_expanded = ProcUtils::SafeExecuteCommand(backtick);
                 backtick_expanded.Trim().Trim(false);
-                // keep the result for future lookups
-                if (backticks) {
-                    backticks->SetCommand(backtick, backtick_expanded);
-                    backticks->Save();
-                }
                 clDEBUG() << "Output:" << backtick_expanded << clEndl;
             }
         }
@@ -109,6 +109,10 @@ public:
 
     wxArrayString ExpandUserCompletionFlags(const wxString& workingDirectory, clBacktickCache::ptr_t backticks,
                                             bool withPrefix = false) const;
+    /**
+     * @brief start expanding the backticks of the completion flags in the background
+     */
+    void PrefetchUserCompletionFlags(const wxString& workingDirectory, clBacktickCache::ptr_t backticks) const;
     wxArrayString GetCompilerOptions(clBacktickCache::ptr_t backticks) const;
     void SetDebuggerCommands(const wxString& debuggerCommands) { this->m_debuggerCommands = debuggerCommands; }
     void SetDebuggerPath(const wxString& debuggerPath) { this->m_debuggerPath = debuggerPath; }
@@ -25,7 +25,9 @@
 
 #include "GCCMetadata.hpp"
 
+#include "CompilersDetectorCache.hpp"
 #include "Cxx/CxxPreProcessor.h"
+#include "JSON.h"
 #include "clTempFile.hpp"
 #include "environmentconfig.h"
 #include "file_logger.h"
@@ -44,16 +46,33 @@
 static std::unordered_map<wxString, GCCMetadata> s_cache;
 static wxCriticalSection s_cs;
 
-void GCCMetadata::GetMetadataFromCache(const wxString& tool, const wxString& rootDir, bool is_cygwin, GCCMetadata* md)
+void GCCMetadata::GetMetadataFromCache(const wxString& tool, const wxString& rootDir, bool is_cygwin,
+                                       const wxString& flags, GCCMetadata* md)
 {
+    wxString query;
+    query << "GCCMetadata\n" << rootDir << "\n" << (is_cygwin ? "cygwin" : "") << "\n" << flags;
+    wxString key;
+    key << tool << "\n" << query;
+
     wxCriticalSectionLocker locker(s_cs);
-    if (s_cache.count(tool) == 0) {
+    if (s_cache.count(key) == 0) {
+        // not queried during this session: try the results of the previous sessions before running the compiler
+        wxString binary = tool;
+        binary.Replace("\"", "");
+
         GCCMetadata tmp(md->m_basename);
-        tmp.DoLoad(tool, rootDir, is_cygwin);
-        s_cache.insert({ tool, tmp });
+        wxString json;
+        if (!CompilersDetectorCache::Get().Lookup(binary, query, json) || !tmp.FromJSON(json)) {
+            tmp.DoLoad(tool, rootDir, is_cygwin, flags);
+            if (!tmp.m_target.empty() || !tmp.m_searchPaths.empty()) {
+                CompilersDetectorCache::Get().Store(binary, query, tmp.ToJSON());
+                CompilersDetectorCache::Get().Save();
+            }
+        }
+        s_cache.insert({ key, tmp });
     }
 
-    const auto& cachedEntry = s_cache[tool];
+    const auto& cachedEntry = s_cache[key];
     *md = cachedEntry;
 }
 
@@ -64,14 +83,60 @@ GCCMetadata::GCCMetadata(const wxString& basename)
 
 GCCMetadata::~GCCMetadata() {}
 
-void GCCMetadata::Load(const wxString& tool, const wxString& rootDir, bool is_cygwin)
+void GCCMetadata::Load(const wxString& tool, const wxString& rootDir, bool is_cygwin, const wxString& flags)
 {
     // find an entry in the cache
     // if no such entry exist, update the cache
-    GetMetadataFromCache(tool, rootDir, is_cygwin, this);
+    GetMetadataFromCache(tool, rootDir, is_cygwin, GetMetadataFlags(flags), this);
+}
+
+wxString GCCMetadata::GetMetadataFlags(const wxString& flags)
+{
+    wxArrayString tokens = ::wxStringTokenize(flags, " \t\r\n", wxTOKEN_STRTOK);
+    wxArrayString result;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const wxString& token = tokens[i];
+        // the compiler is queried for C++ (-x c++): a C standard (e.g. from the flags of the C files) is rejected by
+        // clang, which then reports nothing
+        bool is_cxx_std = token.StartsWith("-std=c++") || token.StartsWith("-std=gnu++");
+        if (token == "-m32" || token == "-m64" || token == "-mx32" || is_cxx_std || token.StartsWith("-stdlib=") ||
+            token.StartsWith("--sysroot=") || token.StartsWith("--target=")) {
+            result.Add(token);
+
+        } else if ((token == "--sysroot" || token == "-isysroot" || token == "-target") && i + 1 < tokens.size()) {
+            // the value is the next token
+            result.Add(token);
+            result.Add(tokens[++i]);
+        }
+    }
+    return wxJoin(result, ' ', 0);
+}
+
+wxString GCCMetadata::ToJSON() const
+{
+    JSON root(cJSON_Object);
+    JSONItem item = root.toElement();
+    item.addProperty("target", m_target);
+    item.addProperty("searchPaths", m_searchPaths);
+    item.addProperty("macros", m_macros);
+    return item.format(false);
+}
+
+bool GCCMetadata::FromJSON(const wxString& json)
+{
+    JSON root(json);
+    if (!root.isOk()) {
+        return false;
+    }
+    JSONItem item = root.toElement();
+    m_target = item.namedObject("target").toString();
+    m_searchPaths = item.namedObject("searchPaths").toArrayString();
+    m_macros = item.namedObject("macros").toArrayString();
+    m_name = m_basename;
+    return true;
 }
 
-void GCCMetadata::DoLoad(const wxString& tool, const wxString& rootDir, bool is_cygwin)
+void GCCMetadata::DoLoad(const wxString& tool, const wxString& rootDir, bool is_cygwin, const wxString& flags)
 {
     m_searchPaths.clear();
     m_target.clear();
@@ -95,16 +160,17 @@ void GCCMetadata::DoLoad(const wxString& tool, const wxString& rootDir, bool is_
 
 #ifdef __WXMSW__
     if (::clIsCygwinEnvironment()) {
-        command << cxx.GetFullName() << " -v -x c++ /dev/null -fsyntax-only";
+        command << cxx.GetFullName() << " " << flags << " -v -x c++ /dev/null -fsyntax-only";
     } else {
 
         // execute the command from the tool directory
         working_directory = cxx.GetPath();
         ::WrapWithQuotes(working_directory);
-        command << cxx.GetFullName() << " -xc++ -E -v " << tmpfile.GetFullPath(true) << " -fsyntax-only";
+        command << cxx.GetFullName() << " " << flags << " -xc++ -E -v " << tmpfile.GetFullPath(true)
+                << " -fsyntax-only";
     }
 #else
-    command << cxx.GetFullName() << " -v -x c++ /dev/null -fsyntax-only";
+    command << cxx.GetFullName() << " " << flags << " -v -x c++ /dev/null -fsyntax-only";
 #endif
 
     wxString outputStr = RunCommand(command, working_directory, &envlist);
@@ -147,7 +213,7 @@ void GCCMetadata::DoLoad(const wxString& tool, const wxString& rootDir, bool is_
     }
 
     // get the target
-    m_target = RunCommand(cxx.GetFullName() + " -dumpmachine", wxFileName(tool).GetPath(), &envlist);
+    m_target = RunCommand(cxx.GetFullName() + " " + flags + " -dumpmachine", wxFileName(tool).GetPath(), &envlist);
     wxString versionString = RunCommand(cxx.GetFullName() + " -dumpversion", wxFileName(tool).GetPath(), &envlist);
     m_name = m_basename;
 
@@ -156,7 +222,7 @@ void GCCMetadata::DoLoad(const wxString& tool, const wxString& rootDir, bool is_
     macrosFile.Write(wxEmptyString);
 
     wxString macros_command;
-    macros_command << cxx.GetFullName() << " -dM -E -xc++ " << macrosFile.GetFullPath(true);
+    macros_command << cxx.GetFullName() << " " << flags << " -dM -E -xc++ " << macrosFile.GetFullPath(true);
 
     clDEBUG() << "Loading built-in macros for compiler '" << GetName() << "' :" << macros_command << clEndl;
     wxString macros = RunCommand(macros_command, working_directory, &envlist);
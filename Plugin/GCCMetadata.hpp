@@ -36,6 +36,8 @@
 // - Target
 // - Search paths
 // this class supports both the GCC and CLANG compilers
+// The metadata is cached per compiler binary and flags, in memory and on the disk (see CompilersDetectorCache): a
+// compiler is queried again only when its binary changes
 class WXDLLIMPEXP_SDK GCCMetadata
 {
     wxArrayString m_searchPaths;
@@ -47,8 +49,11 @@ class WXDLLIMPEXP_SDK GCCMetadata
 private:
     wxString RunCommand(const wxString& command, const wxString& working_directory = wxEmptyString,
                         clEnvList_t* env = nullptr);
-    static void GetMetadataFromCache(const wxString& tool, const wxString& rootDir, bool is_cygwin, GCCMetadata* md);
-    void DoLoad(const wxString& tool, const wxString& rootDir, bool is_cygwin = false);
+    static void GetMetadataFromCache(const wxString& tool, const wxString& rootDir, bool is_cygwin,
+                                     const wxString& flags, GCCMetadata* md);
+    void DoLoad(const wxString& tool, const wxString& rootDir, bool is_cygwin, const wxString& flags);
+    wxString ToJSON() const;
+    bool FromJSON(const wxString& json);
 
 public:
     GCCMetadata(const wxString& basename = "GCC");
@@ -63,8 +68,17 @@ public:
      *
      * @param tool the compiler to use
      * @param rootDir the compiler installation folder (the root folder). Needed for Windows, ignored elsewhere
+     * @param flags compiler flags that change the search paths or the macros, see GetMetadataFlags()
      */
-    void Load(const wxString& tool, const wxString& rootDir, bool is_cygwin = false);
+    void Load(const wxString& tool, const wxString& rootDir, bool is_cygwin = false,
+              const wxString& flags = wxEmptyString);
+
+    /**
+     * @brief return the flags out of `flags` that change what the compiler reports: the C++ language standard, the
+     * sysroot, the target and the architecture (-std=c++/gnu++, -stdlib, --sysroot, -isysroot, -target, -m32...).
+     * The C standards are dropped: the compiler is queried for C++
+     */
+    static wxString GetMetadataFlags(const wxString& flags);
 
     // accessors
     const wxString& GetName() const { return m_name; }
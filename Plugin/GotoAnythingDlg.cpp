@@ -1,19 +1,23 @@
 #include "GotoAnythingDlg.h"
 
-#include "clAnagram.h"
 #include "codelite_events.h"
 #include "event_notifier.h"
 #include "file_logger.h"
 #include "globals.h"
 #include "macros.h"
 
+#include <algorithm>
 #include <wx/app.h>
 
 GotoAnythingDlg::GotoAnythingDlg(wxWindow* parent, const std::vector<clGotoEntry>& entries)
     : GotoAnythingBaseDlg(parent)
     , m_allEntries(entries)
 {
-    DoPopulate(m_allEntries);
+    m_matcher.Reserve(m_allEntries.size());
+    for (const clGotoEntry& entry : m_allEntries) {
+        m_matcher.Add(entry.GetDesc());
+    }
+    DoPopulate();
 
     ::clSetDialogBestSizeAndPosition(this);
 }
@@ -49,23 +53,58 @@ void GotoAnythingDlg::OnEnter(wxCommandEvent& event)
     DoExecuteActionAndClose();
 }
 
-void GotoAnythingDlg::DoPopulate(const std::vector<clGotoEntry>& entries, const std::vector<int>& indexes)
+void GotoAnythingDlg::DoPopulate()
 {
     m_dvListCtrl->DeleteAllItems();
     m_dvListCtrl->Begin();
-    for (size_t i = 0; i < entries.size(); ++i) {
-        const clGotoEntry& entry = entries[i];
-        wxVector<wxVariant> cols;
-        cols.push_back(wxT("\u2022 ") + entry.GetDesc());
-        cols.push_back(entry.GetKeyboardShortcut());
-        m_dvListCtrl->AppendItem(cols, indexes.empty() ? i : indexes[i]);
+    if (m_query.IsEmpty()) {
+        for (size_t i = 0; i < m_allEntries.size(); ++i) {
+            DoAppendEntry(i);
+        }
+    } else {
+        for (const clFuzzyMatcher::Match& match : m_matches) {
+            DoAppendEntry(match.index);
+        }
     }
     m_dvListCtrl->Commit();
-    if (!entries.empty()) {
+    if (!m_dvListCtrl->IsEmpty()) {
         m_dvListCtrl->SelectRow(0);
     }
 }
 
+void GotoAnythingDlg::DoAppendEntry(size_t index)
+{
+    static const wxString prefix = wxT("\u2022 ");
+
+    const clGotoEntry& entry = m_allEntries[index];
+    wxVector<wxVariant> cols;
+    cols.push_back(prefix + entry.GetDesc());
+    cols.push_back(entry.GetKeyboardShortcut());
+    wxDataViewItem item = m_dvListCtrl->AppendItem(cols, index);
+
+    std::vector<size_t> positions;
+    if (m_query.IsEmpty() || m_query.Score(entry.GetDesc(), &positions) < 0 || positions.empty()) {
+        return;
+    }
+
+    // highlight the longest run of matched characters
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    size_t start = positions[0];
+    size_t length = 1;
+    size_t runStart = positions[0];
+    for (size_t i = 1; i < positions.size(); ++i) {
+        if (positions[i] != positions[i - 1] + 1) {
+            runStart = positions[i];
+        } else if (positions[i] - runStart + 1 > length) {
+            start = runStart;
+            length = positions[i] - runStart + 1;
+        }
+    }
+    m_dvListCtrl->SetItemHighlightInfo(item, prefix.length() + start, length, 0);
+    m_dvListCtrl->HighlightText(item, true);
+}
+
 void GotoAnythingDlg::DoExecuteActionAndClose()
 {
     int row = m_dvListCtrl->GetSelectedRow();
@@ -98,25 +137,19 @@ void GotoAnythingDlg::ApplyFilter()
 
     // Update the last applied filter
     m_currentFilter = filter;
-    if (filter.IsEmpty()) {
-        DoPopulate(m_allEntries);
+    clFuzzyQuery query(filter);
+    if (query.IsEmpty()) {
+        m_matches.clear();
+    } else if (query.IsNarrowing(m_query)) {
+        // the new filter extends the previous one: only its matches can still match
+        m_matches = m_matcher.Filter(query, &m_matches);
     } else {
-
-        // Filter the list
-        clAnagram anagram(filter);
-        std::vector<clGotoEntry> matchedEntries;
-        std::vector<int> matchedEntriesIndex;
-        for (size_t i = 0; i < m_allEntries.size(); ++i) {
-            const clGotoEntry& entry = m_allEntries[i];
-            if (anagram.MatchesInOrder(entry.GetDesc())) {
-                matchedEntries.push_back(entry);
-                matchedEntriesIndex.push_back(i);
-            }
-        }
-
-        // And populate the list
-        DoPopulate(matchedEntries, matchedEntriesIndex);
+        m_matches = m_matcher.Filter(query);
     }
+    m_query = query;
+
+    // And populate the list
+    DoPopulate();
 }
 
 void GotoAnythingDlg::OnItemActivated(wxDataViewEvent& event)
@@ -3,6 +3,7 @@
 
 #include "GotoAnythingBaseUI.h"
 #include "bitmap_loader.h"
+#include "clFuzzyMatcher.hpp"
 #include "clGotoAnythingManager.h"
 #include "clThemedListCtrl.h"
 #include "codelite_exports.h"
@@ -14,11 +15,17 @@ class WXDLLIMPEXP_SDK GotoAnythingDlg : public GotoAnythingBaseDlg
     const std::vector<clGotoEntry>& m_allEntries;
     wxString m_currentFilter;
     clThemedListCtrl::BitmapVec_t m_bitmaps;
+    /// the descriptions of m_allEntries
+    clFuzzyMatcher m_matcher;
+    /// the last applied filter and the entries it matched, best first
+    clFuzzyQuery m_query;
+    std::vector<clFuzzyMatcher::Match> m_matches;
 
 protected:
     virtual void OnItemActivated(wxDataViewEvent& event);
 
-    void DoPopulate(const std::vector<clGotoEntry>& entries, const std::vector<int>& indexes = std::vector<int>());
+    void DoPopulate();
+    void DoAppendEntry(size_t index);
     void DoExecuteActionAndClose();
     void ApplyFilter();
 
@@ -84,6 +84,12 @@ public:
      */
     virtual CompilerPtr Locate(const wxString& folder) = 0;
 
+    /**
+     * @brief can Locate() run on a worker thread, next to the other locators? Locators that spawn processes with
+     * wxExecute() must run on the main thread
+     */
+    virtual bool IsThreadSafe() const { return true; }
+
     /**
      * @brief return the compiler
      */
@@ -0,0 +1,912 @@
+#include "BuilderNinja.hpp"
+
+#include "ICompilerLocator.h"
+#include "StringUtils.h"
+#include "build_settings_config.h"
+#include "cl_command_event.h"
+#include "environmentconfig.h"
+#include "envvarlist.h"
+#include "event_notifier.h"
+#include "file_logger.h"
+#include "fileextmanager.h"
+#include "globals.h"
+#include "macromanager.h"
+#include "workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+#include <wx/filename.h>
+#include <wx/sstream.h>
+#include <wx/tokenzr.h>
+#include <wx/xml/xml.h>
+
+namespace
+{
+enum eDepsFormat {
+    kDepsNone,
+    kDepsGcc,
+};
+
+/// the make variables of the compilation lines replaced by a variable of the build edge
+const std::vector<std::pair<wxString, wxString>> kFileVariables = {
+    { "$(FileName)", "file_name" },
+    { "$(FileFullName)", "file_full_name" },
+    { "$(FilePath)", "file_path" },
+    { "$(ObjectName)", "object_name" },
+};
+
+/// ninja variables are kept out of the make expansion and the escaping by a placeholder
+wxString Placeholder(const wxString& variable) { return wxString('\x01') + variable + wxString('\x01'); }
+
+wxString EscapeValue(const wxString& value)
+{
+    wxString escaped = value;
+    escaped.Replace("$", "$$");
+    escaped.Replace("\r", "");
+    escaped.Replace("\n", " ");
+    return escaped;
+}
+
+wxString EscapeCommand(const wxString& command)
+{
+    wxString escaped = EscapeValue(command);
+    for (const wxString& variable : { "in", "out", "file_name", "file_full_name", "file_path", "object_name" }) {
+        escaped.Replace(Placeholder(variable), "$" + variable);
+    }
+    return escaped;
+}
+
+wxString ToIdentifier(const wxString& str)
+{
+    wxString identifier;
+    for (size_t i = 0; i < str.length(); ++i) {
+        wxUniChar ch = str[i];
+        identifier << ((ch < 128 && wxIsalnum(ch)) ? ch : wxUniChar('_'));
+    }
+    return identifier;
+}
+
+wxString MakeAbsolutePath(const wxString& path, const wxString& dir)
+{
+    wxFileName fn(path);
+    fn.MakeAbsolute(dir);
+    wxString fullpath = fn.GetFullPath();
+    fullpath.Replace("\\", "/");
+    return fullpath;
+}
+
+wxString JoinCommands(const BuildCommandList& commands)
+{
+    wxString joined;
+    for (const BuildCommand& command : commands) {
+        if (!command.GetEnabled()) {
+            continue;
+        }
+        if (!joined.empty()) {
+            joined << " && ";
+        }
+        joined << command.GetCommand();
+    }
+    return joined;
+}
+
+eDepsFormat AppendDependenciesFlags(CompilerPtr cmp, wxString& command)
+{
+    // cl.exe prints its "/showIncludes" lines in the language of the installation, which ninja can only parse with
+    // the matching "msvc_deps_prefix". As with the makefiles, MSVC builds do not track the headers
+    if (cmp->GetCompilerFamily() != COMPILER_FAMILY_VC && cmp->IsGnuCompatibleCompiler()) {
+        command << " -MMD -MF " << Placeholder("out") << ".d";
+        return kDepsGcc;
+    }
+    return kDepsNone;
+}
+
+void WriteRule(const wxString& name, const wxString& command, eDepsFormat deps, bool rspfile, wxString& text)
+{
+    text << "rule " << name << "\n";
+    text << "  command = " << EscapeCommand(command) << "\n";
+    switch (deps) {
+    case kDepsGcc:
+        text << "  depfile = $out.d\n";
+        text << "  deps = gcc\n";
+        break;
+    case kDepsNone:
+        break;
+    }
+    if (rspfile) {
+        text << "  rspfile = $out.rsp\n";
+        text << "  rspfile_content = $in\n";
+    }
+}
+} // namespace
+
+BuilderNinja::BuilderNinja()
+    : BuilderGnuMake("CodeLite Ninja Generator", "ninja", "")
+{
+}
+
+BuilderNinja::~BuilderNinja() {}
+
+wxString BuilderNinja::GetNinjaFile() const
+{
+    wxFileName fn(clCxxWorkspaceST::Get()->GetWorkspaceFileName().GetPath(), "build.ninja");
+    return fn.GetFullPath();
+}
+
+wxString BuilderNinja::GetBuildDir() const
+{
+    wxString build_dir = clCxxWorkspaceST::Get()->GetWorkspaceFileName().GetPath();
+    WorkspaceConfigurationPtr workspaceConf = clCxxWorkspaceST::Get()->GetSelectedConfig();
+    build_dir << "/build-" << (workspaceConf ? workspaceConf->GetName() : wxString("Default"));
+    build_dir.Replace("\\", "/");
+    return build_dir;
+}
+
+wxString BuilderNinja::GetNinjaCommand(const wxString& args)
+{
+    if (m_ninjaExe.empty()) {
+        wxFileName exe;
+        if (::clFindExecutable("ninja", exe)) {
+            m_ninjaExe = exe.GetFullPath();
+        }
+    }
+
+    wxString command;
+    command << StringUtils::WrapWithDoubleQuotes(m_ninjaExe.empty() ? wxString("ninja") : m_ninjaExe) << " -C "
+            << StringUtils::WrapWithDoubleQuotes(clCxxWorkspaceST::Get()->GetWorkspaceFileName().GetPath())
+            << " -f build.ninja " << args;
+    return command;
+}
+
+wxString BuilderNinja::WrapCommand(const wxString& dir, const wxString& command) const
+{
+    wxString wrapped;
+    if (m_isWindows) {
+        // ninja spawns the commands without a shell on Windows
+        wrapped << "cmd /c cd /d \"" << dir << "\" && " << command;
+    } else {
+        wrapped << "cd \"" << dir << "\" && " << command;
+    }
+    return wrapped;
+}
+
+wxString BuilderNinja::ExpandMakeVariables(const wxString& str, const StringMap_t& vars)
+{
+    wxString result;
+    result.reserve(str.length());
+
+    const size_t count = str.length();
+    for (size_t i = 0; i < count; ++i) {
+        wxUniChar ch = str[i];
+        if (ch != '$' || i + 1 == count) {
+            result << ch;
+            continue;
+        }
+
+        wxUniChar next = str[i + 1];
+        if (next == '$') {
+            result << '$';
+            ++i;
+            continue;
+        }
+
+        wxString name;
+        if (next == '(' || next == '{') {
+            wxUniChar close = next == '(' ? ')' : '}';
+            size_t nesting = 1;
+            size_t end = i + 2;
+            for (; end < count; ++end) {
+                if (str[end] == next) {
+                    ++nesting;
+                } else if (str[end] == close && --nesting == 0) {
+                    break;
+                }
+            }
+            if (end == count) {
+                // unterminated reference, keep it as-is
+                result << str.Mid(i);
+                break;
+            }
+            name = str.Mid(i + 2, end - i - 2);
+            i = end;
+
+        } else {
+            name = next;
+            ++i;
+        }
+
+        if (name.StartsWith("shell ")) {
+            result << "`" << ExpandMakeVariables(name.Mid(6), vars) << "`";
+            continue;
+        }
+
+        wxString value;
+        auto iter = vars.find(name);
+        if (iter != vars.end()) {
+            result << iter->second;
+        } else if (wxGetEnv(name, &value)) {
+            result << value;
+        }
+    }
+    return result;
+}
+
+wxString BuilderNinja::EscapePath(const wxString& path)
+{
+    wxString escaped = path;
+    escaped.Replace("\\", "/");
+    escaped.Replace("$", "$$");
+    escaped.Replace(" ", "$ ");
+    escaped.Replace(":", "$:");
+    return escaped;
+}
+
+BuilderNinja::StringMap_t BuilderNinja::GetProjectVariables(ProjectPtr proj, BuildConfigPtr bldConf)
+{
+    // use the variables of the generated makefile, so both generators compile with the same flags
+    wxString text;
+    CreateConfigsVariables(proj, bldConf, text);
+
+    std::vector<std::pair<wxString, wxString>> definitions;
+    wxArrayString lines = ::wxStringTokenize(text, "\n", wxTOKEN_STRTOK);
+    for (const wxString& line : lines) {
+        int where = line.Find(":=");
+        if (line.StartsWith("#") || where == wxNOT_FOUND) {
+            continue;
+        }
+        definitions.push_back({ line.Mid(0, where).Trim().Trim(false), line.Mid(where + 2).Trim().Trim(false) });
+    }
+
+    // followed by the user defined environment variables
+    EnvVarList env_vars;
+    EnvironmentConfig::Instance()->ReadObject("Variables", &env_vars);
+    EnvMap env_map = env_vars.GetVariables("", true, proj->GetName(), bldConf->GetName());
+    for (size_t i = 0; i < env_map.GetCount(); ++i) {
+        wxString name, value;
+        env_map.Get(i, name, value);
+        definitions.push_back({ name, value });
+    }
+
+    // the makefiles are run with "make -e": the environment overrides their variables. As with ":=", a value is
+    // expanded when it is defined
+    StringMap_t vars;
+    for (const auto& definition : definitions) {
+        wxString value;
+        if (!wxGetEnv(definition.first, &value)) {
+            value = ExpandMakeVariables(definition.second, vars);
+        }
+        vars[definition.first] = value;
+    }
+    return vars;
+}
+
+size_t BuilderNinja::GetExportInputsHash(const wxString& project, const wxString& confToBuild) const
+{
+    BuildMatrixPtr matrix = clCxxWorkspaceST::Get()->GetBuildMatrix();
+    wxString workspaceSelConf = matrix->GetSelectedConfigurationName();
+
+    wxString inputs;
+    inputs << GetNinjaFile() << "\n" << project << "\n" << confToBuild << "\n" << workspaceSelConf << "\n";
+
+    EnvVarList env_vars;
+    EnvironmentConfig::Instance()->ReadObject("Variables", &env_vars);
+
+    // the projects: their settings and files are in the project XML
+    wxArrayString names;
+    clCxxWorkspaceST::Get()->GetProjectList(names);
+    names.Sort();
+    for (const wxString& name : names) {
+        wxString errMsg;
+        ProjectPtr proj = clCxxWorkspaceST::Get()->FindProjectByName(name, errMsg);
+        if (!proj) {
+            continue;
+        }
+        wxString projectSelConf = matrix->GetProjectSelectedConf(workspaceSelConf, name);
+        EnvMap env_map = env_vars.GetVariables("", true, name, projectSelConf);
+        inputs << name << "\n"
+               << projectSelConf << "\n"
+               << proj->GetXmlHash() << "\n"
+               << env_map.String() << "\n";
+    }
+
+    // the compilers tools, switches and file types
+    wxArrayString compilers = BuildSettingsConfigST::Get()->GetAllCompilersNames();
+    compilers.Sort();
+    for (const wxString& name : compilers) {
+        wxXmlDocument doc;
+        doc.SetRoot(BuildSettingsConfigST::Get()->GetCompiler(name)->ToXml());
+        wxStringOutputStream sos(&inputs);
+        doc.Save(sos);
+    }
+    return std::hash<wxString>{}(inputs);
+}
+
+void BuilderNinja::CollectProjects(const wxString& project, const wxString& confToBuild)
+{
+    m_projects.clear();
+
+    BuildMatrixPtr matrix = clCxxWorkspaceST::Get()->GetBuildMatrix();
+    wxString workspaceSelConf = matrix->GetSelectedConfigurationName();
+
+    wxArrayString names;
+    clCxxWorkspaceST::Get()->GetProjectList(names);
+
+    std::unordered_set<wxString> rule_prefixes;
+    for (const wxString& name : names) {
+        wxString errMsg;
+        ProjectPtr proj = clCxxWorkspaceST::Get()->FindProjectByName(name, errMsg);
+        if (!proj) {
+            continue;
+        }
+
+        wxString projectSelConf = matrix->GetProjectSelectedConf(workspaceSelConf, name);
+        if (name == project && !confToBuild.IsEmpty()) {
+            projectSelConf = confToBuild;
+        }
+
+        // disabled projects are not built, unless it is the one requested
+        BuildConfigPtr bldConf = clCxxWorkspaceST::Get()->GetProjBuildConf(name, projectSelConf);
+        if (!bldConf || (!bldConf->IsProjectEnabled() && name != project)) {
+            continue;
+        }
+
+        NinjaProject info;
+        info.project = proj;
+        info.build_config = bldConf;
+        info.project_path = proj->GetFileName().GetPath();
+        info.is_plugin_makefile = SendBuildEvent(wxEVT_GET_IS_PLUGIN_MAKEFILE, name, bldConf->GetName());
+        info.is_custom_build = !info.is_plugin_makefile && bldConf->IsCustomBuild();
+
+        if (!info.is_plugin_makefile && !info.is_custom_build) {
+            CompilerPtr cmp = bldConf->GetCompiler();
+            if (!cmp) {
+                clWARNING() << "Ninja generator: can't find a compiler for project" << name << "- skipping it" << endl;
+                continue;
+            }
+
+            info.variables = GetProjectVariables(proj, bldConf);
+            info.intermediate_dir = MakeAbsolutePath(info.variables["IntermediateDirectory"], info.project_path);
+
+            wxString type = proj->GetSettings() ? proj->GetSettings()->GetProjectType(bldConf->GetName())
+                                                : bldConf->GetProjectType();
+            if (bldConf->IsLinkerRequired() && !cmp->GetLinkLine(type, false).IsEmpty()) {
+                info.output = MakeAbsolutePath(info.variables["OutputFile"], info.project_path);
+            }
+            info.is_library = type == PROJECT_TYPE_STATIC_LIBRARY || type == PROJECT_TYPE_DYNAMIC_LIBRARY;
+        }
+
+        // rules are named after the project
+        wxString prefix = ToIdentifier(name);
+        info.rule_prefix = prefix;
+        for (size_t i = 2; !rule_prefixes.insert(info.rule_prefix).second; ++i) {
+            info.rule_prefix = wxString() << prefix << "_" << i;
+        }
+        m_projects.insert({ name, info });
+    }
+
+    // dependencies on projects which are not built are dropped
+    for (auto& vt : m_projects) {
+        wxArrayString deps = vt.second.project->GetDependencies(vt.second.build_config->GetName());
+        for (const wxString& dep : deps) {
+            if (m_projects.count(dep)) {
+                vt.second.dependencies.Add(dep);
+            }
+        }
+    }
+}
+
+wxString BuilderNinja::GetTargetName(const NinjaProject& info) const { return EscapePath(info.project->GetName()); }
+
+wxString BuilderNinja::GetOrderOnlyDeps(const NinjaProject& info) const
+{
+    wxString deps;
+    for (const wxString& dep : info.dependencies) {
+        if (!deps.empty()) {
+            deps << " ";
+        }
+        deps << GetTargetName(m_projects.find(dep)->second);
+    }
+    return deps;
+}
+
+void BuilderNinja::WriteRunEdge(const wxString& output, const wxString& command, const wxString& description,
+                                const wxString& inputs, const wxString& order_only, bool console, wxString& text)
+{
+    // the output is never created: the command runs on every build, like the PHONY targets of the makefiles
+    text << "build " << EscapePath(output) << ": run";
+    if (!inputs.empty()) {
+        text << " " << inputs;
+    }
+    if (!order_only.empty()) {
+        text << " || " << order_only;
+    }
+    text << "\n";
+    text << "  cmd = " << EscapeCommand(command) << "\n";
+    if (!description.empty()) {
+        text << "  desc = " << EscapeValue(description) << "\n";
+    }
+    if (console) {
+        text << "  pool = console\n";
+    }
+}
+
+void BuilderNinja::WriteProject(NinjaProject& info, wxString& text)
+{
+    BuildConfigPtr bldConf = info.build_config;
+    CompilerPtr cmp = bldConf->GetCompiler();
+    const StringMap_t& vars = info.variables;
+    const wxString& name = info.project->GetName();
+
+    text << "\n";
+    text << "# Project: " << name << " - " << bldConf->GetName() << "\n";
+
+    wxString preprebuild = bldConf->GetPreBuildCustom();
+    preprebuild.Trim().Trim(false);
+    if (!preprebuild.IsEmpty()) {
+        text << "# The custom makefile rule of the pre-build step is not exported\n";
+    }
+
+    wxString order_only = GetOrderOnlyDeps(info);
+    if (HasPrebuildCommands(bldConf)) {
+        BuildCommandList cmds;
+        bldConf->GetPreBuildCommands(cmds);
+        for (BuildCommand& cmd : cmds) {
+            cmd.SetCommand(MacroManager::Instance()->Expand(cmd.GetCommand(), clGetManager(), name, bldConf->GetName()));
+        }
+
+        wxString stamp = GetBuildDir() + "/" + info.rule_prefix + ".prebuild";
+        WriteRunEdge(stamp, WrapCommand(info.project_path, ExpandMakeVariables(JoinCommands(cmds), vars)),
+                     "Executing Pre Build commands of " + name, wxEmptyString, order_only, false, text);
+        order_only = EscapePath(stamp);
+    }
+
+    // PreCompiled Header
+    wxString pch_output;
+    wxString pch = bldConf->GetPrecompiledHeader();
+    pch.Trim().Trim(false);
+    if (!pch.IsEmpty() && bldConf->GetPCHFlagsPolicy() != BuildConfig::kPCHJustInclude) {
+        wxString line;
+        line << DoGetCompilerMacro(pch) << " $(SourceSwitch) " << Placeholder("in") << " $(PCHCompileFlags)";
+        if (bldConf->GetPCHFlagsPolicy() == BuildConfig::kPCHPolicyAppend) {
+            line << " $(CXXFLAGS) $(IncludePath)";
+        }
+        wxString command = ExpandMakeVariables(line, vars);
+        eDepsFormat deps = AppendDependenciesFlags(cmp, command);
+
+        wxString rule = info.rule_prefix + "_pch";
+        WriteRule(rule, WrapCommand(info.project_path, command), deps, false, text);
+        info.rules.Add(rule);
+
+        pch_output = MakeAbsolutePath(pch + ".gch", info.project_path);
+        text << "build " << EscapePath(pch_output) << ": " << rule << " "
+             << EscapePath(MakeAbsolutePath(pch, info.project_path));
+        if (!order_only.empty()) {
+            text << " || " << order_only;
+        }
+        text << "\n";
+    }
+
+    // the files are sorted so the content of the file does not change between two exports
+    std::vector<wxString> files;
+    files.reserve(info.project->GetFiles().size());
+    for (const auto& vt : info.project->GetFiles()) {
+        if (!vt.second->IsExcludeFromConfiguration(bldConf->GetName())) {
+            files.push_back(vt.second->GetFilename());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    // a rule per file extension, and whether it uses the per-file variables
+    std::unordered_map<wxString, std::pair<wxString, bool>> rules;
+    wxArrayString objects;
+    Compiler::CmpFileTypeInfo ft;
+    for (const wxString& file : files) {
+        wxFileName fn(file);
+        if (!cmp->GetCmpFileType(fn.GetExt().Lower(), ft)) {
+            continue;
+        }
+
+        bool is_resource = IsResourceFile(ft);
+        if (is_resource && !HandleResourceFiles()) {
+            continue;
+        }
+
+        auto iter = rules.find(fn.GetExt());
+        if (iter == rules.end()) {
+            wxString line = ft.compilation_line;
+            line.Replace("\\", "/");
+            line.Replace("\"$(FileFullPath)\"", Placeholder("in"));
+            line.Replace("$(FileFullPath)", Placeholder("in"));
+            line.Replace("$(IntermediateDirectory)/$(ObjectName)$(ObjectSuffix)", Placeholder("out"));
+
+            bool uses_file_variables = false;
+            for (const auto& variable : kFileVariables) {
+                if (line.Replace(variable.first, Placeholder(variable.second))) {
+                    uses_file_variables = true;
+                }
+            }
+
+            eDepsFormat deps = kDepsNone;
+            if (ft.kind == Compiler::CmpFileKindSource) {
+                if (FileExtManager::GetType(fn.GetFullName()) != FileExtManager::TypeSourceC) {
+                    // Add the PCH include line
+                    line.Replace("$(CXX)", "$(CXX) $(IncludePCH)");
+                }
+            }
+
+            wxString command = ExpandMakeVariables(line, vars);
+            if (ft.kind == Compiler::CmpFileKindSource) {
+                deps = AppendDependenciesFlags(cmp, command);
+            }
+
+            wxString rule = info.rule_prefix + "_" + ToIdentifier(fn.GetExt());
+            WriteRule(rule, WrapCommand(info.project_path, command), deps, false, text);
+            info.rules.Add(rule);
+            iter = rules.insert({ fn.GetExt(), { rule, uses_file_variables } }).first;
+        }
+
+        wxString object_name = DoGetTargetPrefix(fn, info.project_path, cmp) + fn.GetFullName();
+        wxString object = info.intermediate_dir + "/" + object_name + cmp->GetObjectSuffix();
+        objects.Add(object);
+
+        text << "build " << EscapePath(object) << ": " << iter->second.first << " " << EscapePath(file);
+        if (!pch_output.empty() && !is_resource) {
+            text << " | " << EscapePath(pch_output);
+        }
+        if (!order_only.empty()) {
+            text << " || " << order_only;
+        }
+        text << "\n";
+
+        if (iter->second.second) {
+            wxFileName rel_path(fn);
+            rel_path.MakeRelativeTo(info.project_path);
+            text << "  file_name = " << EscapeValue(fn.GetName()) << "\n";
+            text << "  file_full_name = " << EscapeValue(fn.GetFullName()) << "\n";
+            text << "  file_path = " << EscapeValue(rel_path.GetPath(true, wxPATH_UNIX)) << "\n";
+            text << "  object_name = " << EscapeValue(object_name) << "\n";
+        }
+    }
+
+    wxString final_outputs;
+    if (!info.output.empty()) {
+        wxString type = info.project->GetSettings() ? info.project->GetSettings()->GetProjectType(bldConf->GetName())
+                                                    : bldConf->GetProjectType();
+        wxString line = cmp->GetLinkLine(type, cmp->GetReadObjectFilesFromList());
+        bool rspfile = line.Contains("$(ObjectsFileList)");
+        line.Replace("$(ObjectsFileList)", Placeholder("out") + ".rsp");
+        line.Replace("$(Objects)", Placeholder("in"));
+        line.Replace("$(OutputFile)", Placeholder("out"));
+
+        wxString rule = info.rule_prefix + "_link";
+        WriteRule(rule, WrapCommand(info.project_path, ExpandMakeVariables(line, vars)), kDepsNone, rspfile, text);
+        info.rules.Add(rule);
+
+        text << "build " << EscapePath(info.output) << ": " << rule;
+        for (const wxString& object : objects) {
+            text << " $\n    " << EscapePath(object);
+        }
+
+        // relink when a library built by a dependency changes
+        wxString implicit;
+        for (const wxString& dep : info.dependencies) {
+            const NinjaProject& dep_info = m_projects.find(dep)->second;
+            if (dep_info.is_library && !dep_info.output.empty()) {
+                implicit << " " << EscapePath(dep_info.output);
+            }
+        }
+        if (!implicit.empty()) {
+            text << " |" << implicit;
+        }
+        if (!order_only.empty()) {
+            text << " || " << order_only;
+        }
+        text << "\n";
+        final_outputs = EscapePath(info.output);
+
+    } else {
+        for (const wxString& object : objects) {
+            final_outputs << (final_outputs.empty() ? "" : " ") << EscapePath(object);
+        }
+    }
+
+    if (HasPostbuildCommands(bldConf)) {
+        BuildCommandList cmds;
+        bldConf->GetPostBuildCommands(cmds);
+
+        wxString stamp = GetBuildDir() + "/" + info.rule_prefix + ".postbuild";
+        WriteRunEdge(stamp, WrapCommand(info.project_path, ExpandMakeVariables(JoinCommands(cmds), vars)),
+                     "Executing Post Build commands of " + name, final_outputs, wxEmptyString, false, text);
+        final_outputs = EscapePath(stamp);
+    }
+
+    text << "build " << GetTargetName(info) << ": phony";
+    if (!final_outputs.empty()) {
+        text << " " << final_outputs;
+    }
+    text << "\n";
+}
+
+void BuilderNinja::WriteExternalProject(NinjaProject& info, bool force, wxString& text)
+{
+    BuildConfigPtr bldConf = info.build_config;
+    const wxString& name = info.project->GetName();
+    wxString workspace_path = clCxxWorkspaceST::Get()->GetWorkspaceFileName().GetPath();
+
+    text << "\n";
+    text << "# Project: " << name << " - " << bldConf->GetName() << "\n";
+
+    wxString command;
+    if (info.is_plugin_makefile) {
+        if (force) {
+            SendBuildEvent(wxEVT_PLUGIN_EXPORT_MAKEFILE, name, bldConf->GetName());
+        }
+
+        // ninja builds the dependencies
+        clBuildEvent build_event(wxEVT_GET_PROJECT_BUILD_CMD);
+        build_event.SetProjectName(name);
+        build_event.SetConfigurationName(bldConf->GetName());
+        build_event.SetProjectOnly(true);
+        EventNotifier::Get()->ProcessEvent(build_event);
+        command = WrapCommand(workspace_path, build_event.GetCommand());
+
+        clBuildEvent clean_event(wxEVT_GET_PROJECT_CLEAN_CMD);
+        clean_event.SetProjectName(name);
+        clean_event.SetConfigurationName(bldConf->GetName());
+        clean_event.SetProjectOnly(true);
+        EventNotifier::Get()->ProcessEvent(clean_event);
+        if (!clean_event.GetCommand().IsEmpty()) {
+            info.clean_command = WrapCommand(workspace_path, clean_event.GetCommand());
+        }
+
+    } else {
+        wxString customWd = bldConf->GetCustomBuildWorkingDir();
+        wxString build_cmd = bldConf->GetCustomBuildCmd();
+        wxString clean_cmd = bldConf->GetCustomCleanCmd();
+
+        customWd = ExpandAllVariables(customWd, clCxxWorkspaceST::Get(), name, bldConf->GetName(), wxEmptyString);
+        build_cmd = ExpandAllVariables(build_cmd, clCxxWorkspaceST::Get(), name, bldConf->GetName(), wxEmptyString);
+        clean_cmd = ExpandAllVariables(clean_cmd, clCxxWorkspaceST::Get(), name, bldConf->GetName(), wxEmptyString);
+
+        customWd.Trim().Trim(false);
+        build_cmd.Trim().Trim(false);
+        clean_cmd.Trim().Trim(false);
+
+        // if a working directory is provided apply it, otherwise use the project path
+        wxString wd = customWd.empty() ? info.project_path : ExpandVariables(customWd, info.project, NULL);
+        if (build_cmd.empty()) {
+            build_cmd << "echo Project has no custom build command!";
+        }
+
+        BuildCommandList cmds;
+        wxString pre_build, post_build;
+        bldConf->GetPreBuildCommands(cmds);
+        pre_build = JoinCommands(cmds);
+        bldConf->GetPostBuildCommands(cmds);
+        post_build = JoinCommands(cmds);
+
+        wxString steps;
+        steps << (pre_build.empty() ? "" : pre_build + " && ") << build_cmd
+              << (post_build.empty() ? "" : " && " + post_build);
+        command = WrapCommand(wd, steps);
+
+        if (!clean_cmd.empty()) {
+            info.clean_command = WrapCommand(wd, clean_cmd);
+        }
+    }
+
+    // the command runs its own build tool: give it the terminal and the whole machine
+    wxString stamp = GetBuildDir() + "/" + info.rule_prefix + ".custom";
+    WriteRunEdge(stamp, command, wxEmptyString, wxEmptyString, GetOrderOnlyDeps(info), true, text);
+    text << "build " << GetTargetName(info) << ": phony " << EscapePath(stamp) << "\n";
+}
+
+bool BuilderNinja::Export(const wxString& project, const wxString& confToBuild, const wxString& arguments,
+                          bool isProjectOnly, bool force, wxString& errMsg)
+{
+    // the file always covers the whole workspace
+    wxUnusedVar(arguments);
+    wxUnusedVar(isProjectOnly);
+
+    if (project.IsEmpty()) {
+        return false;
+    }
+    ProjectPtr proj = clCxxWorkspaceST::Get()->FindProjectByName(project, errMsg);
+    if (!proj) {
+        errMsg << _("Cant open project '") << project << "'";
+        return false;
+    }
+    if (!clCxxWorkspaceST::Get()->GetSelectedConfig()) {
+        errMsg << _("The workspace has no build configuration selected");
+        return false;
+    }
+
+    // the previous file, and the projects read to generate it, are kept as long as none of the inputs changed
+    size_t inputs = GetExportInputsHash(project, confToBuild);
+    if (!force && inputs == m_exportedInputs && IsWrittenFileUpToDate(GetNinjaFile(), inputs)) {
+        clDEBUG() << "build.ninja is up to date" << endl;
+        return true;
+    }
+    m_exportedInputs = 0;
+
+    clDEBUG() << "Generating build.ninja..." << endl;
+    CollectProjects(project, confToBuild);
+    if (m_projects.count(project) == 0) {
+        errMsg << _("Cant find proper compiler for project '") << project << "'";
+        return false;
+    }
+
+    wxString text;
+    text << "# Auto generated by CodeLite IDE, any manual changes will be erased\n";
+    text << "ninja_required_version = 1.5\n";
+    text << "builddir = " << EscapeValue(GetBuildDir()) << "\n";
+    text << "\n";
+    text << "rule run\n";
+    text << "  command = $cmd\n";
+    text << "  description = $desc\n";
+
+    for (auto& vt : m_projects) {
+        if (vt.second.is_custom_build || vt.second.is_plugin_makefile) {
+            WriteExternalProject(vt.second, force, text);
+        } else {
+            WriteProject(vt.second, text);
+        }
+    }
+
+    text << "\n";
+    text << "default";
+    for (const auto& vt : m_projects) {
+        text << " " << GetTargetName(vt.second);
+    }
+    text << "\n";
+
+    // keep the file untouched when the workspace did not change
+    if (!WriteFileIfChanged(GetNinjaFile(), text, inputs)) {
+        errMsg << _("Failed to write file: ") << GetNinjaFile();
+        return false;
+    }
+    m_exportedInputs = inputs;
+    clDEBUG() << "Generating build.ninja...is completed" << endl;
+    return true;
+}
+
+wxArrayString BuilderNinja::GetDependencyClosure(const wxString& project) const
+{
+    // the dependencies first, the project last
+    wxArrayString closure;
+    std::unordered_set<wxString> visited;
+    std::function<void(const wxString&)> visit = [&](const wxString& name) {
+        auto iter = m_projects.find(name);
+        if (iter == m_projects.end() || !visited.insert(name).second) {
+            return;
+        }
+        for (const wxString& dep : iter->second.dependencies) {
+            visit(dep);
+        }
+        closure.Add(name);
+    };
+    visit(project);
+    return closure;
+}
+
+wxString BuilderNinja::GetCleanProjectsCommand(const wxArrayString& projects)
+{
+    wxString rules;
+    wxString command;
+    for (const wxString& name : projects) {
+        auto iter = m_projects.find(name);
+        if (iter == m_projects.end()) {
+            continue;
+        }
+        for (const wxString& rule : iter->second.rules) {
+            rules << " " << rule;
+        }
+        if (!iter->second.clean_command.empty()) {
+            command << (command.empty() ? "" : " && ") << iter->second.clean_command;
+        }
+    }
+
+    // remove the files built by the rules of the projects
+    if (!rules.empty()) {
+        wxString clean = GetNinjaCommand("-t clean -r" + rules);
+        command = command.empty() ? clean : clean + " && " + command;
+    }
+    return command;
+}
+
+wxString BuilderNinja::GetBuildCommand(const wxString& project, const wxString& confToBuild,
+                                       const wxString& arguments)
+{
+    wxString errMsg;
+    if (!Export(project, confToBuild, arguments, false, false, errMsg)) {
+        return wxEmptyString;
+    }
+    return GetNinjaCommand(StringUtils::WrapWithDoubleQuotes(project));
+}
+
+wxString BuilderNinja::GetCleanCommand(const wxString& project, const wxString& confToBuild,
+                                       const wxString& arguments)
+{
+    wxString errMsg;
+    if (!Export(project, confToBuild, arguments, false, false, errMsg)) {
+        return wxEmptyString;
+    }
+    return GetCleanProjectsCommand(GetDependencyClosure(project));
+}
+
+wxString BuilderNinja::GetPOBuildCommand(const wxString& project, const wxString& confToBuild,
+                                         const wxString& arguments)
+{
+    wxString errMsg;
+    if (!Export(project, confToBuild, arguments, true, false, errMsg)) {
+        return wxEmptyString;
+    }
+    return GetNinjaCommand(StringUtils::WrapWithDoubleQuotes(project));
+}
+
+wxString BuilderNinja::GetPOCleanCommand(const wxString& project, const wxString& confToBuild,
+                                         const wxString& arguments)
+{
+    wxString errMsg;
+    if (!Export(project, confToBuild, arguments, true, false, errMsg)) {
+        return wxEmptyString;
+    }
+
+    wxArrayString projects;
+    projects.Add(project);
+    return GetCleanProjectsCommand(projects);
+}
+
+wxString BuilderNinja::GetPORebuildCommand(const wxString& project, const wxString& confToBuild,
+                                           const wxString& arguments)
+{
+    wxString clean = GetPOCleanCommand(project, confToBuild, arguments);
+    wxString build = GetNinjaCommand(StringUtils::WrapWithDoubleQuotes(project));
+    return clean.empty() ? build : clean + " && " + build;
+}
+
+wxString BuilderNinja::GetSingleFileCmd(const wxString& project, const wxString& confToBuild,
+                                        const wxString& arguments, const wxString& fileName)
+{
+    wxString errMsg;
+    if (!Export(project, confToBuild, arguments, true, false, errMsg)) {
+        return wxEmptyString;
+    }
+
+    auto iter = m_projects.find(project);
+    if (iter == m_projects.end() || iter->second.intermediate_dir.empty()) {
+        return wxEmptyString;
+    }
+    const NinjaProject& info = iter->second;
+
+    wxFileName fn(fileName);
+    if (FileExtManager::GetType(fileName) == FileExtManager::TypeHeader) {
+        // Attempting to build a header file, try to see if we got an implementation file instead
+        std::vector<wxString> implExtensions = { "cpp", "cxx", "cc", "c++", "c", fn.GetExt() };
+        for (const wxString& ext : implExtensions) {
+            fn.SetExt(ext);
+            if (fn.FileExists()) {
+                break;
+            }
+        }
+    }
+
+    CompilerPtr cmp = info.build_config->GetCompiler();
+    wxString object;
+    object << info.intermediate_dir << "/" << DoGetTargetPrefix(fn, info.project_path, cmp) << fn.GetFullName()
+           << cmp->GetObjectSuffix();
+    return GetNinjaCommand(StringUtils::WrapWithDoubleQuotes(object));
+}
+
+wxString BuilderNinja::GetPreprocessFileCmd(const wxString& project, const wxString& confToBuild,
+                                            const wxString& arguments, const wxString& fileName, wxString& errMsg)
+{
+    wxUnusedVar(project);
+    wxUnusedVar(confToBuild);
+    wxUnusedVar(arguments);
+    wxUnusedVar(fileName);
+    errMsg << _("Preprocessing a single file is not supported by the Ninja generator");
+    return wxEmptyString;
+}
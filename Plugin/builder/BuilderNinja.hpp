@@ -0,0 +1,106 @@
+#ifndef BUILDERNINJA_HPP
+#define BUILDERNINJA_HPP
+
+#include "builder_gnumake_default.h"
+
+#include <map>
+#include <unordered_map>
+#include <wx/arrstr.h>
+
+/// Build the workspace with a generated Ninja file.
+///
+/// A single `build.ninja` is written in the workspace folder for the selected workspace configuration. It holds one
+/// build edge per object file and per linked project, all paths absolute, so ninja sees the complete dependency graph
+/// of the workspace and schedules every compilation of every project against one job limit. The compiler and linker
+/// lines, and the variables they use, are the ones of the generated makefiles: the make variables are expanded when
+/// the file is generated. Header dependencies are read by ninja from the compiler (`-MMD`) into its own log, which
+/// keeps up-to-date builds fast. The file is only generated again when its inputs changed.
+///
+/// Since ninja builds a target together with everything it depends on, the "project only" commands also bring the
+/// dependencies of the project up to date
+class WXDLLIMPEXP_SDK BuilderNinja : public BuilderGnuMake
+{
+public:
+    typedef std::unordered_map<wxString, wxString> StringMap_t;
+
+protected:
+    struct NinjaProject {
+        ProjectPtr project;
+        BuildConfigPtr build_config;
+        wxString rule_prefix;
+        /// absolute paths
+        wxString project_path;
+        wxString intermediate_dir;
+        /// the linked file, empty if the project is not linked
+        wxString output;
+        bool is_library = false;
+        /// for custom builds and plugin generated makefiles, ninja only runs the build command of the project
+        bool is_custom_build = false;
+        bool is_plugin_makefile = false;
+        wxString clean_command;
+        StringMap_t variables;
+        wxArrayString rules;
+        wxArrayString dependencies;
+    };
+
+    std::map<wxString, NinjaProject> m_projects;
+    wxString m_ninjaExe;
+    /// the hash of the inputs of the last export, see GetExportInputsHash(). 0 if m_projects does not match the file
+    size_t m_exportedInputs = 0;
+
+public:
+    BuilderNinja();
+    virtual ~BuilderNinja();
+
+    bool IsWorkspaceBuilder() const override { return true; }
+
+    bool Export(const wxString& project, const wxString& confToBuild, const wxString& arguments, bool isProjectOnly,
+                bool force, wxString& errMsg) override;
+    wxString GetBuildCommand(const wxString& project, const wxString& confToBuild, const wxString& arguments) override;
+    wxString GetCleanCommand(const wxString& project, const wxString& confToBuild, const wxString& arguments) override;
+    wxString GetPOBuildCommand(const wxString& project, const wxString& confToBuild,
+                               const wxString& arguments) override;
+    wxString GetPOCleanCommand(const wxString& project, const wxString& confToBuild,
+                               const wxString& arguments) override;
+    wxString GetSingleFileCmd(const wxString& project, const wxString& confToBuild, const wxString& arguments,
+                              const wxString& fileName) override;
+    wxString GetPreprocessFileCmd(const wxString& project, const wxString& confToBuild, const wxString& arguments,
+                                  const wxString& fileName, wxString& errMsg) override;
+    wxString GetPORebuildCommand(const wxString& project, const wxString& confToBuild,
+                                 const wxString& arguments) override;
+
+    /**
+     * @brief expand the make variables `$(Name)` of `str` from `vars`, falling back to the environment. `$$` is
+     * unescaped and `$(shell cmd)` is turned into a backtick command substitution
+     */
+    static wxString ExpandMakeVariables(const wxString& str, const StringMap_t& vars);
+
+    /**
+     * @brief escape `path` for the inputs and outputs of a ninja build statement
+     */
+    static wxString EscapePath(const wxString& path);
+
+protected:
+    wxString GetNinjaFile() const;
+    wxString GetNinjaCommand(const wxString& args);
+    wxString GetBuildDir() const;
+
+    /**
+     * @brief hash the inputs of build.ninja without generating it: the projects, their selected configurations and
+     * environment variables, and the compilers
+     */
+    size_t GetExportInputsHash(const wxString& project, const wxString& confToBuild) const;
+    void CollectProjects(const wxString& project, const wxString& confToBuild);
+    StringMap_t GetProjectVariables(ProjectPtr proj, BuildConfigPtr bldConf);
+    void WriteProject(NinjaProject& info, wxString& text);
+    void WriteExternalProject(NinjaProject& info, bool force, wxString& text);
+    void WriteRunEdge(const wxString& output, const wxString& command, const wxString& description,
+                      const wxString& inputs, const wxString& order_only, bool console, wxString& text);
+    wxString WrapCommand(const wxString& dir, const wxString& command) const;
+    wxString GetOrderOnlyDeps(const NinjaProject& info) const;
+    wxString GetTargetName(const NinjaProject& info) const;
+    wxArrayString GetDependencyClosure(const wxString& project) const;
+    wxString GetCleanProjectsCommand(const wxArrayString& projects);
+};
+
+#endif // BUILDERNINJA_HPP
@@ -80,6 +80,12 @@ public:
      */
     virtual bool IsActive() const { return m_isActive; }
 
+    /**
+     * @brief return true if the build commands of this builder all drive the same build of the entire workspace, in
+     * which case only one of them can run at a time
+     */
+    virtual bool IsWorkspaceBuilder() const { return false; }
+
     // ================ API ==========================
     // The below API must be implemented by the
     // derived class
@@ -36,6 +36,7 @@
 #include "event_notifier.h"
 #include "file_logger.h"
 #include "fileextmanager.h"
+#include "fileutils.h"
 #include "globals.h"
 #include "macromanager.h"
 #include "macros.h"
@@ -47,6 +48,7 @@
 #include <wx/sstream.h>
 #include <wx/stopwatch.h>
 #include <wx/tokenzr.h>
+#include <wx/xml/xml.h>
 
 BuilderGnuMake::BuilderGnuMake()
     : Builder("CodeLite Makefile Generator")
@@ -465,10 +467,11 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
         text << "\t" << GetCdCmd(wspfile, projectPath) << buildTool << " \"" << proj->GetName() << ".mk\" clean\n";
     }
 
-    // dump the content to file
-    wxFileOutputStream output("Makefile");
-    wxStringInputStream content(text);
-    output << content;
+    // dump the content to file, if it changed
+    if(!WriteFileIfChanged("Makefile", text)) {
+        errMsg << _("Failed to write file: ") << "Makefile";
+        return false;
+    }
 
     clDEBUG() << "Generating Makefile...is completed" << endl;
     return true;
@@ -516,13 +519,15 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString& confToBui
     wxString fn(path);
     fn << PATH_SEP << proj->GetName() << ".mk";
 
-    // skip the next test if the makefile does not exist
-    if(wxFileName::FileExists(fn)) {
-        if(!force) {
-            if(proj->IsModified() == false) {
-                return;
-            }
-        }
+    EnvVarList vars;
+    EnvironmentConfig::Instance()->ReadObject("Variables", &vars);
+    EnvMap varMap = vars.GetVariables("", true, proj->GetName(), bldConf->GetName());
+
+    // The project "modified" flag tracks the changes of the project settings and files, the hash the other inputs.
+    // When any of them changed, the makefile is generated in memory and only written if its content changed
+    size_t inputs = GetMakefileInputsHash(bldConf, confToBuild, depsProj, varMap);
+    if(!force && !proj->IsModified() && IsWrittenFileUpToDate(fn, inputs)) {
+        return;
     }
 
     // Load the current project files
@@ -550,10 +555,6 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString& confToBui
     // so user will be able to override any of the default
     // variables by defining its own
     //----------------------------------------------------------
-    EnvVarList vars;
-    EnvironmentConfig::Instance()->ReadObject("Variables", &vars);
-    EnvMap varMap = vars.GetVariables("", true, proj->GetName(), bldConf->GetName());
-
     text << "##"
          << "\n";
     text << "## User defined environment variables"
@@ -597,12 +598,9 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString& confToBui
     CreateFileTargets(proj, confToBuild, text);
     CreateCleanTargets(proj, confToBuild, text);
 
-    // dump the content to a file
-    wxFFile output;
-    output.Open(fn, "w+");
-    if(output.IsOpened()) {
-        output.Write(text);
-        output.Close();
+    // dump the content to a file, if it changed
+    if(!WriteFileIfChanged(fn, text, inputs)) {
+        clWARNING() << "Failed to write makefile:" << fn << endl;
     }
 
     // mark the project as non-modified one
@@ -1869,6 +1867,97 @@ bool BuilderGnuMake::SendBuildEvent(int eventId, const wxString& projectName, co
     return EventNotifier::Get()->ProcessEvent(e);
 }
 
+namespace
+{
+/// the content of a generated file without the lines that change on every generation (the date and the user):
+/// a file that only differs by these lines is not rewritten
+wxString StripVolatileLines(const wxString& content)
+{
+    wxString stripped;
+    stripped.reserve(content.length());
+    size_t start = 0;
+    while(start < content.length()) {
+        size_t end = content.find('\n', start);
+        end = (end == wxString::npos) ? content.length() : end + 1;
+        wxString line = content.Mid(start, end - start);
+        if(!line.StartsWith("Date ") && !line.StartsWith("User ")) {
+            stripped << line;
+        }
+        start = end;
+    }
+    return stripped;
+}
+} // namespace
+
+bool BuilderGnuMake::WriteFileIfChanged(const wxString& path, const wxString& content, size_t inputs)
+{
+    wxFileName fn(path);
+    fn.MakeAbsolute();
+    wxString fullpath = fn.GetFullPath();
+    wxString stripped = StripVolatileLines(content);
+    size_t hash = std::hash<wxString>{}(stripped);
+
+    // the recorded hash is trusted as long as nobody else modified the file, otherwise compare the content
+    time_t modified = FileUtils::GetFileModificationTime(fn);
+    if(modified != 0) {
+        auto iter = m_writtenFiles.find(fullpath);
+        if(iter != m_writtenFiles.end() && iter->second.modified == modified) {
+            if(iter->second.hash == hash) {
+                iter->second.inputs = inputs;
+                return true;
+            }
+        } else {
+            wxString current;
+            if(FileUtils::ReadFileContent(fn, current) && StripVolatileLines(current) == stripped) {
+                m_writtenFiles[fullpath] = { hash, modified, inputs };
+                return true;
+            }
+        }
+    }
+
+    // write through a temporary file, so make never reads a partially written file
+    wxString tmpfile = fullpath + ".tmp";
+    if(!FileUtils::WriteFileContent(tmpfile, content) || !::wxRenameFile(tmpfile, fullpath, true)) {
+        m_writtenFiles.erase(fullpath);
+        return false;
+    }
+    m_writtenFiles[fullpath] = { hash, FileUtils::GetFileModificationTime(fn), inputs };
+    return true;
+}
+
+bool BuilderGnuMake::IsWrittenFileUpToDate(const wxString& path, size_t inputs) const
+{
+    wxFileName fn(path);
+    fn.MakeAbsolute();
+    auto iter = m_writtenFiles.find(fn.GetFullPath());
+    if(iter == m_writtenFiles.end() || iter->second.inputs != inputs) {
+        return false;
+    }
+    time_t modified = FileUtils::GetFileModificationTime(fn);
+    return modified != 0 && modified == iter->second.modified;
+}
+
+size_t BuilderGnuMake::GetMakefileInputsHash(BuildConfigPtr bldConf, const wxString& confToBuild,
+                                             const wxArrayString& depsProj, EnvMap& varMap) const
+{
+    wxString inputs;
+    WorkspaceConfigurationPtr workspaceConf = clCxxWorkspaceST::Get()->GetSelectedConfig();
+    inputs << confToBuild << "\n" << (workspaceConf ? workspaceConf->GetName() : wxString()) << "\n";
+    inputs << ::wxJoin(depsProj, ';') << "\n" << varMap.String() << "\n";
+
+    // the compiler tools, switches and file types
+    CompilerPtr cmp = bldConf->GetCompiler();
+    if(cmp) {
+        wxXmlDocument doc;
+        doc.SetRoot(cmp->ToXml());
+        wxString xml;
+        wxStringOutputStream sos(&xml);
+        doc.Save(sos);
+        inputs << xml;
+    }
+    return std::hash<wxString>{}(inputs);
+}
+
 bool BuilderGnuMake::HandleResourceFiles() const { return m_isMSYSEnv || m_isWindows; }
 
 bool BuilderGnuMake::IsResourceFile(const Compiler::CmpFileTypeInfo& file_type) const
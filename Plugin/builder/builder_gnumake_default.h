@@ -27,9 +27,11 @@
 
 #include "builder.h"
 #include "codelite_exports.h"
+#include "envvarlist.h"
 #include "project.h"
 #include "workspace.h"
 
+#include <unordered_map>
 #include <wx/txtstrm.h>
 #include <wx/wfstream.h>
 /*
@@ -44,6 +46,15 @@ protected:
     bool m_isWindows = false;
     bool m_isMSYSEnv = false;
 
+    struct WrittenFile {
+        size_t hash = 0;
+        time_t modified = 0;
+        /// the hash of the inputs the project "modified" flag does not track (see GetMakefileInputsHash())
+        size_t inputs = 0;
+    };
+    /// the generated files, by full path
+    std::unordered_map<wxString, WrittenFile> m_writtenFiles;
+
 protected:
     enum eBuildFlags {
         kCleanOnly = (1 << 0),
@@ -92,9 +103,33 @@ protected:
     bool HandleResourceFiles() const;
     bool IsResourceFile(const Compiler::CmpFileTypeInfo& file_type) const;
 
+    /**
+     * @brief write a generated file, unless it already holds `content`: keeping the file untouched keeps the
+     * timestamps make relies on. Return false if the file could not be written
+     */
+    bool WriteFileIfChanged(const wxString& path, const wxString& content, size_t inputs = 0);
+
+    /**
+     * @brief return true if `path` was written by WriteFileIfChanged() from the same `inputs` and was not modified
+     * since
+     */
+    bool IsWrittenFileUpToDate(const wxString& path, size_t inputs) const;
+
+    /**
+     * @brief hash the inputs of a project makefile that are not part of the project: the workspace configuration,
+     * the dependencies, the environment variables and the compiler
+     */
+    size_t GetMakefileInputsHash(BuildConfigPtr bldConf, const wxString& confToBuild, const wxArrayString& depsProj,
+                                 EnvMap& varMap) const;
+
+    void CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, wxString& text);
+    bool HasPrebuildCommands(BuildConfigPtr bldConf) const;
+    bool HasPostbuildCommands(BuildConfigPtr bldConf) const;
+    wxString DoGetCompilerMacro(const wxString& filename);
+    wxString DoGetTargetPrefix(const wxFileName& filename, const wxString& cwd, CompilerPtr cmp);
+
 private:
     void GenerateMakefile(ProjectPtr proj, const wxString& confToBuild, bool force, const wxArrayString& depsProj);
-    void CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, wxString& text);
     void CreateMakeDirsTarget(const wxString& targetName, wxString& text);
     void CreateTargets(const wxString& type, BuildConfigPtr bldConf, wxString& text, const wxString& projName);
     void CreatePreBuildEvents(ProjectPtr proj, BuildConfigPtr bldConf, wxString& text);
@@ -109,14 +144,10 @@ private:
     wxString ParseLibPath(const wxString& paths, const wxString& projectName, const wxString& selConf);
     wxString ParseLibs(const wxString& libs);
     wxString ParsePreprocessor(const wxString& prep);
-    bool HasPrebuildCommands(BuildConfigPtr bldConf) const;
-    bool HasPostbuildCommands(BuildConfigPtr bldConf) const;
 
     wxString GetProjectMakeCommand(const wxFileName& wspfile, const wxFileName& projectPath, ProjectPtr proj,
                                    const wxString& confToBuild);
     wxString GetProjectMakeCommand(ProjectPtr proj, const wxString& confToBuild, const wxString& target, size_t flags);
-    wxString DoGetCompilerMacro(const wxString& filename);
-    wxString DoGetTargetPrefix(const wxFileName& filename, const wxString& cwd, CompilerPtr cmp);
     wxString GetRelinkMarkerForProject(const wxString& projectName) const;
 };
 #endif // BUILDER_GNUMAKE_DEFAULT_H
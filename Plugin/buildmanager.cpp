@@ -25,6 +25,7 @@
 #include "buildmanager.h"
 
 #include "builder/BuilderGnuMakeMSYS.hpp"
+#include "builder/BuilderNinja.hpp"
 #include "builder/builder.h"
 #include "builder/builder_NMake.h"
 #include "builder/builder_gnumake.h"
@@ -37,6 +38,7 @@ BuildManager::BuildManager()
     AddBuilder(std::make_shared<BuilderGnuMake>());
     AddBuilder(std::make_shared<BuilderGNUMakeClassic>());
     AddBuilder(std::make_shared<BuilderGnuMakeOneStep>());
+    AddBuilder(std::make_shared<BuilderNinja>());
 #ifdef __WXMSW__
     AddBuilder(std::make_shared<BuilderNMake>());
     AddBuilder(std::make_shared<BuilderGnuMakeMSYS>());
@@ -1,58 +1,296 @@
 #include "clBacktickCache.hpp"
 
-#include "fileutils.h"
+#include "AsyncProcess/asyncprocess.h"
+#include "JSON.h"
+#include "environmentconfig.h"
+#include "file_logger.h"
+#include "md5/wxmd5.h"
 
+#include <algorithm>
 #include <wx/filename.h>
-#include <wx/tokenzr.h>
+#include <wx/utils.h>
+
+namespace
+{
+/// the variables of the key besides the ones applied by CodeLite: the ones the usual tools depend on
+const std::vector<wxString> KEY_VARIABLES = {
+    "PATH", "PKG_CONFIG_PATH", "PKG_CONFIG_LIBDIR", "PKG_CONFIG_SYSROOT_DIR", "WXCFG", "WXWIN",
+};
+} // namespace
 
 clBacktickCache::clBacktickCache(const wxString& directory)
 {
-    wxString content;
-    wxFileName fn(directory, "BacktickCache.txt");
+    wxFileName fn(directory, "BacktickCache.json");
     fn.AppendDir(".codelite");
     m_file = fn.GetFullPath();
-    if(fn.FileExists()) {
-        FileUtils::ReadFileContent(fn, content);
-        wxArrayString lines = ::wxStringTokenize(content, "\n", wxTOKEN_STRTOK);
-        for(auto& line : lines) {
-            TrimString(line);
-            wxString command = line.BeforeFirst('=');
-            wxString output = line.AfterFirst('=');
-            TrimString(command);
-            TrimString(output);
-
-            if(command.empty()) {
+    if (!fn.FileExists()) {
+        return;
+    }
+
+    JSON root(fn);
+    if (!root.isOk()) {
+        return;
+    }
+    JSONItem entries = root.toElement().namedObject("entries");
+    int count = entries.arraySize();
+    for (int i = 0; i < count; ++i) {
+        JSONItem item = entries.arrayItem(i);
+        wxString key = item.namedObject("key").toString();
+        if (key.empty()) {
+            continue;
+        }
+        Entry entry;
+        entry.command = item.namedObject("command").toString();
+        entry.output = item.namedObject("output").toString();
+        entry.updated = item.namedObject("updated").toSize_t();
+        entry.valid = true;
+        m_cache.insert({ key, entry });
+    }
+}
+
+clBacktickCache::~clBacktickCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_queue.clear();
+    }
+    m_jobsCond.notify_all();
+    m_doneCond.notify_all();
+    for (std::thread* thr : m_threads) {
+        thr->join();
+        wxDELETE(thr);
+    }
+    m_threads.clear();
+}
+
+void clBacktickCache::Save()
+{
+    JSON root(cJSON_Object);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_modified) {
+            return;
+        }
+        JSONItem entries = JSONItem::createArray("entries");
+        for (const auto& vt : m_cache) {
+            if (!vt.second.valid) {
                 continue;
             }
-            m_cache.insert({ command, output });
+            JSONItem item = JSONItem::createObject();
+            item.addProperty("key", vt.first);
+            item.addProperty("command", vt.second.command);
+            item.addProperty("output", vt.second.output);
+            item.addProperty("updated", (long)vt.second.updated);
+            entries.arrayAppend(item);
         }
+        root.toElement().append(entries);
+        m_modified = false;
     }
+
+    wxFileName fn(m_file);
+    fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+    root.save(fn);
 }
 
-clBacktickCache::~clBacktickCache() {}
+clBacktickCache::Job clBacktickCache::DoCreateJob(const wxString& command, const wxString& workingDirectory) const
+{
+    Job job;
+    job.command = command;
+    job.workingDirectory = workingDirectory;
 
-void clBacktickCache::Save()
+    // the command runs in the whole environment the caller set up (workspace and project variables included)
+    wxEnvVariableHashMap envMap;
+    ::wxGetEnvMap(&envMap);
+    job.env.reserve(envMap.size());
+    for (const auto& vt : envMap) {
+        job.env.push_back({ vt.first, vt.second });
+    }
+    std::sort(job.env.begin(), job.env.end());
+
+    // the key only covers the variables that are the same from one session to the next. It is saved with the results,
+    // hence a digest that does not depend on the build
+    wxArrayString names = EnvironmentConfig::Instance()->GetAppliedEnvNames();
+    names.insert(names.end(), KEY_VARIABLES.begin(), KEY_VARIABLES.end());
+    names.Sort();
+
+    wxString envText;
+    wxString value;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i > 0 && names[i] == names[i - 1]) {
+            continue;
+        }
+        if (::wxGetEnv(names[i], &value)) {
+            envText << names[i] << "=" << value << "\n";
+        }
+    }
+    job.key << command << "\n" << workingDirectory << "\n" << wxMD5::GetDigest(envText);
+    return job;
+}
+
+bool clBacktickCache::DoIsExpired(const Entry& entry) const
+{
+    return !entry.valid || entry.updated == 0 || (time(nullptr) - entry.updated) > m_ttl;
+}
+
+void clBacktickCache::DoSchedule(Job&& job)
+{
+    if (m_shutdown) {
+        return;
+    }
+
+    Entry& entry = m_cache[job.key];
+    if (entry.pending) {
+        return;
+    }
+    entry.pending = true;
+    entry.command = job.command;
+    m_queue.push_back(std::move(job));
+
+    size_t maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    if (m_idleThreads == 0 && m_threads.size() < maxThreads) {
+        m_threads.push_back(new std::thread(&clBacktickCache::WorkerMain, this));
+    }
+    m_jobsCond.notify_one();
+}
+
+void clBacktickCache::DoSetOutput(const wxString& key, const wxString& output)
 {
-    wxString content;
-    for(const auto& vt : m_cache) {
-        content << vt.first << "=" << vt.second << "\n";
+    Entry& entry = m_cache[key];
+    if (!entry.valid || entry.output != output) {
+        m_modified = true;
     }
-    FileUtils::WriteFileContent(m_file, content);
+    entry.output = output;
+    entry.valid = true;
+    entry.pending = false;
+    entry.updated = time(nullptr);
+    m_doneCond.notify_all();
 }
 
-bool clBacktickCache::HasCommand(const wxString& command) const { return m_cache.count(command) != 0; }
+void clBacktickCache::WorkerMain()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        ++m_idleThreads;
+        m_jobsCond.wait(lock, [this]() { return m_shutdown || !m_queue.empty(); });
+        --m_idleThreads;
+        if (m_shutdown) {
+            break;
+        }
 
-void clBacktickCache::SetCommand(const wxString& command, const wxString& expanded)
+        Job job = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+        wxString output = DoRun(job);
+        lock.lock();
+        if (job.generation == m_generation) {
+            DoSetOutput(job.key, output);
+        }
+    }
+}
+
+wxString clBacktickCache::DoRun(const Job& job)
 {
-    m_cache.erase(command);
-    m_cache.insert({ command, expanded });
+    clDEBUG() << "Expanding backtick:" << job.command << "in" << job.workingDirectory << endl;
+    wxString output;
+#ifdef __WXMSW__
+    // the environment is applied to our own process while the child is spawned: one at a time
+    static std::mutex spawnMutex;
+    IProcess::Ptr_t proc;
+    {
+        std::lock_guard<std::mutex> lock(spawnMutex);
+        proc.reset(::CreateSyncProcess(job.command, IProcessCreateDefault, job.workingDirectory, &job.env));
+    }
+#else
+    // pass the environment on the command line of env(1): our own environment is not touched, which is not thread
+    // safe, and the command may use the shell syntax
+    std::vector<wxString> args = { "env", "-i" };
+    for (const auto& var : job.env) {
+        args.push_back(var.first + "=" + var.second);
+    }
+    args.push_back("/bin/sh");
+    args.push_back("-c");
+    args.push_back(job.command);
+    IProcess::Ptr_t proc(
+        ::CreateAsyncProcess(nullptr, args, IProcessCreateDefault | IProcessCreateSync, job.workingDirectory));
+#endif
+    if (proc) {
+        proc->WaitForTerminate(output);
+    }
+    output.Trim().Trim(false);
+    return output;
 }
 
-wxString clBacktickCache::GetExpanded(const wxString& command) const
+void clBacktickCache::Prefetch(const wxString& command, const wxString& workingDirectory)
 {
-    auto iter = m_cache.find(command);
-    if(iter == m_cache.end()) {
-        return "";
+    Job job = DoCreateJob(command, workingDirectory);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job.generation = m_generation;
+    auto iter = m_cache.find(job.key);
+    if (iter == m_cache.end() || DoIsExpired(iter->second)) {
+        DoSchedule(std::move(job));
     }
-    return iter->second;
+}
+
+wxString clBacktickCache::Expand(const wxString& command, const wxString& workingDirectory)
+{
+    Job job = DoCreateJob(command, workingDirectory);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    job.generation = m_generation;
+    auto iter = m_cache.find(job.key);
+    if (iter != m_cache.end() && iter->second.valid) {
+        wxString output = iter->second.output;
+        if (DoIsExpired(iter->second)) {
+            DoSchedule(std::move(job));
+        }
+        return output;
+    }
+
+    if (iter != m_cache.end() && iter->second.pending) {
+        auto queued = std::find_if(m_queue.begin(), m_queue.end(), [&](const Job& j) { return j.key == job.key; });
+        if (queued != m_queue.end()) {
+            // not started yet: run it here instead of waiting for its turn
+            m_queue.erase(queued);
+        } else {
+            m_doneCond.wait(lock, [&]() {
+                auto it = m_cache.find(job.key);
+                return m_shutdown || it == m_cache.end() || !it->second.pending;
+            });
+            iter = m_cache.find(job.key);
+            if (iter != m_cache.end() && iter->second.valid) {
+                return iter->second.output;
+            }
+        }
+    }
+
+    // cold: run the command on this thread, while the other callers wait for it
+    Entry& entry = m_cache[job.key];
+    entry.command = job.command;
+    entry.pending = true;
+    lock.unlock();
+    wxString output = DoRun(job);
+    lock.lock();
+    if (job.generation == m_generation) {
+        DoSetOutput(job.key, output);
+    }
+    return output;
+}
+
+void clBacktickCache::Refresh()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& vt : m_cache) {
+        vt.second.updated = 0;
+    }
+}
+
+void clBacktickCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // the expansions still running were started with the old settings: their results are dropped
+    ++m_generation;
+    m_cache.clear();
+    m_queue.clear();
+    m_modified = true;
+    m_doneCond.notify_all();
 }
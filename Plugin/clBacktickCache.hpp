@@ -1,30 +1,112 @@
 #ifndef CLBACKTICKCACHE_HPP
 #define CLBACKTICKCACHE_HPP
 
+#include "clEnvironment.hpp"
 #include "codelite_exports.h"
 #include "macros.h"
 #include "wxStringHash.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <time.h>
+#include <unordered_map>
+#include <vector>
 #include <wx/sharedptr.h>
 #include <wx/string.h>
 
+/// The outputs of the backtick (and `$(shell ...)`) commands of a workspace, e.g. `pkg-config --cflags gtk+-3.0`.
+///
+/// A result is keyed by the command, the folder it runs in and a digest of the variables CodeLite applied (global,
+/// workspace and project) plus a few well known ones such as PATH. The command runs in the whole environment as it is
+/// when the expansion is requested, but the other variables change from one session to the next (SSH_AUTH_SOCK,
+/// WINDOWID...) and would make the persisted results useless.
+/// The commands run on a small pool of background threads, several at once. Results older than the TTL are still
+/// served, and expanded again in the background. The cache is saved in the `.codelite` folder of the workspace and
+/// reloaded on the next session
 class WXDLLIMPEXP_SDK clBacktickCache
 {
-    wxString m_file;
-    wxStringMap_t m_cache;
-
 public:
     typedef wxSharedPtr<clBacktickCache> ptr_t;
 
+protected:
+    struct Job {
+        wxString key;
+        wxString command;
+        wxString workingDirectory;
+        clEnvList_t env;
+        /// the value of m_generation when the job was scheduled
+        size_t generation = 0;
+    };
+
+    struct Entry {
+        wxString command;
+        wxString output;
+        /// 0 once the result was refreshed
+        time_t updated = 0;
+        /// `output` holds a result of the command
+        bool valid = false;
+        /// the command is queued or running
+        bool pending = false;
+    };
+
+    wxString m_file;
+    time_t m_ttl = 3600;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobsCond;
+    std::condition_variable m_doneCond;
+    std::unordered_map<wxString, Entry> m_cache;
+    std::deque<Job> m_queue;
+    std::vector<std::thread*> m_threads;
+    size_t m_idleThreads = 0;
+    /// incremented by Clear()
+    size_t m_generation = 0;
+    bool m_shutdown = false;
+    bool m_modified = false;
+
+protected:
+    Job DoCreateJob(const wxString& command, const wxString& workingDirectory) const;
+    bool DoIsExpired(const Entry& entry) const;
+    /// call with the lock held
+    void DoSchedule(Job&& job);
+    /// call with the lock held
+    void DoSetOutput(const wxString& key, const wxString& output);
+    void WorkerMain();
+    static wxString DoRun(const Job& job);
+
 public:
     clBacktickCache(const wxString& directory);
     virtual ~clBacktickCache();
 
+    /**
+     * @brief write the cache to the disk, if it was modified
+     */
     void Save();
 
-    bool HasCommand(const wxString& command) const;
-    void SetCommand(const wxString& command, const wxString& expanded);
-    wxString GetExpanded(const wxString& command) const;
+    /**
+     * @brief expand `command` in the background if its result is missing or expired. Does not block
+     */
+    void Prefetch(const wxString& command, const wxString& workingDirectory);
+
+    /**
+     * @brief return the output of `command`. If the cache holds no result, wait for the expansion already running or
+     * run it on the calling thread
+     */
+    wxString Expand(const wxString& command, const wxString& workingDirectory);
+
+    /**
+     * @brief expire all the results: they are served until the background expansions replace them
+     */
+    void Refresh();
+
+    /**
+     * @brief drop all the results, including the ones of the expansions still running
+     */
+    void Clear();
+
+    void SetTTL(time_t seconds) { m_ttl = seconds; }
+    time_t GetTTL() const { return m_ttl; }
 };
 
 #endif // CLBACKTICKCACHE_HPP
@@ -421,6 +421,32 @@ void clControlWithItems::DoUpdateHeader(clRowEntry* row)
     }
 }
 
+void clControlWithItems::DoUpdateHeader(const clRowEntry::Vec_t& rows)
+{
+    if (GetHeader()->empty() || rows.empty()) {
+        return;
+    }
+
+    wxBitmap tmpBmp;
+    tmpBmp.CreateWithDIPSize(1, 1, GetDPIScaleFactor());
+    wxMemoryDC mem_dc{ tmpBmp };
+    wxGCDC dc{ mem_dc };
+    dc.SetFont(GetDefaultFont());
+
+    for (size_t i = 0; i < GetHeader()->size(); ++i) {
+        if (!GetHeader()->Item(i).IsAutoResize()) {
+            continue;
+        }
+        int max_width = 0;
+        for (clRowEntry* row : rows) {
+            if (!row->IsHidden()) {
+                max_width = wxMax(max_width, row->CalcItemWidth(dc, m_lineHeight, i));
+            }
+        }
+        GetHeader()->UpdateColWidthIfNeeded(i, max_width, false);
+    }
+}
+
 wxSize clControlWithItems::GetTextSize(const wxString& label) const
 {
     wxBitmap tmpBmp;
@@ -505,7 +531,7 @@ void clControlWithItems::AssignRects(const clRowEntry::Vec_t& items)
         }
         wxRect itemRect = wxRect(clientRect.GetX(), y, width, m_lineHeight);
         wxRect buttonRect;
-        if (curitem->HasChildren()) {
+        if (curitem->CanExpand()) {
             buttonRect = wxRect(itemRect.x + (curitem->GetIndentsCount() * GetIndent()), y, m_lineHeight, m_lineHeight);
         }
         curitem->SetRects(itemRect, buttonRect);
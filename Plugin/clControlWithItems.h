@@ -102,6 +102,10 @@ protected:
     void AssignRects(const clRowEntry::Vec_t& items);
     void OnSize(wxSizeEvent& event);
     void DoUpdateHeader(clRowEntry* row);
+    /**
+     * @brief update the header to fit a list of rows, measuring them with the same DC
+     */
+    void DoUpdateHeader(const clRowEntry::Vec_t& rows);
     wxSize GetTextSize(const wxString& label) const;
     virtual void OnMouseScroll(wxMouseEvent& event);
     virtual bool DoKeyDown(const wxKeyEvent& event);
@@ -0,0 +1,278 @@
+#include "clCxxWorkspaceSnapshot.hpp"
+
+#include "file_logger.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/xml/xml.h>
+
+// Layout (native byte order):
+//  header : magic, uint32 version, uint32 count
+//  entry  : string path, uint64 size, int64 mtime, uint64 tree length, tree
+//  tree   : uint8 node type, string name, string content, uint32 attributes count, (string name, string value)...,
+//           uint32 children count, tree...
+//  string : uint32 length, UTF-8 bytes
+#define SNAPSHOT_MAGIC "CLWSNAP"
+#define SNAPSHOT_VERSION 1
+
+namespace
+{
+class Reader
+{
+    const char* m_p;
+    const char* m_end;
+
+public:
+    Reader(const char* p, size_t len)
+        : m_p(p)
+        , m_end(p + len)
+    {
+    }
+
+    const char* GetPos() const { return m_p; }
+
+    bool Read(void* dst, size_t len)
+    {
+        if((size_t)(m_end - m_p) < len) {
+            return false;
+        }
+        memcpy(dst, m_p, len);
+        m_p += len;
+        return true;
+    }
+
+    bool Skip(size_t len)
+    {
+        if((size_t)(m_end - m_p) < len) {
+            return false;
+        }
+        m_p += len;
+        return true;
+    }
+
+    bool ReadString(wxString& str)
+    {
+        uint32_t len = 0;
+        if(!Read(&len, sizeof(len)) || (size_t)(m_end - m_p) < len) {
+            return false;
+        }
+        str = wxString::FromUTF8(m_p, len);
+        m_p += len;
+        return true;
+    }
+
+    wxXmlNode* ReadTree()
+    {
+        uint8_t type = 0;
+        wxString name, content;
+        if(!Read(&type, sizeof(type)) || !ReadString(name) || !ReadString(content)) {
+            return nullptr;
+        }
+
+        wxXmlNode* node = new wxXmlNode(nullptr, (wxXmlNodeType)type, name, content);
+        uint32_t count = 0;
+        if(!Read(&count, sizeof(count))) {
+            delete node;
+            return nullptr;
+        }
+        wxXmlAttribute* lastAttr = nullptr;
+        for(uint32_t i = 0; i < count; ++i) {
+            wxString attrName, attrValue;
+            if(!ReadString(attrName) || !ReadString(attrValue)) {
+                delete node;
+                return nullptr;
+            }
+            wxXmlAttribute* attr = new wxXmlAttribute(attrName, attrValue);
+            if(lastAttr) {
+                lastAttr->SetNext(attr);
+            } else {
+                node->SetAttributes(attr);
+            }
+            lastAttr = attr;
+        }
+
+        if(!Read(&count, sizeof(count))) {
+            delete node;
+            return nullptr;
+        }
+        // link the children directly: AddChild() walks the whole list of children on every call
+        wxXmlNode* lastChild = nullptr;
+        for(uint32_t i = 0; i < count; ++i) {
+            wxXmlNode* child = ReadTree();
+            if(!child) {
+                delete node;
+                return nullptr;
+            }
+            child->SetParent(node);
+            if(lastChild) {
+                lastChild->SetNext(child);
+            } else {
+                node->SetChildren(child);
+            }
+            lastChild = child;
+        }
+        return node;
+    }
+};
+
+void WriteData(std::string& buffer, const void* data, size_t len) { buffer.append((const char*)data, len); }
+
+void WriteString(std::string& buffer, const wxString& str)
+{
+    const wxScopedCharBuffer utf8 = str.ToUTF8();
+    uint32_t len = utf8.length();
+    WriteData(buffer, &len, sizeof(len));
+    buffer.append(utf8.data(), len);
+}
+
+void WriteTree(std::string& buffer, const wxXmlNode* node)
+{
+    uint8_t type = node->GetType();
+    WriteData(buffer, &type, sizeof(type));
+    WriteString(buffer, node->GetName());
+    WriteString(buffer, node->GetContent());
+
+    uint32_t count = 0;
+    for(const wxXmlAttribute* attr = node->GetAttributes(); attr; attr = attr->GetNext()) {
+        ++count;
+    }
+    WriteData(buffer, &count, sizeof(count));
+    for(const wxXmlAttribute* attr = node->GetAttributes(); attr; attr = attr->GetNext()) {
+        WriteString(buffer, attr->GetName());
+        WriteString(buffer, attr->GetValue());
+    }
+
+    count = 0;
+    for(const wxXmlNode* child = node->GetChildren(); child; child = child->GetNext()) {
+        ++count;
+    }
+    WriteData(buffer, &count, sizeof(count));
+    for(const wxXmlNode* child = node->GetChildren(); child; child = child->GetNext()) {
+        WriteTree(buffer, child);
+    }
+}
+} // namespace
+
+bool clCxxWorkspaceSnapshot::Stat(const wxString& path, FileStat& st)
+{
+    wxStructStat buff;
+    if(wxStat(path, &buff) != 0) {
+        return false;
+    }
+    st.size = buff.st_size;
+    st.modified = buff.st_mtime;
+    return true;
+}
+
+bool clCxxWorkspaceSnapshot::Load(const wxString& path)
+{
+    Close();
+    if(!m_mapping.Open(path)) {
+        return false;
+    }
+
+    Reader reader(m_mapping.GetData(), m_mapping.GetSize());
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    if(!reader.Read(magic, sizeof(magic)) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+       !reader.Read(&version, sizeof(version)) || version != SNAPSHOT_VERSION || !reader.Read(&count, sizeof(count))) {
+        clDEBUG() << "Ignoring workspace snapshot:" << path << endl;
+        Close();
+        return false;
+    }
+
+    for(uint32_t i = 0; i < count; ++i) {
+        wxString projectPath;
+        uint64_t size = 0;
+        int64_t modified = 0;
+        uint64_t length = 0;
+        if(!reader.ReadString(projectPath) || !reader.Read(&size, sizeof(size)) ||
+           !reader.Read(&modified, sizeof(modified)) || !reader.Read(&length, sizeof(length))) {
+            break;
+        }
+        Entry entry;
+        entry.stat.size = size;
+        entry.stat.modified = modified;
+        entry.offset = reader.GetPos() - m_mapping.GetData();
+        entry.length = length;
+        if(!reader.Skip(length)) {
+            break;
+        }
+        m_entries[projectPath] = entry;
+    }
+    return true;
+}
+
+void clCxxWorkspaceSnapshot::Close()
+{
+    m_entries.clear();
+    m_mapping.Close();
+}
+
+wxXmlNode* clCxxWorkspaceSnapshot::CreateXml(const wxString& path, const FileStat& st) const
+{
+    auto iter = m_entries.find(path);
+    if(iter == m_entries.end()) {
+        return nullptr;
+    }
+
+    const Entry& entry = iter->second;
+    if(entry.stat.size != st.size || entry.stat.modified != st.modified) {
+        return nullptr;
+    }
+    Reader reader(m_mapping.GetData() + entry.offset, entry.length);
+    return reader.ReadTree();
+}
+
+void clCxxWorkspaceSnapshot::Add(const wxString& path, const FileStat& st, const wxXmlNode* root)
+{
+    if(m_buffer.empty()) {
+        uint32_t version = SNAPSHOT_VERSION;
+        uint32_t count = 0;
+        WriteData(m_buffer, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        WriteData(m_buffer, &version, sizeof(version));
+        WriteData(m_buffer, &count, sizeof(count));
+    }
+
+    uint64_t size = st.size;
+    int64_t modified = st.modified;
+    WriteString(m_buffer, path);
+    WriteData(m_buffer, &size, sizeof(size));
+    WriteData(m_buffer, &modified, sizeof(modified));
+
+    // the tree length is known once the tree is written
+    size_t lengthOffset = m_buffer.length();
+    uint64_t length = 0;
+    WriteData(m_buffer, &length, sizeof(length));
+    WriteTree(m_buffer, root);
+    length = m_buffer.length() - lengthOffset - sizeof(length);
+    memcpy(&m_buffer[lengthOffset], &length, sizeof(length));
+    ++m_added;
+}
+
+bool clCxxWorkspaceSnapshot::Save(const wxString& path)
+{
+    if(m_buffer.empty()) {
+        return false;
+    }
+    uint32_t count = m_added;
+    memcpy(&m_buffer[sizeof(SNAPSHOT_MAGIC) + sizeof(uint32_t)], &count, sizeof(count));
+
+    // the snapshot may be mapped by another instance: replace it instead of overwriting it
+    wxString tmpfile = path + ".tmp";
+    {
+        wxFFile fp(tmpfile, "wb");
+        if(!fp.IsOpened() || fp.Write(m_buffer.data(), m_buffer.length()) != m_buffer.length()) {
+            clWARNING() << "Failed to write workspace snapshot:" << tmpfile << endl;
+            return false;
+        }
+    }
+    if(!::wxRenameFile(tmpfile, path, true)) {
+        clWARNING() << "Failed to write workspace snapshot:" << path << endl;
+        return false;
+    }
+    return true;
+}
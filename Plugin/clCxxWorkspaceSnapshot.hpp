@@ -0,0 +1,81 @@
+#ifndef CLCXXWORKSPACESNAPSHOT_HPP
+#define CLCXXWORKSPACESNAPSHOT_HPP
+
+#include "clMemoryMappedFile.hpp"
+#include "codelite_exports.h"
+#include "wxStringHash.h"
+
+#include <string>
+#include <time.h>
+#include <unordered_map>
+#include <wx/string.h>
+
+class wxXmlNode;
+
+/// A binary copy of the XML trees of the projects of a C++ workspace.
+///
+/// The snapshot is written in the private folder of the workspace once its projects are loaded. On the next open, it
+/// is memory mapped and the tree of every project whose file kept its size and modification time is rebuilt from it,
+/// instead of parsing the project file again
+class WXDLLIMPEXP_SDK clCxxWorkspaceSnapshot
+{
+public:
+    struct FileStat {
+        size_t size = 0;
+        time_t modified = 0;
+    };
+
+protected:
+    struct Entry {
+        FileStat stat;
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    clMemoryMappedFile m_mapping;
+    std::unordered_map<wxString, Entry> m_entries;
+    std::string m_buffer;
+    size_t m_added = 0;
+
+public:
+    clCxxWorkspaceSnapshot() = default;
+    ~clCxxWorkspaceSnapshot() = default;
+
+    /**
+     * @brief read the size and modification time of `path`
+     */
+    static bool Stat(const wxString& path, FileStat& st);
+
+    /**
+     * @brief map the snapshot file `path`. Return false if it does not exist or was written by another version
+     */
+    bool Load(const wxString& path);
+
+    /**
+     * @brief release the mapping
+     */
+    void Close();
+
+    /**
+     * @brief build a copy of the XML tree of the project file `path`, if the snapshot holds it and the file did not
+     * change since. The caller owns the returned root. Can be called from several threads at once
+     */
+    wxXmlNode* CreateXml(const wxString& path, const FileStat& st) const;
+
+    /**
+     * @brief number of project trees in the loaded snapshot
+     */
+    size_t GetCount() const { return m_entries.size(); }
+
+    /**
+     * @brief add the tree of the project file `path` to the snapshot to write
+     */
+    void Add(const wxString& path, const FileStat& st, const wxXmlNode* root);
+
+    /**
+     * @brief write the trees passed to Add() to `path`
+     */
+    bool Save(const wxString& path);
+};
+
+#endif // CLCXXWORKSPACESNAPSHOT_HPP
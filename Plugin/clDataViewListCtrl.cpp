@@ -138,6 +138,26 @@ wxDataViewItem clDataViewListCtrl::AppendItem(const wxVector<wxVariant>& values,
     return DV_ITEM(item);
 }
 
+wxDataViewItemArray clDataViewListCtrl::AppendItems(const wxVector<wxVector<wxVariant>>& rows)
+{
+    bool inBatch = m_bulkInsert;
+    if(!inBatch) {
+        Begin();
+    }
+
+    wxDataViewItemArray items;
+    items.Alloc(rows.size());
+    ReserveChildren(GetRootItem(), rows.size());
+    for(const auto& values : rows) {
+        items.Add(AppendItem(values));
+    }
+
+    if(!inBatch) {
+        Commit();
+    }
+    return items;
+}
+
 wxDataViewColumn* clDataViewListCtrl::AppendIconTextColumn(const wxString& label, wxDataViewCellMode mode, int width,
                                                            wxAlignment align, int flags)
 {
@@ -484,6 +504,7 @@ void clDataViewListCtrl::SetSortFunction(const clSortFunc_t& CompareFunc)
 
     // Step 3: sort the children
     std::sort(children.begin(), children.end(), CompareFunc);
+    root->ChildrenReordered();
 
     // Now, reconnect the children, starting with the root
     clRowEntry* prev = root;
@@ -512,13 +533,7 @@ int clDataViewListCtrl::ItemToRow(const wxDataViewItem& item) const
         return wxNOT_FOUND;
     }
 
-    const clRowEntry::Vec_t& children = root->GetChildren();
-    for(size_t i = 0; i < children.size(); ++i) {
-        if(children[i] == pItem) {
-            return i;
-        }
-    }
-    return wxNOT_FOUND;
+    return root->GetChildIndex(pItem);
 }
 
 void clDataViewListCtrl::Select(const wxDataViewItem& item)
@@ -549,6 +564,11 @@ void clDataViewListCtrl::HighlightText(const wxDataViewItem& item, bool b)
 
 void clDataViewListCtrl::ClearHighlight(const wxDataViewItem& item) { clTreeCtrl::ClearHighlight(TREE_ITEM(item)); }
 
+void clDataViewListCtrl::SetItemHighlightInfo(const wxDataViewItem& item, size_t start_pos, size_t len, size_t col)
+{
+    clTreeCtrl::SetItemHighlightInfo(TREE_ITEM(item), start_pos, len, col);
+}
+
 void clDataViewListCtrl::EnsureVisible(const wxDataViewItem& item) { clTreeCtrl::EnsureVisible(TREE_ITEM(item)); }
 
 void clDataViewListCtrl::ClearColumns() { GetHeader()->Clear(); }
@@ -102,6 +102,11 @@ public:
      */
     void ClearHighlight(const wxDataViewItem& item);
 
+    /**
+     * @brief set highlight information for a given item, see clTreeCtrl::SetItemHighlightInfo
+     */
+    void SetItemHighlightInfo(const wxDataViewItem& item, size_t start_pos, size_t len, size_t col = 0);
+
     ///===--------------------
     /// wxDV compatilibty API
     ///===--------------------
@@ -124,6 +129,12 @@ public:
 
     wxDataViewItem AppendItem(const wxVector<wxVariant>& values, wxUIntPtr data = 0);
 
+    /**
+     * @brief append a batch of rows. The storage is reserved once and the UI is updated once, at the end (unless
+     * called between `Begin()` and `Commit()`)
+     */
+    wxDataViewItemArray AppendItems(const wxVector<wxVector<wxVariant>>& rows);
+
     wxDataViewColumn* AppendIconTextColumn(const wxString& label, wxDataViewCellMode mode = wxDATAVIEW_CELL_INERT,
                                            int width = -1, wxAlignment align = wxALIGN_LEFT,
                                            int flags = wxDATAVIEW_COL_RESIZABLE);
@@ -1,24 +1,73 @@
 #include "clFileCache.hpp"
 
-void clFileCache::Add(const wxFileName& fn)
+#include <wx/filename.h>
+
+void clFileCache::Add(const clPath& path)
 {
-    if(Contains(fn)) {
+    if(!path.IsOk() || !m_filesIndex.insert({ path, m_files.size() }).second) {
         return;
     }
-    m_files.push_back(fn);
-    m_filesSet.insert(fn.GetFullPath());
+    m_files.push_back(path);
+}
+
+bool clFileCache::Remove(const wxString& fullpath)
+{
+    // a path that was never interned can not be in the cache
+    auto iter = m_filesIndex.find(clPathTable::Get().Find(fullpath));
+    if(iter == m_filesIndex.end()) {
+        return false;
+    }
+
+    size_t index = iter->second;
+    m_filesIndex.erase(iter);
+    if(index != m_files.size() - 1) {
+        m_files[index] = m_files.back();
+        m_filesIndex[m_files[index]] = index;
+    }
+    m_files.pop_back();
+    return true;
+}
+
+size_t clFileCache::RemoveFolder(const wxString& path)
+{
+    clPath folder = clPathTable::Get().Find(wxFileName(path, "").GetPath());
+    if(!folder.IsOk()) {
+        return 0;
+    }
+
+    std::vector<clPath> files;
+    files.reserve(m_files.size());
+    for(const clPath& file : m_files) {
+        if(!file.IsUnder(folder)) {
+            files.push_back(file);
+        }
+    }
+
+    // the files kept stay in the same order: the index changes only if some were removed
+    size_t count = m_files.size() - files.size();
+    if(count) {
+        m_files.swap(files);
+        m_filesIndex.clear();
+        for(size_t i = 0; i < m_files.size(); ++i) {
+            m_filesIndex.insert({ m_files[i], i });
+        }
+    }
+    return count;
 }
 
 void clFileCache::Clear()
 {
-    m_filesSet.clear();
+    m_filesIndex.clear();
     m_files.clear();
 }
 
-bool clFileCache::Contains(const wxFileName& fn) const { return m_filesSet.count(fn.GetFullPath()); }
+bool clFileCache::Contains(const wxString& fullpath) const
+{
+    return m_filesIndex.count(clPathTable::Get().Find(fullpath));
+}
 
 void clFileCache::Alloc(size_t size)
 {
     m_files.reserve(size);
-    m_filesSet.reserve(size);
+    m_filesIndex.reserve(size);
 }
@@ -1,34 +1,45 @@
 #ifndef CLFILECACHE_HPP
 #define CLFILECACHE_HPP
 
+#include "clPathTable.hpp"
 #include "codelite_exports.h"
-#include "wxStringHash.h"
 
-#include <unordered_set>
+#include <unordered_map>
 #include <vector>
-#include <wx/filename.h>
+#include <wx/string.h>
 
+/// The files of a workspace, stored as handles to the shared path table
 class WXDLLIMPEXP_SDK clFileCache
 {
-    std::vector<wxFileName> m_files;
-    std::unordered_set<wxString> m_filesSet;
+    std::vector<clPath> m_files;
+    /// path -> index in m_files
+    std::unordered_map<clPath, size_t> m_filesIndex;
 
 public:
-    typedef std::vector<wxFileName>::const_iterator const_iterator;
-    typedef std::vector<wxFileName>::iterator iterator;
+    typedef std::vector<clPath>::const_iterator const_iterator;
+    typedef std::vector<clPath>::iterator iterator;
 
 public:
     clFileCache() {}
     ~clFileCache() {}
 
-    const std::vector<wxFileName>& GetFiles() const { return m_files; }
+    const std::vector<clPath>& GetFiles() const { return m_files; }
     const_iterator begin() const { return m_files.begin(); }
     const_iterator end() const { return m_files.end(); }
 
     void Alloc(size_t size);
-    void Add(const wxFileName& fn);
+    void Add(const clPath& path);
+    void Add(const wxString& fullpath) { Add(clPathTable::Get().Intern(fullpath)); }
+    /**
+     * @brief remove `fullpath` from the cache. The last file takes its place, the order of the files is not kept
+     */
+    bool Remove(const wxString& fullpath);
+    /**
+     * @brief remove the files under the folder `path`, return their number
+     */
+    size_t RemoveFolder(const wxString& path);
     void Clear();
-    bool Contains(const wxFileName& fn) const;
+    bool Contains(const wxString& fullpath) const;
     size_t GetSize() const { return m_files.size(); }
     bool IsEmpty() const { return m_files.empty(); }
 };
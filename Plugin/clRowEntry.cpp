@@ -276,6 +276,7 @@ void clRowEntry::InsertChild(clRowEntry* child, clRowEntry* prev)
         nodeBefore = prevSibling;
     }
     child->ConnectNodes(nodeBefore, nodeBefore->m_next);
+    ChildrenRowsChanged(child->GetRowsCount());
 }
 
 void clRowEntry::AddChild(clRowEntry* child) { InsertChild(child, m_children.empty() ? nullptr : m_children.back()); }
@@ -295,6 +296,7 @@ void clRowEntry::DeleteChild(clRowEntry* child)
 {
     // first remove all of its children
     child->DeleteAllChildren();
+    int rows = child->GetRowsCount();
 
     // Connect the list
     clRowEntry* prev = child->m_prev;
@@ -315,9 +317,121 @@ void clRowEntry::DeleteChild(clRowEntry* child)
             m_children.erase(iter);
         }
     }
+    ChildrenRowsChanged(-rows);
     wxDELETE(child);
 }
 
+void clRowEntry::ChildrenRowsChanged(int delta)
+{
+    clRowEntry* node = this;
+    while (node) {
+        node->m_childrenOffsetsOk = false;
+        if (delta == 0) {
+            break;
+        }
+        node->m_childrenRows += delta;
+        // the rows of a collapsed item do not change, neither do the rows of its ancestors
+        if (!node->IsExpanded()) {
+            break;
+        }
+        node = node->m_parent;
+    }
+}
+
+void clRowEntry::BuildChildrenOffsets() const
+{
+    if (m_childrenOffsetsOk) {
+        return;
+    }
+    m_childrenOffsets.resize(m_children.size());
+    int offset = 0;
+    for (size_t i = 0; i < m_children.size(); ++i) {
+        m_childrenOffsets[i] = offset;
+        m_children[i]->m_indexInParent = i;
+        offset += m_children[i]->GetRowsCount();
+    }
+    m_childrenOffsetsOk = true;
+}
+
+int clRowEntry::GetRowIndex() const
+{
+    int row = 0;
+    const clRowEntry* node = this;
+    while (node->m_parent) {
+        const clRowEntry* parent = node->m_parent;
+        parent->BuildChildrenOffsets();
+        row += parent->m_childrenOffsets[node->m_indexInParent] + (parent->IsHidden() ? 0 : 1);
+        node = parent;
+    }
+    return row;
+}
+
+clRowEntry* clRowEntry::GetRowItem(int row)
+{
+    clRowEntry* node = this;
+    while (node && row >= 0) {
+        if (!node->IsHidden()) {
+            if (row == 0) {
+                return node;
+            }
+            --row;
+        }
+        if (!node->IsExpanded() || row >= node->m_childrenRows) {
+            return nullptr;
+        }
+
+        // descend into the last child starting at, or before, `row`
+        node->BuildChildrenOffsets();
+        const std::vector<int>& offsets = node->m_childrenOffsets;
+        size_t index = std::upper_bound(offsets.begin(), offsets.end(), row) - offsets.begin() - 1;
+        row -= offsets[index];
+        node = node->m_children[index];
+    }
+    return nullptr;
+}
+
+int clRowEntry::GetChildIndex(const clRowEntry* child) const
+{
+    if (!child || child->m_parent != this) {
+        return wxNOT_FOUND;
+    }
+    BuildChildrenOffsets();
+    return child->m_indexInParent;
+}
+
+clRowEntry* clRowEntry::GetNextVisible() const
+{
+    if (IsExpanded() && HasChildren()) {
+        return m_children.front();
+    }
+
+    // skip the subtree of this item
+    const clRowEntry* last = this;
+    while (last->HasChildren()) {
+        last = last->m_children.back();
+    }
+    return last->m_next;
+}
+
+clRowEntry* clRowEntry::GetPrevVisible() const
+{
+    clRowEntry* prev = m_prev;
+    if (!prev || prev == m_parent) {
+        return (prev && prev->IsHidden()) ? nullptr : prev;
+    }
+
+    // `prev` is the last item of the previous sibling subtree: the row displayed before this item is the last
+    // visible item of that subtree
+    clRowEntry* node = prev;
+    while (node->m_parent != m_parent) {
+        node = node->m_parent;
+    }
+    while (node->IsExpanded() && node->HasChildren()) {
+        node = node->m_children.back();
+    }
+    return node;
+}
+
 int clRowEntry::GetExpandedLines() const
 {
     clRowEntry* node = const_cast<clRowEntry*>(this);
@@ -340,15 +454,18 @@ void clRowEntry::GetNextItems(int count, clRowEntry::Vec_t& items, bool selfIncl
     if (!this->IsHidden() && selfIncluded) {
         items.push_back(this);
     }
-    clRowEntry* next = GetNext();
-    while (next) {
-        if (next->IsVisible() && !next->IsHidden()) {
-            items.push_back(next);
-        }
-        if ((int)items.size() == count) {
-            return;
+
+    // when this item is inside a collapsed subtree, start after the top most collapsed item
+    const clRowEntry* start = this;
+    for (const clRowEntry* parent = m_parent; parent; parent = parent->m_parent) {
+        if (!parent->IsExpanded()) {
+            start = parent;
         }
-        next = next->GetNext();
+    }
+    clRowEntry* next = start->GetNextVisible();
+    while (next && (int)items.size() < count) {
+        items.push_back(next);
+        next = next->GetNextVisible();
     }
 }
 
@@ -357,20 +474,25 @@ void clRowEntry::GetPrevItems(int count, clRowEntry::Vec_t& items, bool selfIncl
     if (count <= 0) {
         return;
     }
-    items.reserve(count);
+    clRowEntry::Vec_t prevItems;
+    prevItems.reserve(count);
     if (!this->IsHidden() && selfIncluded) {
-        items.insert(items.begin(), this);
+        prevItems.push_back(this);
     }
-    clRowEntry* prev = GetPrev();
-    while (prev) {
-        if (prev->IsVisible() && !prev->IsHidden()) {
-            items.insert(items.begin(), prev);
-        }
-        if ((int)items.size() == count) {
-            return;
+
+    // when this item is inside a collapsed subtree, the top most collapsed item is the visible item before it
+    clRowEntry* start = this;
+    for (clRowEntry* parent = m_parent; parent; parent = parent->m_parent) {
+        if (!parent->IsExpanded()) {
+            start = parent;
         }
-        prev = prev->GetPrev();
     }
+    clRowEntry* prev = (start == this) ? GetPrevVisible() : start;
+    while (prev && (int)(items.size() + prevItems.size()) < count) {
+        prevItems.push_back(prev);
+        prev = prev->GetPrevVisible();
+    }
+    items.insert(items.begin(), prevItems.rbegin(), prevItems.rend());
 }
 
 clRowEntry* clRowEntry::GetVisibleItem(int index)
@@ -421,7 +543,15 @@ bool clRowEntry::SetExpanded(bool b)
         return false;
     }
 
+    if (b && HasChildrenToLoad()) {
+        SetHasChildrenToLoad(false);
+        m_model->NodeLoadChildren(this);
+    }
+
     SetFlag(kNF_Expanded, b);
+    if (m_parent) {
+        m_parent->ChildrenRowsChanged(b ? m_childrenRows : -m_childrenRows);
+    }
     m_model->NodeExpanded(this, b);
     return true;
 }
@@ -612,7 +742,7 @@ void clRowEntry::Render(wxWindow* win, wxDC& dc, const clColours& c, int row_ind
         int textXOffset = cellRect.GetX();
         if ((i == 0) && !IsListItem()) {
             // The expand button is only make sense for the first cell
-            if (HasChildren()) {
+            if (CanExpand()) {
                 wxRect assignedRectForButton = GetButtonRect();
                 wxRect buttonRect = assignedRectForButton;
                 buttonRect.Deflate(1);
@@ -787,7 +917,27 @@ void clRowEntry::Render(wxWindow* win, wxDC& dc, const clColours& c, int row_ind
 void clRowEntry::RenderText(wxWindow* win, wxDC& dc, const clColours& colours, const wxString& text, int x, int y,
                             size_t col)
 {
-    RenderTextSimple(win, dc, colours, text, x, y, col);
+    Str3Arr_t parts;
+    if (!IsHighlight() || !m_higlightInfo.Get(col, parts) || (parts[0] + parts[1] + parts[2]) != text) {
+        RenderTextSimple(win, dc, colours, text, x, y, col);
+        return;
+    }
+
+    // the text before the match, the match itself on the "matched" colours and the remainder
+    RenderTextSimple(win, dc, colours, parts[0], x, y, col);
+    x += dc.GetTextExtent(parts[0]).GetWidth();
+
+    wxSize matchSize = dc.GetTextExtent(parts[1]);
+    {
+        wxDCBrushChanger brush_changer(dc, wxBrush(colours.GetMatchedItemBgText()));
+        wxDCPenChanger pen_changer(dc, wxPen(colours.GetMatchedItemBgText()));
+        wxDCTextColourChanger text_changer(dc, colours.GetMatchedItemText());
+        dc.DrawRectangle(wxRect(wxPoint(x, y), matchSize));
+        dc.DrawText(parts[1], x, y);
+    }
+    x += matchSize.GetWidth();
+
+    RenderTextSimple(win, dc, colours, parts[2], x, y, col);
 }
 
 void clRowEntry::RenderTextSimple(wxWindow* win, wxDC& dc, const clColours& colours, const wxString& text, int x, int y,
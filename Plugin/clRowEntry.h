@@ -28,6 +28,7 @@ enum clTreeCtrlNodeFlags {
     kNF_Hidden = (1 << 6),
     kNF_LisItem = (1 << 7),
     kNF_HighlightText = (1 << 8),
+    kNF_ChildrenToLoad = (1 << 9),
 };
 
 typedef std::array<wxString, 3> Str3Arr_t;
@@ -74,6 +75,13 @@ protected:
     wxRect m_buttonRect;
     clMatchResult m_higlightInfo;
 
+    // Row index: the number of rows displayed by the children subtrees (when this item is expanded), and the row
+    // offset of each child within them. The offsets are rebuilt on demand after the children changed
+    int m_childrenRows = 0;
+    mutable std::vector<int> m_childrenOffsets;
+    mutable bool m_childrenOffsetsOk = false;
+    mutable size_t m_indexInParent = 0;
+
 protected:
     void SetFlag(clTreeCtrlNodeFlags flag, bool b)
     {
@@ -86,6 +94,12 @@ protected:
 
     bool HasFlag(clTreeCtrlNodeFlags flag) const { return m_flags & flag; }
 
+    /**
+     * @brief the rows displayed by the children of this item changed by `delta`, update the index of the ancestors
+     */
+    void ChildrenRowsChanged(int delta);
+    void BuildChildrenOffsets() const;
+
     /**
      * @brief return the nth visible item
      */
@@ -232,6 +246,15 @@ public:
     void SetParent(clRowEntry* parent);
     clRowEntry* GetParent() const { return m_parent; }
     bool HasChildren() const { return !m_children.empty(); }
+    /**
+     * @brief the children of this item are not loaded yet, they are requested when it is expanded
+     */
+    void SetHasChildrenToLoad(bool b) { SetFlag(kNF_ChildrenToLoad, b); }
+    bool HasChildrenToLoad() const { return HasFlag(kNF_ChildrenToLoad); }
+    /**
+     * @brief should this item display an expand button?
+     */
+    bool CanExpand() const { return HasChildren() || HasChildrenToLoad(); }
     void SetClientData(wxTreeItemData* clientData)
     {
         wxDELETE(m_clientObject);
@@ -239,6 +262,33 @@ public:
     }
     size_t GetChildrenCount(bool recurse) const;
     int GetExpandedLines() const;
+
+    /**
+     * @brief the number of rows displayed by this item and its subtree
+     */
+    int GetRowsCount() const { return (IsHidden() ? 0 : 1) + (IsExpanded() ? m_childrenRows : 0); }
+    /**
+     * @brief the row of this item, counted from the root. This item must be visible
+     */
+    int GetRowIndex() const;
+    /**
+     * @brief return the item displayed at `row`, counted from this item, or nullptr
+     */
+    clRowEntry* GetRowItem(int row);
+    /**
+     * @brief the index of `child` in the children of this item, wxNOT_FOUND if it is not a child of this item
+     */
+    int GetChildIndex(const clRowEntry* child) const;
+    /**
+     * @brief the children array was reordered directly, reset the row index
+     */
+    void ChildrenReordered() { m_childrenOffsetsOk = false; }
+    /**
+     * @brief the visible item displayed after / before this one. This item must be visible (or the hidden root)
+     */
+    clRowEntry* GetNextVisible() const;
+    clRowEntry* GetPrevVisible() const;
+
     void GetNextItems(int count, clRowEntry::Vec_t& items, bool selfIncluded = true);
     void GetPrevItems(int count, clRowEntry::Vec_t& items, bool selfIncluded = true);
     void SetIndentsCount(int count) { this->m_indentsCount = count; }
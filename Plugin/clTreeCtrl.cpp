@@ -620,7 +620,17 @@ bool clTreeCtrl::ItemHasChildren(const wxTreeItemId& item) const
     clRowEntry* child = m_model.ToPtr(item);
     if (!child)
         return false;
-    return child->HasChildren();
+    return child->CanExpand();
+}
+
+void clTreeCtrl::SetItemHasChildren(const wxTreeItemId& item, bool has)
+{
+    clRowEntry* child = m_model.ToPtr(item);
+    if (!child) {
+        return;
+    }
+    child->SetHasChildrenToLoad(has);
+    Refresh();
 }
 
 void clTreeCtrl::SetIndent(int size)
@@ -1580,6 +1590,10 @@ void clTreeCtrl::SetDefaultFont(const wxFont& font)
 
 void clTreeCtrl::Begin()
 {
+    if (m_bulkInsert) {
+        // already in a bulk insert, keep the sort function put aside by the first call
+        return;
+    }
     m_bulkInsert = true;
     m_oldSortFunc = m_model.GetSortFunction();
     m_model.SetSortFunction(nullptr);
@@ -1589,17 +1603,31 @@ void clTreeCtrl::Commit()
 {
     m_bulkInsert = false;
     m_model.SetSortFunction(m_oldSortFunc);
-    const auto& items = m_model.GetOnScreenItems();
-
     // update the header according to the visible items
-    for (const auto& item : items) {
-        DoUpdateHeader(item);
-    }
+    clControlWithItems::DoUpdateHeader(m_model.GetOnScreenItems());
 
     UpdateScrollBar();
     Refresh();
 }
 
+void clTreeCtrl::ReserveChildren(const wxTreeItemId& parent, size_t count)
+{
+    clRowEntry* node = m_model.ToPtr(parent);
+    CHECK_PTR_RET(node);
+    node->GetChildren().reserve(node->GetChildren().size() + count);
+}
+
+void clTreeCtrl::SortChildren(const wxTreeItemId& item)
+{
+    clRowEntry* node = m_model.ToPtr(item);
+    CHECK_PTR_RET(node);
+    // while in a bulk insert, the sort function is put aside
+    m_model.SortChildren(node, m_bulkInsert ? m_oldSortFunc : m_model.GetSortFunction());
+    if (!m_bulkInsert) {
+        Refresh();
+    }
+}
+
 void clTreeCtrl::SetLineSpacing(size_t pixels)
 {
     m_spacerY = pixels;
@@ -1615,7 +1643,7 @@ void clTreeCtrl::SetItemHighlightInfo(const wxTreeItemId& item, size_t start_pos
     CHECK_PTR_RET(child);
 
     const wxString& text = child->GetLabel(col);
-    CHECK_EXPECTED_RETURN(start_pos + len < text.length(), true);
+    CHECK_EXPECTED_RETURN(start_pos + len <= text.length(), true);
 
     clMatchResult match_result;
     Str3Arr_t triplet;
@@ -110,6 +110,18 @@ public:
      */
     void Commit();
 
+    /**
+     * @brief reserve room for `count` more children of `parent`, before a bulk insert
+     */
+    void ReserveChildren(const wxTreeItemId& parent, size_t count);
+
+    /**
+     * @brief sort the children of `item` with the tree sort function. Items are sorted as they are inserted, so this is
+     * only needed after a bulk insert: items inserted between `Begin()` and `Commit()` are not sorted, call this once,
+     * before `Commit()`, to sort them
+     */
+    void SortChildren(const wxTreeItemId& item);
+
     //===--------------------
     // Search support
     //===--------------------
@@ -167,6 +179,12 @@ public:
      */
     virtual void SetSortFunction(const clSortFunc_t& CompareFunc);
 
+    /**
+     * @brief set the provider of the children of the items marked with SetItemHasChildren(). The children of such an
+     * item are requested the first time it is expanded. The tree does not own the data source
+     */
+    void SetDataSource(clTreeCtrlDataSource* dataSource) { m_model.SetDataSource(dataSource); }
+
     /**
      * @brief associate bitmap vector with this tree. The bitmaps array must exists as long as this control exists
      */
@@ -295,6 +313,12 @@ public:
     bool ItemHasChildren(const wxTreeItemId& item) const;
     bool HasChildren(const wxTreeItemId& item) const { return ItemHasChildren(item); }
 
+    /**
+     * @brief mark an item as having children that are not loaded yet. The item displays an expand button, and its
+     * children are requested from the data source (or from a wxEVT_TREE_ITEM_EXPANDING handler) when it is expanded
+     */
+    void SetItemHasChildren(const wxTreeItemId& item, bool has = true);
+
     /**
      * @brief set the item's indent size
      */
@@ -335,11 +359,6 @@ public:
      */
     wxTreeItemId GetPrevItem(const wxTreeItemId& item) const;
 
-    /**
-     * @brief for compatibility, we dont really need to call this method manually
-     */
-    void SortChildren(const wxTreeItemId& item) { wxUnusedVar(item); }
-
     /**
      * @brief set item's image index
      */
@@ -3,6 +3,7 @@
 #include "clTreeCtrl.h"
 
 #include <algorithm>
+#include <unordered_set>
 #include <wx/dc.h>
 #include <wx/settings.h>
 #include <wx/treebase.h>
@@ -139,11 +140,9 @@ void clTreeCtrlModel::Clear()
 void clTreeCtrlModel::SetOnScreenItems(const clRowEntry::Vec_t& items)
 {
     // Clear the old visible items. But only, if the item does not appear in both lists
+    std::unordered_set<clRowEntry*> newItems(items.begin(), items.end());
     for(size_t i = 0; i < m_onScreenItems.size(); ++i) {
-        clRowEntry* visibleItem = m_onScreenItems[i];
-        clRowEntry::Vec_t::const_iterator iter =
-            std::find_if(items.begin(), items.end(), [&](clRowEntry* item) { return item == visibleItem; });
-        if(iter == items.end()) {
+        if(newItems.count(m_onScreenItems[i]) == 0) {
             m_onScreenItems[i]->ClearRects();
         }
     }
@@ -222,6 +221,39 @@ wxTreeItemId clTreeCtrlModel::InsertItem(const wxTreeItemId& parent, const wxTre
     return wxTreeItemId(child);
 }
 
+void clTreeCtrlModel::SortChildren(clRowEntry* parent, const clSortFunc_t& CompareFunc)
+{
+    if(!parent || !CompareFunc || parent->GetChildren().size() < 2) {
+        return;
+    }
+
+    // the item following the subtree of `parent`
+    clRowEntry* last = parent;
+    while(last->HasChildren()) {
+        last = last->GetLastChild();
+    }
+    clRowEntry* end = last->GetNext();
+
+    clRowEntry::Vec_t& children = parent->GetChildren();
+    std::stable_sort(children.begin(), children.end(), CompareFunc);
+    parent->ChildrenReordered();
+
+    // reconnect the subtrees of the children in their new order
+    clRowEntry* prev = parent;
+    for(clRowEntry* child : children) {
+        prev->SetNext(child);
+        child->SetPrev(prev);
+        prev = child;
+        while(prev->HasChildren()) {
+            prev = prev->GetLastChild();
+        }
+    }
+    prev->SetNext(end);
+    if(end) {
+        end->SetPrev(prev);
+    }
+}
+
 void clTreeCtrlModel::ExpandAllChildren(const wxTreeItemId& item) { DoExpandAllChildren(item, true); }
 
 void clTreeCtrlModel::CollapseAllChildren(const wxTreeItemId& item) { DoExpandAllChildren(item, false); }
@@ -232,8 +264,15 @@ void clTreeCtrlModel::DoExpandAllChildren(const wxTreeItemId& item, bool expand)
     if(!p) {
         return;
     }
-    while(p) {
-        if(p->HasChildren()) {
+
+    // the item following the subtree of `item`. It does not change while the subtree children are loaded
+    clRowEntry* last = p;
+    while(last->HasChildren()) {
+        last = last->GetLastChild();
+    }
+    clRowEntry* end = last->GetNext();
+    while(p && p != end) {
+        if(p->CanExpand()) {
             if(expand && !p->IsExpanded()) {
                 p->SetExpanded(true);
             } else if(!expand && p->IsExpanded()) {
@@ -322,6 +361,13 @@ bool clTreeCtrlModel::NodeExpanding(clRowEntry* node, bool expanding)
     return before.IsAllowed();
 }
 
+void clTreeCtrlModel::NodeLoadChildren(clRowEntry* node)
+{
+    if(m_dataSource) {
+        m_dataSource->LoadChildren(m_tree, wxTreeItemId(node));
+    }
+}
+
 void clTreeCtrlModel::NodeExpanded(clRowEntry* node, bool expanded)
 {
     wxTreeEvent after(expanded ? wxEVT_TREE_ITEM_EXPANDED : wxEVT_TREE_ITEM_COLLAPSED);
@@ -358,18 +404,18 @@ int clTreeCtrlModel::GetItemIndex(clRowEntry* item) const
     if(!m_root) {
         return wxNOT_FOUND;
     }
-    int counter = 0;
-    clRowEntry* current = m_root;
-    while(current) {
-        if(current == item) {
-            return counter;
-        }
-        if(current->IsVisible()) {
-            ++counter;
+
+    // an item inside a collapsed subtree is counted right after the top most collapsed item
+    clRowEntry* collapsed = nullptr;
+    for(clRowEntry* parent = item->GetParent(); parent; parent = parent->GetParent()) {
+        if(!parent->IsExpanded()) {
+            collapsed = parent;
         }
-        current = current->GetNext();
     }
-    return wxNOT_FOUND;
+    if(collapsed) {
+        return collapsed->GetRowIndex() + 1;
+    }
+    return item->GetRowIndex();
 }
 
 bool clTreeCtrlModel::GetRange(clRowEntry* from, clRowEntry* to, clRowEntry::Vec_t& items) const
@@ -396,6 +442,11 @@ bool clTreeCtrlModel::GetRange(clRowEntry* from, clRowEntry* to, clRowEntry::Vec
 
     clRowEntry* start_item = index1 > index2 ? to : from;
     clRowEntry* end_item = index1 > index2 ? from : to;
+    if(start_item->IsVisible() && end_item->IsVisible()) {
+        start_item->GetNextItems(std::max(index1, index2) - std::min(index1, index2) + 1, items);
+        return true;
+    }
+
     clRowEntry* current = start_item;
     while(current) {
         if(current == end_item) {
@@ -415,7 +466,7 @@ size_t clTreeCtrlModel::GetExpandedLines() const
     if(!GetRoot()) {
         return 0;
     }
-    return m_root->GetExpandedLines();
+    return m_root->GetRowsCount();
 }
 
 clRowEntry* clTreeCtrlModel::GetItemFromIndex(int index) const
@@ -426,18 +477,7 @@ clRowEntry* clTreeCtrlModel::GetItemFromIndex(int index) const
     if(!m_root) {
         return nullptr;
     }
-    int curIndex = -1;
-    clRowEntry* current = m_root;
-    while(current) {
-        if(current->IsVisible()) {
-            ++curIndex;
-        }
-        if(curIndex == index) {
-            return current;
-        }
-        current = current->GetNext();
-    }
-    return nullptr;
+    return m_root->GetRowItem(index);
 }
 
 void clTreeCtrlModel::SelectChildren(const wxTreeItemId& item)
@@ -460,14 +500,11 @@ clRowEntry* clTreeCtrlModel::GetNextSibling(clRowEntry* item) const
         return nullptr;
     }
     const clRowEntry::Vec_t& children = item->GetParent()->GetChildren();
-    if(children.empty()) {
+    int index = item->GetParent()->GetChildIndex(item);
+    if(index == wxNOT_FOUND || (index + 1) >= (int)children.size()) {
         return nullptr;
     }
-    // if we couldnt find 'item' in the children list or if it's the last child
-    // return nullptr
-    auto it = std::find(children.begin(), std::prev(children.end()), item);
-    ++it;
-    return it == children.end() ? nullptr : *it;
+    return children[index + 1];
 }
 
 clRowEntry* clTreeCtrlModel::GetPrevSibling(clRowEntry* item) const
@@ -476,14 +513,11 @@ clRowEntry* clTreeCtrlModel::GetPrevSibling(clRowEntry* item) const
         return nullptr;
     }
     const clRowEntry::Vec_t& children = item->GetParent()->GetChildren();
-    if(children.empty()) {
+    int index = item->GetParent()->GetChildIndex(item);
+    if(index == wxNOT_FOUND || index == 0) {
         return nullptr;
     }
-    // if we couldnt find item in the children list or if it's the first child
-    // we return nullptr
-    auto rit = std::find(children.rbegin(), std::prev(children.rend()), item);
-    ++rit;
-    return rit == children.rend() ? nullptr : *rit;
+    return children[index - 1];
 }
 
 void clTreeCtrlModel::AddSelection(const wxTreeItemId& item)
@@ -572,6 +606,9 @@ clRowEntry* clTreeCtrlModel::GetRowBefore(clRowEntry* item, bool visibleItem) co
     if(!curp) {
         return nullptr;
     }
+    if(visibleItem && (curp->IsVisible() || curp->IsRoot())) {
+        return curp->GetPrevVisible();
+    }
     curp = curp->GetPrev();
     while(curp) {
         if(visibleItem && !curp->IsVisible()) {
@@ -589,6 +626,9 @@ clRowEntry* clTreeCtrlModel::GetRowAfter(clRowEntry* item, bool visibleItem) con
     if(!curp) {
         return nullptr;
     }
+    if(visibleItem && (curp->IsVisible() || curp->IsRoot())) {
+        return curp->GetNextVisible();
+    }
     curp = curp->GetNext();
     while(curp) {
         if(visibleItem && !curp->IsVisible()) {
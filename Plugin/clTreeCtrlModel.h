@@ -13,6 +13,24 @@
 
 class clTreeCtrl;
 typedef std::function<bool(clRowEntry*, clRowEntry*)> clSortFunc_t;
+
+/**
+ * @class clTreeCtrlDataSource
+ * @brief provides the children of the items marked with clTreeCtrl::SetItemHasChildren(). The children of an item are
+ * requested the first time it is expanded, so a huge tree can be populated one level at a time
+ */
+class WXDLLIMPEXP_SDK clTreeCtrlDataSource
+{
+public:
+    clTreeCtrlDataSource() {}
+    virtual ~clTreeCtrlDataSource() {}
+
+    /**
+     * @brief append the children of `item` to `tree`
+     */
+    virtual void LoadChildren(clTreeCtrl* tree, const wxTreeItemId& item) = 0;
+};
+
 class WXDLLIMPEXP_SDK clTreeCtrlModel
 {
     clTreeCtrl* m_tree = nullptr;
@@ -23,6 +41,7 @@ class WXDLLIMPEXP_SDK clTreeCtrlModel
     int m_indentSize = 16;
     bool m_shutdown = false;
     clSortFunc_t m_shouldInsertBeforeFunc = nullptr;
+    clTreeCtrlDataSource* m_dataSource = nullptr;
 
 protected:
     void DoExpandAllChildren(const wxTreeItemId& item, bool expand);
@@ -40,6 +59,14 @@ public:
     void SetSortFunction(const clSortFunc_t& CompareFunc) { m_shouldInsertBeforeFunc = CompareFunc; }
     clSortFunc_t GetSortFunction() const { return m_shouldInsertBeforeFunc; }
 
+    void SetDataSource(clTreeCtrlDataSource* dataSource) { this->m_dataSource = dataSource; }
+    clTreeCtrlDataSource* GetDataSource() const { return m_dataSource; }
+
+    /**
+     * @brief sort the children of `parent` with `CompareFunc`, keeping the order of the equal items
+     */
+    void SortChildren(clRowEntry* parent, const clSortFunc_t& CompareFunc);
+
     void ExpandAllChildren(const wxTreeItemId& item);
     void CollapseAllChildren(const wxTreeItemId& item);
 
@@ -47,6 +74,7 @@ public:
     void NodeDeleted(clRowEntry* node);
     void NodeExpanded(clRowEntry* node, bool expanded);
     bool NodeExpanding(clRowEntry* node, bool expanding);
+    void NodeLoadChildren(clRowEntry* node);
 
     void GetNextItems(clRowEntry* from, int count, clRowEntry::Vec_t& items, bool selfIncluded = true) const;
     void GetPrevItems(clRowEntry* from, int count, clRowEntry::Vec_t& items, bool selfIncluded = true) const;
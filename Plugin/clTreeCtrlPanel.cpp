@@ -15,6 +15,7 @@
 #include "imanager.h"
 #include "macros.h"
 
+#include <algorithm>
 #include <wx/app.h>
 #include <wx/dir.h>
 #include <wx/filename.h>
@@ -26,6 +27,22 @@
 
 namespace
 {
+/// the entries of a folder listed in the background are added to the tree in batches of this size
+constexpr size_t LISTING_BATCH_SIZE = 500;
+
+/// return true if `path` is `folder` or a path below it
+bool is_path_in_folder(const wxString& path, const wxString& folder)
+{
+    if (path == folder) {
+        return true;
+    }
+    wxString prefix = folder;
+    if (!prefix.EndsWith(wxFileName::GetPathSeparator())) {
+        prefix << wxFileName::GetPathSeparator();
+    }
+    return path.StartsWith(prefix);
+}
+
 bool should_colour_item_in_gray(clTreeCtrlData* entry)
 {
     if (!entry)
@@ -87,6 +104,7 @@ clTreeCtrlPanel::clTreeCtrlPanel(wxWindow* parent)
     EventNotifier::Get()->Bind(wxEVT_INIT_DONE, &clTreeCtrlPanel::OnInitDone, this);
     EventNotifier::Get()->Bind(wxEVT_FINDINFILES_DLG_SHOWING, &clTreeCtrlPanel::OnFindInFilesShowing, this);
     EventNotifier::Get()->Bind(wxEVT_FILE_CREATED, &clTreeCtrlPanel::OnFilesCreated, this);
+    GetTreeCtrl()->Bind(wxEVT_TREE_ITEM_COLLAPSED, &clTreeCtrlPanel::OnItemCollapsed, this);
     m_defaultView = new clTreeCtrlPanelDefaultPage(this);
     GetSizer()->Add(m_defaultView, 1, wxEXPAND);
     GetTreeCtrl()->Hide();
@@ -101,6 +119,23 @@ clTreeCtrlPanel::~clTreeCtrlPanel()
     EventNotifier::Get()->Unbind(wxEVT_INIT_DONE, &clTreeCtrlPanel::OnInitDone, this);
     EventNotifier::Get()->Unbind(wxEVT_FINDINFILES_DLG_SHOWING, &clTreeCtrlPanel::OnFindInFilesShowing, this);
     EventNotifier::Get()->Unbind(wxEVT_FILE_CREATED, &clTreeCtrlPanel::OnFilesCreated, this);
+    GetTreeCtrl()->Unbind(wxEVT_TREE_ITEM_COLLAPSED, &clTreeCtrlPanel::OnItemCollapsed, this);
+
+    // stop the listing thread, the batches it already posted are discarded with the pending events of this window
+    for (const auto& vt : m_listings) {
+        vt.second->cancelled = true;
+    }
+    m_listings.clear();
+    if (m_listingThread) {
+        {
+            std::lock_guard<std::mutex> lock(m_listingMutex);
+            m_listingShutdown = true;
+            m_listingQueue.clear();
+        }
+        m_listingCond.notify_one();
+        m_listingThread->join();
+        wxDELETE(m_listingThread);
+    }
 }
 
 void clTreeCtrlPanel::OnContextMenu(wxTreeEvent& event)
@@ -241,7 +276,42 @@ void clTreeCtrlPanel::OnItemExpanding(wxTreeEvent& event)
     event.Skip();
     wxTreeItemId item = event.GetItem();
     CHECK_ITEM_RET(item);
-    DoExpandItem(item, true);
+    DoExpandItemAsync(item);
+}
+
+void clTreeCtrlPanel::OnItemCollapsed(wxTreeEvent& event)
+{
+    event.Skip();
+    clTreeCtrlData* cd = GetItemData(event.GetItem());
+    CHECK_PTR_RET(cd);
+    if (!cd->IsFolder() || m_listings.empty()) {
+        return;
+    }
+
+    // the listings below the collapsed folder are cancelled. Their folders are listed again the next time they are
+    // expanded
+    std::vector<FolderListingPtr_t> cancelled;
+    for (const auto& vt : m_listings) {
+        if (is_path_in_folder(vt.first, cd->GetPath())) {
+            cancelled.push_back(vt.second);
+        }
+    }
+
+    // deepest folders first: resetting a folder deletes the folders below it
+    std::sort(cancelled.begin(), cancelled.end(), [](const FolderListingPtr_t& a, const FolderListingPtr_t& b) {
+        return a->path.length() > b->path.length();
+    });
+    for (const auto& listing : cancelled) {
+        listing->cancelled = true;
+        m_listings.erase(listing->path);
+
+        clTreeCtrlData* folderData = GetItemData(listing->item);
+        GetTreeCtrl()->DeleteChildren(listing->item);
+        if (folderData && folderData->GetIndex()) {
+            folderData->GetIndex()->Clear();
+        }
+        GetTreeCtrl()->AppendItem(listing->item, "Dummy", -1, -1, new clTreeCtrlData(clTreeCtrlData::kDummy));
+    }
 }
 
 void clTreeCtrlPanel::OnFolderDropped(clCommandEvent& event)
@@ -278,6 +348,15 @@ void clTreeCtrlPanel::DoExpandItem(const wxTreeItemId& parent, bool expand)
     if (!cd->IsDummy())
         return;
 
+    // the folder is listed right now, the entries already added by a background listing are kept. They were added
+    // unsorted, the folder is sorted once filled
+    bool listing_taken_over = false;
+    auto iter = m_listings.find(folderPath);
+    if (iter != m_listings.end()) {
+        iter->second->cancelled = true;
+        m_listings.erase(iter);
+        listing_taken_over = true;
+    }
     m_treeCtrl->Delete(child);
     cd = NULL;
 
@@ -314,6 +393,9 @@ void clTreeCtrlPanel::DoExpandItem(const wxTreeItemId& parent, bool expand)
     }
 
     // Sort the parent
+    if (listing_taken_over) {
+        GetTreeCtrl()->SortChildren(parent);
+    }
     if (GetTreeCtrl()->ItemHasChildren(parent)) {
         if (expand) {
             GetTreeCtrl()->Expand(parent);
@@ -322,6 +404,138 @@ void clTreeCtrlPanel::DoExpandItem(const wxTreeItemId& parent, bool expand)
     }
 }
 
+void clTreeCtrlPanel::DoExpandItemAsync(const wxTreeItemId& parent)
+{
+    clTreeCtrlData* cd = GetItemData(parent);
+    CHECK_PTR_RET(cd);
+
+    // we only know how to expand folders...
+    if (!cd->IsFolder() || !m_treeCtrl->ItemHasChildren(parent))
+        return;
+
+    // a folder that was not listed yet has a single dummy child
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = m_treeCtrl->GetFirstChild(parent, cookie);
+    CHECK_ITEM_RET(child);
+    clTreeCtrlData* childData = GetItemData(child);
+    CHECK_PTR_RET(childData);
+    if (!childData->IsDummy() || m_listings.count(cd->GetPath()))
+        return;
+
+    // the dummy child is shown until the listing completes
+    m_treeCtrl->SetItemText(child, _("Loading..."));
+
+    FolderListingPtr_t listing = std::make_shared<FolderListing>();
+    listing->item = parent;
+    listing->path = cd->GetPath();
+    listing->options = m_options;
+    listing->excludeFilePatterns = m_excludeFilePatterns;
+    m_listings.insert({ listing->path, listing });
+
+    {
+        std::lock_guard<std::mutex> lock(m_listingMutex);
+        m_listingQueue.push_back(listing);
+    }
+    if (!m_listingThread) {
+        m_listingThread = new std::thread(&clTreeCtrlPanel::ListingThreadMain, this);
+    }
+    m_listingCond.notify_one();
+    SelectItem(parent);
+}
+
+void clTreeCtrlPanel::ListingThreadMain()
+{
+    std::unique_lock<std::mutex> lock(m_listingMutex);
+    while (true) {
+        m_listingCond.wait(lock, [this]() { return m_listingShutdown || !m_listingQueue.empty(); });
+        if (m_listingShutdown) {
+            break;
+        }
+        FolderListingPtr_t listing = m_listingQueue.front();
+        m_listingQueue.pop_front();
+        lock.unlock();
+
+        clFilesScanner::EntryData::Vec_t batch;
+        clFilesScanner scanner;
+        scanner.ScanNoRecurse(listing->path, [&](const clFilesScanner::EntryData& entry) {
+            if (listing->cancelled) {
+                return false;
+            }
+
+            bool hidden = entry.flags & clFilesScanner::kIsHidden;
+            if (entry.flags & clFilesScanner::kIsFolder) {
+                if (hidden && !(listing->options & kShowHiddenFolders)) {
+                    return true;
+                }
+            } else if (hidden && !(listing->options & kShowHiddenFiles)) {
+                return true;
+            } else if (!listing->excludeFilePatterns.empty() &&
+                       FileUtils::WildMatch(listing->excludeFilePatterns, entry.fullpath)) {
+                return true;
+            }
+
+            batch.push_back(entry);
+            if (batch.size() >= LISTING_BATCH_SIZE) {
+                CallAfter([this, listing, batch]() { DoAddListingEntries(listing, batch, false); });
+                batch.clear();
+            }
+            return true;
+        });
+
+        if (!listing->cancelled) {
+            CallAfter([this, listing, batch]() { DoAddListingEntries(listing, batch, true); });
+        }
+        lock.lock();
+    }
+}
+
+void clTreeCtrlPanel::DoAddListingEntries(FolderListingPtr_t listing, const clFilesScanner::EntryData::Vec_t& entries,
+                                          bool done)
+{
+    if (listing->cancelled) {
+        return;
+    }
+
+    // the entries are appended in the listing order and sorted once the listing completes
+    const wxTreeItemId& parent = listing->item;
+    GetTreeCtrl()->Begin();
+    GetTreeCtrl()->ReserveChildren(parent, entries.size());
+    for (const auto& entry : entries) {
+        if (entry.flags & clFilesScanner::kIsFolder) {
+            DoAddFolder(parent, entry.fullpath);
+        } else {
+            DoAddFile(parent, entry.fullpath);
+        }
+    }
+
+    if (done) {
+        m_listings.erase(listing->path);
+
+        // remove the "Loading..." item
+        wxTreeItemIdValue cookie;
+        wxTreeItemId child = GetTreeCtrl()->GetFirstChild(parent, cookie);
+        clTreeCtrlData* cd = GetItemData(child);
+        if (cd && cd->IsDummy()) {
+            GetTreeCtrl()->Delete(child);
+        }
+        GetTreeCtrl()->SortChildren(parent);
+    }
+    GetTreeCtrl()->Commit();
+}
+
+void clTreeCtrlPanel::DoCancelListings(const wxString& path)
+{
+    auto iter = m_listings.begin();
+    while (iter != m_listings.end()) {
+        if (is_path_in_folder(iter->first, path)) {
+            iter->second->cancelled = true;
+            iter = m_listings.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
 clTreeCtrlData* clTreeCtrlPanel::GetItemData(const wxTreeItemId& item) const
 {
     CHECK_ITEM_RET_NULL(item);
@@ -332,7 +546,7 @@ clTreeCtrlData* clTreeCtrlPanel::GetItemData(const wxTreeItemId& item) const
 void clTreeCtrlPanel::AddFolder(const wxString& path)
 {
     wxTreeItemId itemFolder = DoAddFolder(GetTreeCtrl()->GetRootItem(), path);
-    DoExpandItem(itemFolder, false);
+    DoExpandItemAsync(itemFolder);
     ToggleView();
 }
 
@@ -847,6 +1061,11 @@ void clTreeCtrlPanel::UpdateItemDeleted(const wxTreeItemId& item)
     clTreeCtrlData* parentData = GetItemData(parent);
     wxString text = GetTreeCtrl()->GetItemText(item);
 
+    clTreeCtrlData* cd = GetItemData(item);
+    if (cd && cd->IsFolder()) {
+        DoCancelListings(cd->GetPath());
+    }
+
     // Update the parent cache
     if (parentData->GetIndex()) {
         parentData->GetIndex()->Delete(text);
@@ -958,6 +1177,10 @@ void clTreeCtrlPanel::DoCloseFolder(const wxTreeItemId& item)
         }
         GetConfig()->Write("ExplorerFolders", pinnedFolders);
     }
+    clTreeCtrlData* cd = GetItemData(item);
+    if (cd) {
+        DoCancelListings(cd->GetPath());
+    }
     // Now, delete the item
     GetTreeCtrl()->Delete(item);
 
@@ -1124,6 +1347,7 @@ void clTreeCtrlPanel::RefreshNonTopLevelFolder(const wxTreeItemId& item)
     }
 
     // Clear the item children
+    DoCancelListings(cd->GetPath());
     GetTreeCtrl()->DeleteChildren(item);
 
     // Append the dummy item
@@ -1169,6 +1393,7 @@ void clTreeCtrlPanel::OnRenameFolder(wxCommandEvent& event)
     LOG_IF_TRACE { clDEBUG1() << "Renaming:" << oldFullPath.GetPath() << "->" << newFullPath.GetPath(); }
     if (::wxRename(oldFullPath.GetPath(), newFullPath.GetPath()) == 0) {
         // Rename was successful
+        DoCancelListings(d->GetPath());
         d->SetPath(newFullPath.GetPath());
         m_treeCtrl->SetItemText(item, newName);
         CallAfter(&clTreeCtrlPanel::RefreshNonTopLevelFolder, item);
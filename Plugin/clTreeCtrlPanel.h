@@ -30,12 +30,22 @@
 #include "clEnhancedToolBar.hpp"
 #include "clFileSystemEvent.h"
 #include "clFileViwerTreeCtrl.h"
+#include "clFilesCollector.h"
 #include "clToolBar.h"
 #include "cl_command_event.h"
 #include "cl_config.h"
 #include "imanager.h"
 #include "wxcrafter_plugin.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 class clTreeCtrlPanelDefaultPage;
 class WXDLLIMPEXP_SDK clTreeCtrlPanel : public clTreeCtrlPanelBase
 {
@@ -57,6 +67,24 @@ protected:
     clToolBar* m_toolbar = nullptr;
     wxString m_excludeFilePatterns;
 
+    /// A folder listed in the background. The entries are added to the tree in batches, a "Loading..." row is shown
+    /// until the listing completes. Collapsing or closing the folder cancels its listing
+    struct FolderListing {
+        wxTreeItemId item;
+        wxString path;
+        int options = 0;
+        wxString excludeFilePatterns;
+        std::atomic_bool cancelled{ false };
+    };
+    typedef std::shared_ptr<FolderListing> FolderListingPtr_t;
+
+    std::unordered_map<wxString, FolderListingPtr_t> m_listings; // by folder path
+    std::deque<FolderListingPtr_t> m_listingQueue;
+    std::mutex m_listingMutex;
+    std::condition_variable m_listingCond;
+    std::thread* m_listingThread = nullptr;
+    bool m_listingShutdown = false;
+
 protected:
     void ToggleView();
     void RefreshNonTopLevelFolder(const wxTreeItemId& item);
@@ -191,6 +219,17 @@ protected:
     void OnOpenFolder(wxCommandEvent& event);
     // Helpers
     void DoExpandItem(const wxTreeItemId& parent, bool expand);
+    /**
+     * @brief list the folder `parent` in the background. Does nothing if the folder was already listed
+     */
+    void DoExpandItemAsync(const wxTreeItemId& parent);
+    /**
+     * @brief cancel the background listing of `path` and of the folders below it
+     */
+    void DoCancelListings(const wxString& path);
+    void DoAddListingEntries(FolderListingPtr_t listing, const clFilesScanner::EntryData::Vec_t& entries, bool done);
+    void ListingThreadMain();
+    void OnItemCollapsed(wxTreeEvent& event);
     void DoRenameItem(const wxTreeItemId& item, const wxString& oldname, const wxString& newname);
 
     bool IsTopLevelFolder(const wxTreeItemId& item);
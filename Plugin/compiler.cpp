@@ -690,10 +690,10 @@ void Compiler::AddDefaultGnuCompilerLinkerOptions()
                             "Link-Time Optimization (Eliminates duplicate template functions and unused code)");
 }
 
-wxArrayString Compiler::GetDefaultIncludePaths()
+wxArrayString Compiler::GetDefaultIncludePaths(const wxString& flags)
 {
     if(HasMetadata()) {
-        return GetMetadata().GetSearchPaths();
+        return GetMetadata(flags).GetSearchPaths();
     } else {
         return {};
     }
@@ -737,11 +737,11 @@ void Compiler::CreatePathEnv(clEnvList_t* env_list)
     env_list->push_back({ "PATH", compiler_path.GetPath() + clPATH_SEPARATOR + env_path });
 }
 
-GCCMetadata Compiler::GetMetadata() const
+GCCMetadata Compiler::GetMetadata(const wxString& flags) const
 {
     // cmd.Load() fetches the metadata from a shared cache so its a cheap operation
     GCCMetadata cmd(GetName());
-    cmd.Load(GetTool("CXX"), GetInstallationPath(), GetCompilerFamily() == COMPILER_FAMILY_CYGWIN);
+    cmd.Load(GetTool("CXX"), GetInstallationPath(), GetCompilerFamily() == COMPILER_FAMILY_CYGWIN, flags);
     return cmd;
 }
 
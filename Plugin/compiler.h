@@ -146,8 +146,10 @@ public:
 
     /**
      * @brief return the compiler default include paths
+     * @param flags compiler flags that change the search paths (e.g. -m32 or --sysroot), see
+     * GCCMetadata::GetMetadataFlags()
      */
-    wxArrayString GetDefaultIncludePaths();
+    wxArrayString GetDefaultIncludePaths(const wxString& flags = wxEmptyString);
 
     /**
      * @brief return true if this compiler is compatible with GNU compilers
@@ -240,9 +242,9 @@ public:
     }
     bool GetObjectNameIdenticalToFileName() const { return m_objectNameIdenticalToFileName; }
     /**
-     * @brief return the compiler metadata info
+     * @brief return the compiler metadata info, as reported when the compiler is run with `flags`
      */
-    GCCMetadata GetMetadata() const;
+    GCCMetadata GetMetadata(const wxString& flags = wxEmptyString) const;
 
     /**
      * @brief does this compiler support metadata object?
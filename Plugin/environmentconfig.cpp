@@ -261,6 +261,17 @@ wxArrayString EnvironmentConfig::GetActiveSetEnvNames(bool includeWorkspace, con
     return envnames;
 }
 
+wxArrayString EnvironmentConfig::GetAppliedEnvNames()
+{
+    wxCriticalSectionLocker locker(m_cs);
+    wxArrayString envnames;
+    envnames.reserve(m_envSnapshot.size());
+    for (const auto& vt : m_envSnapshot) {
+        envnames.Add(vt.first);
+    }
+    return envnames;
+}
+
 // --------------------------------------------------------------------------
 // --------------------------------------------------------------------------
 // --------------------------------------------------------------------------
@@ -76,6 +76,12 @@ public:
      */
     wxArrayString GetActiveSetEnvNames(bool includeWorkspace = true, const wxString& project = wxEmptyString);
 
+    /**
+     * @brief return the names of the variables applied by the EnvSetter currently in scope (global, workspace and
+     * project variables, plus the override map). Empty if no EnvSetter is in scope
+     */
+    wxArrayString GetAppliedEnvNames();
+
 private:
     EnvironmentConfig();
     virtual ~EnvironmentConfig();
@@ -56,6 +56,14 @@ EVT_TIMER(XRCID("OR_TIMER"), OpenResourceDialog::OnTimer)
 END_EVENT_TABLE()
 
 wxDEFINE_EVENT(wxEVT_OPEN_RESOURCE_FILE_SELECTED, clCommandEvent);
+wxDEFINE_EVENT(wxEVT_OPEN_RESOURCE_USAGE_NEEDED, clCommandEvent);
+wxDEFINE_EVENT(wxEVT_OPEN_RESOURCE_FILES_OPENED, clCommandEvent);
+
+namespace
+{
+/// the bonus of the file the user opens the most, see DoLoadUsage()
+constexpr int USAGE_BONUS = 48;
+} // namespace
 
 OpenResourceDialog::OpenResourceDialog(wxWindow* parent, IManager* manager, const wxString& initialSelection)
     : OpenResourceDialogBase(parent)
@@ -101,17 +109,17 @@ OpenResourceDialog::OpenResourceDialog(wxWindow* parent, IManager* manager, cons
                 ProjectPtr p = m_manager->GetWorkspace()->GetProject(projects.Item(i));
                 if (p) {
                     const Project::FilesMap_t& files = p->GetFiles();
-                    // convert std::vector to wxArrayString
-                    std::for_each(files.begin(), files.end(), [&](const Project::FilesMap_t::value_type& vt) {
-                        wxFileName fn(vt.second->GetFilename());
-                        m_files.insert(std::make_pair(fn.GetFullName(), fn.GetFullPath()));
-                    });
+                    m_files.Reserve(m_files.GetCount() + files.size());
+                    for (const auto& vt : files) {
+                        m_files.Add(vt.second->GetFilename());
+                    }
                 }
             }
         } else if (clFileSystemWorkspace::Get().IsOpen()) {
-            const std::vector<wxFileName>& files = clFileSystemWorkspace::Get().GetFiles();
-            for (const wxFileName& fn : files) {
-                m_files.insert({ fn.GetFullName(), fn.GetFullPath() });
+            const std::vector<clPath>& files = clFileSystemWorkspace::Get().GetFiles();
+            m_files.Reserve(files.size());
+            for (const clPath& path : files) {
+                m_files.Add(path.GetFullPath());
             }
         }
     } else if (clWorkspaceManager::Get().IsWorkspaceOpened()) {
@@ -119,18 +127,17 @@ OpenResourceDialog::OpenResourceDialog(wxWindow* parent, IManager* manager, cons
         wxArrayString files;
         clWorkspaceManager::Get().GetWorkspace()->GetWorkspaceFiles(files);
         wxStringSet_t unique_files;
-        m_files.reserve(files.size());
+        m_files.Reserve(files.size());
         for (const auto& file : files) {
-            if (unique_files.count(file) == 0) {
-                unique_files.insert(file);
-                wxFileName fn(file);
+            if (unique_files.insert(file).second) {
                 // keep the file as-is do not "format" it by calling
                 // fn.GetFullPath() since we might be on Windows and we display
                 // Linux path style files
-                m_files.insert({ fn.GetFullName(), file });
+                m_files.Add(file);
             }
         }
     }
+    DoLoadUsage();
 
     wxString lastStringTyped = clConfig::Get().Read("OpenResourceDialog/SearchString", wxString());
     // Set the initial selection
@@ -163,6 +170,43 @@ OpenResourceDialog::~OpenResourceDialog()
     clConfig::Get().Write("OpenResourceDialog/ShowFiles", m_checkBoxFiles->IsChecked());
     clConfig::Get().Write("OpenResourceDialog/ShowSymbols", m_checkBoxShowSymbols->IsChecked());
     clConfig::Get().Write("OpenResourceDialog/SearchString", m_textCtrlResourceName->GetValue());
+
+    if (GetReturnCode() == wxID_OK) {
+        wxArrayString files;
+        for (OpenResourceDialogItemData* data : GetSelections()) {
+            // only the files, not the symbols
+            if (data->m_isFile) {
+                files.Add(data->m_file);
+            }
+        }
+        if (!files.empty()) {
+            clCommandEvent filesOpenedEvent(wxEVT_OPEN_RESOURCE_FILES_OPENED);
+            filesOpenedEvent.SetStrings(files);
+            EventNotifier::Get()->AddPendingEvent(filesOpenedEvent);
+        }
+    }
+}
+
+void OpenResourceDialog::DoLoadUsage()
+{
+    if (m_files.IsEmpty()) {
+        return;
+    }
+
+    clCommandEvent usageEvent(wxEVT_OPEN_RESOURCE_USAGE_NEEDED);
+    EventNotifier::Get()->ProcessEvent(usageEvent);
+    const wxArrayString& files = usageEvent.GetStrings();
+    if (files.empty()) {
+        return;
+    }
+
+    // the most used file gets the full bonus, the others less according to their rank
+    std::unordered_map<wxString, int> bonuses;
+    bonuses.reserve(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        bonuses.insert({ files.Item(i), std::max(1, int(USAGE_BONUS * (files.size() - i) / files.size())) });
+    }
+    m_files.SetBonuses(bonuses);
 }
 
 void OpenResourceDialog::OnText(wxCommandEvent& event)
@@ -212,6 +256,7 @@ void OpenResourceDialog::DoPopulateList()
     clDEBUG() << "Open resource:" << name << ":" << nLineNumber << ":" << nColumn << endl;
     m_lineNumber = nLineNumber;
     m_column = nColumn;
+    m_query.Reset(name);
 
     // Prepare the user filter
     m_userFilters.Clear();
@@ -272,23 +317,19 @@ void OpenResourceDialog::DoPopulateWorkspaceFile()
         return;
     }
 
-    if (!m_userFilters.empty()) {
-
-        std::unordered_multimap<wxString, wxString>::iterator iter = m_files.begin();
-        const int maxFileSize = 100;
-        int counter = 0;
-        for (; (iter != m_files.end()) && (counter < maxFileSize); iter++) {
-            const wxString& fullpath = iter->second;
-            if (!MatchesFilter(fullpath)) {
-                continue;
-            }
+    if (m_query.IsEmpty()) {
+        return;
+    }
 
-            wxFileName fn(iter->second);
-            int imgId = clGetManager()->GetStdIcons()->GetMimeImageId(fn.GetFullName());
-            DoAppendLine(fn.GetFullName(), iter->second, false,
-                         new OpenResourceDialogItemData(iter->second, -1, "", fn.GetFullName(), ""), imgId);
-            ++counter;
-        }
+    // the best matches, best first
+    const size_t maxFileSize = 100;
+    for (const clFuzzyMatcher::Match& match : m_files.Find(m_query, maxFileSize)) {
+        wxString fullpath = m_files.GetText(match.index);
+        wxString fullname = m_files.GetBasename(match.index);
+        int imgId = clGetManager()->GetStdIcons()->GetMimeImageId(fullname);
+        OpenResourceDialogItemData* data = new OpenResourceDialogItemData(fullpath, -1, "", fullname, "");
+        data->m_isFile = true;
+        DoAppendLine(fullname, fullpath, false, data, imgId);
     }
 }
 
@@ -300,6 +341,7 @@ void OpenResourceDialog::Clear()
         wxDELETE(cd);
     });
     m_userFilters.Clear();
+    m_query.Reset(wxEmptyString);
 }
 
 void OpenResourceDialog::OpenSelection(const OpenResourceDialogItemData& selection, IManager* manager)
@@ -414,10 +456,8 @@ int OpenResourceDialog::DoGetTagImg(const LSP::SymbolInformation& symbol)
 
 bool OpenResourceDialog::MatchesFilter(const wxString& name)
 {
-    wxString mod_filter;
-    long line_number, column_number;
-    GetLineAndColumnFromFilter(m_textCtrlResourceName->GetValue(), mod_filter, line_number, column_number);
-    return FileUtils::FuzzyMatch(mod_filter, name);
+    // the filter, without the line and column, as parsed by DoPopulateList()
+    return FileUtils::FuzzyMatch(m_query.GetFilter(), name);
 }
 
 void OpenResourceDialog::OnCheckboxfilesCheckboxClicked(wxCommandEvent& event) { DoPopulateList(); }
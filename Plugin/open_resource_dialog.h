@@ -29,6 +29,7 @@
 #include "LSP/LSPEvent.h"
 #include "LSP/basic_types.h"
 #include "cl_command_event.h"
+#include "clFuzzyMatcher.hpp"
 #include "codelite_exports.h"
 #include "database/entry.h"
 #include "fileextmanager.h"
@@ -53,6 +54,7 @@ public:
     wxString m_name;
     wxString m_scope;
     bool m_impl;
+    bool m_isFile = false;
 
 public:
     OpenResourceDialogItemData()
@@ -91,7 +93,8 @@ template <> struct hash<LSP::eSymbolKind> {
 class WXDLLIMPEXP_SDK OpenResourceDialog : public OpenResourceDialogBase
 {
     IManager* m_manager;
-    std::unordered_multimap<wxString, wxString> m_files;
+    clFuzzyMatcher m_files;
+    clFuzzyQuery m_query;
     std::unordered_map<LSP::eSymbolKind, int> m_fileTypeHash;
     wxTimer* m_timer;
     bool m_needRefresh;
@@ -119,6 +122,7 @@ protected:
     int DoGetTagImg(const LSP::SymbolInformation& symbol);
     OpenResourceDialogItemData* GetItemData(const wxDataViewItem& item) const;
     void OnSelectAllText();
+    void DoLoadUsage();
 
 protected:
     // Handlers for OpenResourceDialogBase events.
@@ -150,4 +154,9 @@ public:
 };
 
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_OPEN_RESOURCE_FILE_SELECTED, clCommandEvent);
+// The dialog is loading the workspace files: a handler can rank the files the user opens the most first, by placing
+// their full paths, most used first, in event.GetStrings()
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_OPEN_RESOURCE_USAGE_NEEDED, clCommandEvent);
+// The user opened files from the dialog, their full paths are in event.GetStrings()
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_OPEN_RESOURCE_FILES_OPENED, clCommandEvent);
 #endif // __open_resource_dialog__
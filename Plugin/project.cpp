@@ -33,11 +33,13 @@
 #include "environmentconfig.h"
 #include "event_notifier.h"
 #include "fileextmanager.h"
+#include "file_logger.h"
 #include "fileutils.h"
 #include "globals.h"
 #include "localworkspace.h"
 #include "macromanager.h"
 #include "macros.h"
+#include "md5/wxmd5.h"
 #include "plugin.h"
 #include "workspace.h"
 #include "wxArrayStringAppender.h"
@@ -52,7 +54,6 @@
 #include <wx/sstream.h>
 #include <wx/tokenzr.h>
 
-// Make the m_backticks thread safe
 #define EXCLUDE_FROM_BUILD_FOR_CONFIG "ExcludeProjConfig"
 
 // ============---------------------
@@ -116,9 +117,14 @@ bool Project::Create(const wxString& name, const wxString& description, const wx
     return true;
 }
 
-bool Project::Load(const wxString& path)
+bool Project::Load(const wxString& path) { return DoLoadXml(path) && DoFinishLoad(); }
+
+bool Project::DoLoadXml(const wxString& path, wxXmlNode* root)
 {
-    if (!m_doc.Load(path)) {
+    if (root) {
+        m_doc = wxXmlDocument();
+        m_doc.SetRoot(root);
+    } else if (!m_doc.Load(path)) {
         return false;
     }
 
@@ -133,10 +139,15 @@ bool Project::Load(const wxString& path)
     m_projectPath = m_fileName.GetPath();
 
     DoBuildCacheFromXml();
+    DoUpdateProjectSettings();
+    return true;
+}
+
+bool Project::DoFinishLoad()
+{
     SetModified(true);
     SetProjectLastModifiedTime(GetFileLastModifiedTime());
 
-    DoUpdateProjectSettings();
     bool saveNeeded = false;
     if (GetVersionNumber() < CURRENT_WORKSPACE_VERSION) {
         saveNeeded = true;
@@ -548,6 +559,37 @@ void Project::CopyTo(const wxString& new_path, const wxString& new_name, const w
     doc.Save(newFile.GetFullPath());
 }
 
+void Project::DoAddFileToTable(clProjectFile::Ptr_t file)
+{
+    auto where = m_filesTable.insert({ file->GetFilename(), file });
+    if (where.second && m_workspace) {
+        // the index refers to the key stored in the table
+        m_workspace->DoIndexFile(this, where.first->first);
+    }
+}
+
+void Project::DoRemoveFileFromTable(const wxString& fullpath)
+{
+    auto iter = m_filesTable.find(fullpath);
+    if (iter == m_filesTable.end()) {
+        return;
+    }
+    if (m_workspace) {
+        m_workspace->DoUnindexFile(this, iter->first);
+    }
+    m_filesTable.erase(iter);
+}
+
+void Project::DoClearFilesTable()
+{
+    if (m_workspace) {
+        for (const auto& vt : m_filesTable) {
+            m_workspace->DoUnindexFile(this, vt.first);
+        }
+    }
+    m_filesTable.clear();
+}
+
 clProjectFile::Ptr_t Project::FileFromXml(wxXmlNode* node, const wxString& vd)
 {
     clProjectFile::Ptr_t file(new clProjectFile());
@@ -583,7 +625,7 @@ clProjectFile::Ptr_t Project::FileFromXml(wxXmlNode* node, const wxString& vd)
 
 void Project::DoBuildCacheFromXml()
 {
-    m_filesTable.clear();
+    DoClearFilesTable();
     m_virtualFoldersTable.clear();
 
     // Update the cache from the XML
@@ -599,7 +641,7 @@ void Project::DoBuildCacheFromXml()
             if (child->GetName() == "File" && folder) {
                 clProjectFile::Ptr_t file = FileFromXml(child, folder->GetFullpath());
                 // Cache the file
-                m_filesTable.insert({ file->GetFilename(), file });
+                DoAddFileToTable(file);
                 // Add this file to the folder
                 folder->GetFiles().insert(file->GetFilename());
 
@@ -626,7 +668,7 @@ void Project::SetFiles(ProjectPtr src)
         delete vd;
         vd = XmlUtils::FindFirstByTagName(m_doc.GetRoot(), "VirtualDirectory");
     }
-    m_filesTable.clear();
+    DoClearFilesTable();
     m_virtualFoldersTable.clear();
 
     // sanity
@@ -880,6 +922,16 @@ void Project::SetAllPluginsData(const std::map<wxString, wxString>& pluginsDataM
 
 time_t Project::GetFileLastModifiedTime() const { return GetFileModificationTime(GetFileName()); }
 
+size_t Project::GetXmlHash() const
+{
+    wxString projectXml;
+    wxStringOutputStream sos(&projectXml);
+    if (m_doc.IsOk()) {
+        m_doc.Save(sos);
+    }
+    return std::hash<wxString>{}(projectXml);
+}
+
 void Project::ConvertToUnixFormat(wxXmlNode* parent)
 {
     if (!parent) {
@@ -1053,7 +1105,7 @@ void Project::ClearAllVirtDirs()
     clProjectFolder::Ptr_t rootFolder = GetRootFolder();
     rootFolder->DeleteRecursive(this);
     m_virtualFoldersTable.clear();
-    m_filesTable.clear();
+    DoClearFilesTable();
     SetModified(true);
     SaveXmlFile();
 }
@@ -1324,38 +1376,75 @@ wxString Project::GetCompileLineForCXXFile(const wxStringMap_t& compilersGlobalP
     return commandLine;
 }
 
-wxString Project::DoExpandBacktick(const wxString& backtick)
+namespace
+{
+/// return true if `option` is a backtick (or `$(shell ...)`) compiler option, and set `command` to the command it
+/// runs
+bool GetBacktickCommand(const wxString& option, wxString& command)
 {
     wxString tmp;
+    if (!option.StartsWith("$(shell ", &tmp) && !option.StartsWith("`", &tmp)) {
+        return false;
+    }
+    command = tmp;
+    tmp.Clear();
+    if (command.EndsWith(")", &tmp) || command.EndsWith("`", &tmp)) {
+        command = tmp;
+    }
+    return true;
+}
+} // namespace
+
+wxString Project::DoExpandBacktick(const wxString& backtick)
+{
     wxString cmpOption = backtick;
     cmpOption.Trim().Trim(false);
 
     // Expand backticks / $(shell ...) syntax supported by codelite
-    if (cmpOption.StartsWith("$(shell ", &tmp) || cmpOption.StartsWith("`", &tmp)) {
-        cmpOption = tmp;
-        tmp.Clear();
-        if (cmpOption.EndsWith(")", &tmp) || cmpOption.EndsWith("`", &tmp)) {
-            cmpOption = tmp;
-        }
+    wxString command;
+    if (!GetBacktickCommand(cmpOption, command)) {
+        return cmpOption;
+    }
 
-        // Expand the backticks into their value
-        wxString expandedValue;
-        {
-            EnvSetter es(NULL, NULL, GetName(), wxEmptyString);
-            cmpOption = MacroManager::Instance()->Expand(cmpOption, nullptr, GetName(), wxEmptyString);
-
-            // Check the cache
-            if (!GetWorkspace()->GetBacktickValue(cmpOption, expandedValue)) {
-                IProcess::Ptr_t p(::CreateSyncProcess(cmpOption, IProcessCreateDefault, GetFileName().GetPath()));
-                if (p) {
-                    p->WaitForTerminate(expandedValue);
-                }
-                GetWorkspace()->SetBacktickValue(cmpOption, expandedValue);
-            }
-            return expandedValue;
+    // Expand the backticks into their value
+    EnvSetter es(NULL, NULL, GetName(), wxEmptyString);
+    command = MacroManager::Instance()->Expand(command, nullptr, GetName(), wxEmptyString);
+
+    // Check the cache. Usually the expansion was started in the background when the workspace was loaded
+    clBacktickCache::ptr_t cache = GetWorkspace()->GetBacktickCache();
+    if (cache) {
+        return cache->Expand(command, GetFileName().GetPath());
+    }
+
+    wxString expandedValue;
+    IProcess::Ptr_t p(::CreateSyncProcess(command, IProcessCreateDefault, GetFileName().GetPath()));
+    if (p) {
+        p->WaitForTerminate(expandedValue);
+    }
+    return expandedValue;
+}
+
+void Project::PrefetchBacktickExpansions()
+{
+    clBacktickCache::ptr_t cache = GetWorkspace()->GetBacktickCache();
+    BuildConfigPtr buildConf = GetBuildConfiguration();
+    if (!cache || !buildConf || buildConf->IsCustomBuild()) {
+        return;
+    }
+
+    // the same environment as DoExpandBacktick(), so the results are found by the same keys
+    EnvSetter es(NULL, NULL, GetName(), wxEmptyString);
+    wxString options;
+    options << buildConf->GetCompileOptions() << ";" << buildConf->GetCCompileOptions();
+    wxArrayString optionsArr = ::wxStringTokenize(options, ";", wxTOKEN_STRTOK);
+    for (wxString& option : optionsArr) {
+        option.Trim().Trim(false);
+        wxString command;
+        if (GetBacktickCommand(option, command)) {
+            command = MacroManager::Instance()->Expand(command, nullptr, GetName(), wxEmptyString);
+            cache->Prefetch(command, GetFileName().GetPath());
         }
     }
-    return cmpOption;
 }
 
 void Project::CreateCompileCommandsJSON(JSONItem& compile_commands, const wxStringMap_t& compilersGlobalPaths,
@@ -1401,6 +1490,89 @@ void Project::CreateCompileCommandsJSON(JSONItem& compile_commands, const wxStri
     }
 }
 
+static void AppendJSONString(wxString& out, const wxString& str)
+{
+    out << "\"";
+    for (wxUniChar ch : str) {
+        if (ch == '"' || ch == '\\') {
+            out << "\\" << ch;
+        } else if (ch < 0x20) {
+            out << wxString::Format("\\u%04x", (int)ch.GetValue());
+        } else {
+            out << ch;
+        }
+    }
+    out << "\"";
+}
+
+wxString Project::GetCompileCommandsFragment(const wxStringMap_t& compilersGlobalPaths, const wxString& cacheDir)
+{
+    BuildConfigPtr buildConf = GetBuildConfiguration();
+    wxString cFilePattern =
+        GetCompileLineForCXXFile(compilersGlobalPaths, buildConf, "$FileName", kWrapIncludesWithSpace);
+    wxString cxxFilePattern =
+        GetCompileLineForCXXFile(compilersGlobalPaths, buildConf, "$FileName", kCxxFile | kWrapIncludesWithSpace);
+    wxString workingDirectory = m_fileName.GetPath();
+
+    // sort the files, so an unchanged project always produces the same text
+    std::vector<wxString> files;
+    files.reserve(m_filesTable.size());
+    for (const auto& vt : m_filesTable) {
+        files.push_back(vt.first);
+    }
+    std::sort(files.begin(), files.end());
+
+    // the fragment is valid as long as its inputs are the same: the compile lines (the flags of the configuration)
+    // and the files
+    wxString key;
+    key << cFilePattern << "\n" << cxxFilePattern << "\n" << workingDirectory << "\n";
+    for (const wxString& fullpath : files) {
+        key << fullpath << "\n";
+    }
+    key = wxMD5::GetDigest(key);
+
+    wxFileName cacheFile(cacheDir, GetName() + ".json");
+    wxString cached, fragment;
+    if (cacheFile.FileExists() && FileUtils::ReadFileContent(cacheFile, cached) &&
+        cached.StartsWith(key + "\n", &fragment)) {
+        return fragment;
+    }
+
+    for (const wxString& fullpath : files) {
+        wxString compilePattern;
+        FileExtManager::FileType fileType = FileExtManager::GetType(fullpath);
+        if (fileType == FileExtManager::TypeSourceC) {
+            compilePattern = cFilePattern;
+        } else if (fileType == FileExtManager::TypeSourceCpp || fileType == FileExtManager::TypeHeader) {
+            compilePattern = cxxFilePattern;
+        } else {
+            continue;
+        }
+
+        wxString file_name = fullpath;
+        if (file_name.Contains(" ")) {
+            file_name.Prepend("\"").Append("\"");
+        }
+        compilePattern.Replace("$FileName", file_name);
+
+        if (!fragment.empty()) {
+            fragment << ",\n";
+        }
+        fragment << "  {\n    \"file\": ";
+        AppendJSONString(fragment, fullpath);
+        fragment << ",\n    \"directory\": ";
+        AppendJSONString(fragment, workingDirectory);
+        fragment << ",\n    \"command\": ";
+        AppendJSONString(fragment, compilePattern);
+        fragment << "\n  }";
+    }
+
+    if (!FileUtils::WriteFileContent(cacheFile, key + "\n" + fragment)) {
+        clWARNING() << "Failed to write compile commands cache:" << cacheFile << endl;
+    }
+    return fragment;
+}
+
 BuildConfigPtr Project::GetBuildConfiguration(const wxString& configName) const
 {
     BuildMatrixPtr matrix = GetWorkspace()->GetBuildMatrix();
@@ -1937,8 +2109,8 @@ bool clProjectFolder::RenameFile(Project* project, const wxString& fullpath, con
     m_files.insert(file->GetFilename());
 
     // Update the project files table
-    project->m_filesTable.erase(fullpath);
-    project->m_filesTable.insert({ file->GetFilename(), file });
+    project->DoRemoveFileFromTable(fullpath);
+    project->DoAddFileToTable(file);
     return true;
 }
 
@@ -2106,7 +2278,7 @@ clProjectFile::Ptr_t clProjectFolder::AddFile(Project* project, const wxString&
     file->SetVirtualFolder(GetFullpath());
 
     // Add thie file to the cache
-    project->m_filesTable.insert({ fullpath, file });
+    project->DoAddFileToTable(file);
     m_files.insert(fullpath);
     return file;
 }
@@ -2114,7 +2286,7 @@ clProjectFile::Ptr_t clProjectFolder::AddFile(Project* project, const wxString&
 void clProjectFile::Delete(Project* project, bool deleteXml)
 {
     // Remove this file from the files-cache
-    project->m_filesTable.erase(GetFilename());
+    project->DoRemoveFileFromTable(GetFilename());
 
     if (deleteXml && m_xmlNode) {
         wxXmlNode* parent = m_xmlNode->GetParent();
@@ -335,6 +335,19 @@ private:
 private:
     void DoUpdateProjectSettings();
     void DoBuildCacheFromXml();
+    /**
+     * @brief update the files table, keeping the files index of the workspace in sync
+     */
+    void DoAddFileToTable(clProjectFile::Ptr_t file);
+    void DoRemoveFileFromTable(const wxString& fullpath);
+    void DoClearFilesTable();
+    /**
+     * @brief the two steps of Load(). DoLoadXml() only touches this project, so the workspace runs it for several
+     * projects concurrently; DoFinishLoad() must run on the main thread.
+     * If `root` is set, it is used as the XML tree of the project instead of parsing `path`
+     */
+    bool DoLoadXml(const wxString& path, wxXmlNode* root = nullptr);
+    bool DoFinishLoad();
     clProjectFile::Ptr_t FileFromXml(wxXmlNode* node, const wxString& vd);
     wxArrayString DoGetCompilerOptions(bool cxxOptions, bool clearCache = false, bool noDefines = true,
                                        bool noIncludePaths = true);
@@ -684,6 +697,11 @@ public:
      */
     time_t GetFileLastModifiedTime() const;
 
+    /**
+     * @brief return a hash of the project XML. It changes whenever the settings or the files of the project change
+     */
+    size_t GetXmlHash() const;
+
     /**
      * return/set the last modification time that was made by the editor
      */
@@ -716,6 +734,12 @@ public:
      */
     wxArrayString GetCCompilerOptions(bool clearCache = false, bool noDefines = true, bool noIncludePaths = true);
 
+    /**
+     * @brief start expanding the backticks of the compiler options of the selected build configuration in the
+     * background, into the workspace backtick cache
+     */
+    void PrefetchBacktickExpansions();
+
     /**
      * @brief return the compilation line for a C++ file in the project. This function returns the same
      * compilation line for all CXX or C files. So instead of hardcoding the file name it uses a placeholder for the
@@ -756,6 +780,12 @@ public:
     void CreateCompileCommandsJSON(JSONItem& compile_commands, const wxStringMap_t& compilersGlobalPaths,
                                    bool createCompileFlagsTxt);
 
+    /**
+     * @brief return the 'compile_commands' entries of this project as JSON text, separated by commas. The text is
+     * cached in `cacheDir` and reused while the compile lines and the files of the project are unchanged
+     */
+    wxString GetCompileCommandsFragment(const wxStringMap_t& compilersGlobalPaths, const wxString& cacheDir);
+
     /**
      * @brief create compile_flags.txt file for this project
      * @param compilersGlobalPaths
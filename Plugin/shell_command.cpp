@@ -51,7 +51,8 @@ void ShellCommand::AppendLine(const wxString& line)
 {
     clBuildEvent add_line_event(wxEVT_BUILD_PROCESS_ADDLINE);
     add_line_event.SetString(line);
-    EventNotifier::Get()->AddPendingEvent(add_line_event);
+    add_line_event.SetEventObject(this);
+    GetEventTarget()->AddPendingEvent(add_line_event);
 }
 
 void ShellCommand::Stop()
@@ -72,13 +73,23 @@ void ShellCommand::SendStartMsg(const wxString& toolchain)
     start_event.SetFlag(clBuildEvent::kClean, m_info.GetKind() == QueueCommand::kClean ||
                                                   (start_event.HasFlag(clBuildEvent::kCustomProject) &&
                                                    m_info.GetCustomBuildTarget() == wxT("clean")));
-    EventNotifier::Get()->AddPendingEvent(start_event);
+    start_event.SetEventObject(this);
+    GetEventTarget()->AddPendingEvent(start_event);
 }
 
 void ShellCommand::SendEndMsg()
 {
     clBuildEvent event(wxEVT_BUILD_PROCESS_ENDED);
-    EventNotifier::Get()->AddPendingEvent(event);
+    event.SetEventObject(this);
+    GetEventTarget()->AddPendingEvent(event);
+}
+
+wxEvtHandler* ShellCommand::GetEventTarget() const
+{
+    if(m_sink) {
+        return m_sink;
+    }
+    return EventNotifier::Get();
 }
 
 void ShellCommand::DoPrintOutput(const wxString& out)
@@ -90,6 +101,11 @@ void ShellCommand::DoPrintOutput(const wxString& out)
 void ShellCommand::CleanUp()
 {
     wxDELETE(m_proc);
+    // the process is reaped by now (its exit code is recorded by the SIGCHLD handler on POSIX)
+    if(m_pid != wxNOT_FOUND) {
+        m_hasExitCode = IProcess::GetProcessExitCode(m_pid, m_exitCode);
+        m_pid = wxNOT_FOUND;
+    }
     SendEndMsg();
 }
 
@@ -138,9 +154,13 @@ bool ShellCommand::StartProcess(const wxString& cmd, size_t create_flags)
     create_flags |= IProcessRawOutput;
 #endif
 
-    m_proc = ::CreateAsyncProcess(this, cmd, create_flags);
+    wxString command = m_commandFilter ? m_commandFilter(cmd) : cmd;
+    m_proc = ::CreateAsyncProcess(this, command, create_flags, wxEmptyString,
+                                  m_processEnv.empty() ? nullptr : &m_processEnv);
     if(!m_proc) {
         return false;
     }
+    m_pid = m_proc->GetPid();
+    m_hasExitCode = false;
     return true;
 }
@@ -25,11 +25,13 @@
 #ifndef COMPILER_ACTION_H
 #define COMPILER_ACTION_H
 
+#include "clEnvironment.hpp"
 #include "cl_command_event.h"
 #include "codelite_exports.h"
 #include "project.h"
 #include "queuecommand.h"
 
+#include <functional>
 #include <wx/event.h>
 
 class IManager;
@@ -43,6 +45,12 @@ class WXDLLIMPEXP_SDK ShellCommand : public wxEvtHandler
 {
 private:
     IProcess* m_proc = nullptr;
+    int m_pid = wxNOT_FOUND;
+    int m_exitCode = 0;
+    bool m_hasExitCode = false;
+    wxEvtHandler* m_sink = nullptr;
+    clEnvList_t m_processEnv;
+    std::function<wxString(const wxString&)> m_commandFilter;
 
 protected:
     QueueCommand m_info;
@@ -53,17 +61,44 @@ protected:
     virtual void OnProcessTerminated(clProcessEvent& e);
 
     void CleanUp();
+    wxEvtHandler* GetEventTarget() const;
     void DoSetWorkingDirectory(ProjectPtr proj, bool isCustom, bool isFileOnly);
     bool StartProcess(const wxString& cmd, size_t create_flags = IProcessCreateDefault | IProcessWrapInShell);
 
 public:
     bool IsBusy() const { return m_proc != NULL; }
 
+    /**
+     * @brief the exit code of the process, once it ended. Return false if it is not known: the process did not run,
+     * or it was not reaped yet
+     */
+    bool GetExitCode(int& exitCode) const
+    {
+        exitCode = m_exitCode;
+        return m_hasExitCode;
+    }
+
     void Stop();
 
     void SetInfo(const QueueCommand& info) { this->m_info = info; }
     const QueueCommand& GetInfo() const { return m_info; }
 
+    /**
+     * @brief post the build events to `sink` instead of the global event notifier. The events are sent with this
+     * command as their event object. Used by the build scheduler to run several commands concurrently
+     */
+    void SetEventSink(wxEvtHandler* sink) { this->m_sink = sink; }
+
+    /**
+     * @brief extra environment variables to set for the build process
+     */
+    void SetProcessEnvironment(const clEnvList_t& env) { this->m_processEnv = env; }
+
+    /**
+     * @brief a function applied to the command line just before the process is started
+     */
+    void SetCommandFilter(std::function<wxString(const wxString&)> filter) { this->m_commandFilter = std::move(filter); }
+
 public:
     // construct a compiler action
     ShellCommand(const QueueCommand& buildInfo);
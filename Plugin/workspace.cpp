@@ -26,6 +26,8 @@
 
 #include "StringUtils.h"
 #include "build_settings_config.h"
+#include "clCxxWorkspaceSnapshot.hpp"
+#include "clMemoryMappedFile.hpp"
 #include "cl_command_event.h"
 #include "codelite_events.h"
 #include "compiler_command_line_parser.h"
@@ -43,7 +45,13 @@
 #include "project.h"
 #include "xmlutils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <thread>
 #include <wx/app.h>
+#include <wx/dir.h>
+#include <wx/ffile.h>
 #include <wx/log.h>
 #include <wx/msgdlg.h>
 #include <wx/regex.h>
@@ -88,7 +96,12 @@ void clCxxWorkspace::CloseWorkspace()
 
     m_fileName.Clear();
     // reset the internal cache objects
+    DoClearFilesIndex();
     m_projects.clear();
+    if(m_backticks) {
+        m_backticks->Save();
+        m_backticks.reset(nullptr);
+    }
 
     TagsManagerST::Get()->CloseDatabase();
 }
@@ -161,6 +174,7 @@ bool clCxxWorkspace::CreateWorkspace(const wxString& name, const wxString& path,
     // This function sets the working directory to the workspace directory!
     ::wxSetWorkingDirectory(m_fileName.GetPath());
     m_buildMatrix = nullptr;
+    m_backticks.reset(new clBacktickCache(m_fileName.GetPath()));
 
     wxFileName dbFileName = GetTagsFileName();
     TagsManagerST::Get()->OpenDatabase(dbFileName);
@@ -300,7 +314,7 @@ bool clCxxWorkspace::CreateProject(const wxString& name, const wxString& path, c
     proj->Create(name, wxEmptyString, path, type);
     proj->AssociateToWorkspace(this);
     proj->SetWorkspaceFolder(workspaceFolder);
-    m_projects[name] = proj;
+    DoReplaceProject(proj);
 
     // make the project path to be relative to the workspace, if it's sensible to do so
     wxFileName tmp(path + wxFileName::GetPathSeparator() + name + wxT(".project"));
@@ -341,7 +355,7 @@ bool clCxxWorkspace::AddProject(const wxString& path, // fullpath
     }
     proj->AssociateToWorkspace(this);
     proj->SetWorkspaceFolder(workspaceFolder);
-    m_projects[proj->GetName()] = proj;
+    DoReplaceProject(proj);
 
     // make the project path to be relative to the workspace, if it's sensible to do so
     wxFileName tmp(path);
@@ -445,38 +459,27 @@ bool clCxxWorkspace::AddProject(const wxString& path, wxString& errMsg)
     }
 }
 
-ProjectPtr clCxxWorkspace::DoAddProject(ProjectPtr proj)
+void clCxxWorkspace::DoReplaceProject(ProjectPtr proj)
 {
-    if(!proj) {
-        return NULL;
+    // the files index points into the project it replaces
+    auto iter = m_projects.find(proj->GetName());
+    if(iter != m_projects.end()) {
+        DoUnindexProject(iter->second.get());
     }
-
-    m_projects.insert(std::make_pair(proj->GetName(), proj));
-    proj->AssociateToWorkspace(this);
-    return proj;
+    m_projects[proj->GetName()] = proj;
+    DoIndexProject(proj.get());
 }
 
-ProjectPtr clCxxWorkspace::DoAddProject(const wxString& path, const wxString& projectVirtualFolder, wxString& errMsg)
+ProjectPtr clCxxWorkspace::DoAddProject(ProjectPtr proj)
 {
-    // Add the project
-    ProjectPtr proj(new Project());
-
-    // Convert the path to absolute path
-    wxFileName projectFile(path);
-    if(projectFile.IsRelative()) {
-        projectFile.MakeAbsolute(m_fileName.GetPath());
-    }
-
-    if(!proj->Load(projectFile.GetFullPath())) {
-        errMsg = wxT("Corrupted project file '");
-        errMsg << projectFile.GetFullPath() << wxT("'");
+    if(!proj) {
         return NULL;
     }
 
-    // Add an entry to the projects map
-    m_projects.insert(std::make_pair(proj->GetName(), proj));
+    if(m_projects.insert(std::make_pair(proj->GetName(), proj)).second) {
+        DoIndexProject(proj.get());
+    }
     proj->AssociateToWorkspace(this);
-    proj->SetWorkspaceFolder(projectVirtualFolder);
     return proj;
 }
 
@@ -494,6 +497,7 @@ bool clCxxWorkspace::RemoveProject(const wxString& name, wxString& errMsg, const
     // remove the project from the internal map
     ProjectMap_t::iterator iter = m_projects.find(proj->GetName());
     if(iter != m_projects.end()) {
+        DoUnindexProject(iter->second.get());
         m_projects.erase(iter);
     }
 
@@ -869,6 +873,7 @@ void clCxxWorkspace::ReloadWorkspace()
 
     wxLogNull noLog;
     // reset the internal cache objects
+    DoClearFilesIndex();
     m_projects.clear();
 
     TagsManager* mgr = TagsManagerST::Get();
@@ -1029,9 +1034,8 @@ wxFileName clCxxWorkspace::GetTagsFileName() const
     return fn_tags;
 }
 
-cJSON* clCxxWorkspace::CreateCompileCommandsJSON(bool createCompileFlagsTxt, wxArrayString* generated_paths) const
+wxStringMap_t clCxxWorkspace::DoGetCompilersGlobalPaths() const
 {
-    // Build the global compiler paths, we will need this later on...
     wxStringMap_t compilersGlobalPaths;
     std::unordered_map<wxString, wxArrayString> pathsMap = BuildSettingsConfigST::Get()->GetCompilersGlobalPaths();
     for(const auto& vt : pathsMap) {
@@ -1047,6 +1051,13 @@ cJSON* clCxxWorkspace::CreateCompileCommandsJSON(bool createCompileFlagsTxt, wxA
         });
         compilersGlobalPaths.insert({ compiler_name, paths });
     }
+    return compilersGlobalPaths;
+}
+
+cJSON* clCxxWorkspace::CreateCompileCommandsJSON(bool createCompileFlagsTxt, wxArrayString* generated_paths) const
+{
+    // Build the global compiler paths, we will need this later on...
+    wxStringMap_t compilersGlobalPaths = DoGetCompilersGlobalPaths();
 
     // Check if the active project is using custom build
     ProjectPtr activeProject = GetActiveProject();
@@ -1081,6 +1092,98 @@ cJSON* clCxxWorkspace::CreateCompileCommandsJSON(bool createCompileFlagsTxt, wxA
     return createCompileFlagsTxt ? nullptr : compile_commands.release();
 }
 
+bool clCxxWorkspace::WriteCompileCommandsJSON(const wxFileName& fn, bool& changed) const
+{
+    changed = false;
+
+    // Check if the active project is using custom build
+    ProjectPtr activeProject = GetActiveProject();
+    if(activeProject) {
+        BuildConfigPtr buildConf = activeProject->GetBuildConfiguration();
+        if(buildConf && buildConf->IsCustomBuild()) {
+            return false;
+        }
+    }
+
+    wxStringMap_t compilersGlobalPaths = DoGetCompilersGlobalPaths();
+    wxFileName cacheDir(GetPrivateFolder(), "");
+    cacheDir.AppendDir("compile_commands");
+    cacheDir.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    // Visit the projects by name, so the same workspace always produces the same file
+    std::vector<ProjectPtr> projects;
+    projects.reserve(m_projects.size());
+    for(const auto& vt : m_projects) {
+        projects.push_back(vt.second);
+    }
+    std::sort(projects.begin(), projects.end(),
+              [](const ProjectPtr& a, const ProjectPtr& b) { return a->GetName() < b->GetName(); });
+
+    // Stream the entries to a temporary file, one project at a time
+    wxString tmpfile = fn.GetFullPath() + ".tmp";
+    {
+        wxFFile fp(tmpfile, "wb");
+        if(!fp.IsOpened()) {
+            clWARNING() << "Failed to write:" << tmpfile << endl;
+            return false;
+        }
+        fp.Write("[\n", wxConvUTF8);
+        bool first = true;
+        for(ProjectPtr project : projects) {
+            BuildConfigPtr buildConf = project->GetBuildConfiguration();
+            if(!buildConf || !buildConf->IsProjectEnabled() || buildConf->IsCustomBuild() ||
+               !buildConf->IsCompilerRequired()) {
+                continue;
+            }
+            wxString fragment = project->GetCompileCommandsFragment(compilersGlobalPaths, cacheDir.GetPath());
+            if(fragment.empty()) {
+                continue;
+            }
+            if(!first) {
+                fp.Write(",\n", wxConvUTF8);
+            }
+            fp.Write(fragment, wxConvUTF8);
+            first = false;
+        }
+        fp.Write("\n]\n", wxConvUTF8);
+        if(fp.Error() || !fp.Close()) {
+            clWARNING() << "Failed to write:" << tmpfile << endl;
+            return false;
+        }
+    }
+
+    // Drop the fragments of the projects removed from the workspace (or renamed)
+    wxStringSet_t fragments;
+    for(ProjectPtr project : projects) {
+        fragments.insert(project->GetName() + ".json");
+    }
+    wxArrayString cachedFragments;
+    wxDir::GetAllFiles(cacheDir.GetPath(), &cachedFragments, "*.json", wxDIR_FILES);
+    for(const wxString& cachedFragment : cachedFragments) {
+        if(fragments.count(wxFileName(cachedFragment).GetFullName()) == 0) {
+            clRemoveFile(cachedFragment);
+        }
+    }
+
+    // Keep the current file (and its timestamp) if nothing changed, so clangd does not reload it
+    if(fn.FileExists()) {
+        clMemoryMappedFile current, generated;
+        if(current.Open(fn.GetFullPath()) && generated.Open(tmpfile) && current.GetSize() == generated.GetSize() &&
+           memcmp(current.GetData(), generated.GetData(), current.GetSize()) == 0) {
+            current.Close();
+            generated.Close();
+            clRemoveFile(tmpfile);
+            return true;
+        }
+    }
+    if(!::wxRenameFile(tmpfile, fn.GetFullPath(), true)) {
+        clWARNING() << "Failed to write:" << fn << endl;
+        return false;
+    }
+    changed = true;
+    return true;
+}
+
 ProjectPtr clCxxWorkspace::GetActiveProject() const { return GetProject(GetActiveProjectName()); }
 
 ProjectPtr clCxxWorkspace::GetProject(const wxString& name) const
@@ -1186,13 +1289,94 @@ wxString clCxxWorkspace::GetFilesMask() const
 wxString clCxxWorkspace::GetProjectFromFile(const wxFileName& filename) const
 {
     wxString filenameFP = filename.GetFullPath();
-    clCxxWorkspace::ProjectMap_t::const_iterator iter = m_projects.begin();
-    for(; iter != m_projects.end(); ++iter) {
-        if(iter->second->GetFiles().count(filenameFP)) {
-            return iter->first;
+    auto iter = m_filesIndex.find(&filenameFP);
+    if(iter == m_filesIndex.end()) {
+        return "";
+    }
+    return iter->second->GetName();
+}
+
+bool clCxxWorkspace::IsFileInWorkspace(const wxString& fullpath) const
+{
+    return m_filesIndex.count(&fullpath) != 0;
+}
+
+void clCxxWorkspace::GetFilesOfProjects(const wxArrayString& projects, clProjectFile::Vec_t& files) const
+{
+    std::vector<Project*> selected;
+    if(projects.IsEmpty()) {
+        selected.reserve(m_projects.size());
+        for(const auto& vt : m_projects) {
+            selected.push_back(vt.second.get());
+        }
+    } else {
+        selected.reserve(projects.size());
+        for(const wxString& name : projects) {
+            auto iter = m_projects.find(name);
+            if(iter != m_projects.end()) {
+                selected.push_back(iter->second.get());
+            }
         }
     }
-    return "";
+
+    size_t totalFiles = files.size();
+    for(Project* project : selected) {
+        totalFiles += project->GetFiles().size();
+    }
+    files.reserve(totalFiles);
+    for(Project* project : selected) {
+        for(const auto& vt : project->GetFiles()) {
+            files.push_back(vt.second);
+        }
+    }
+}
+
+void clCxxWorkspace::DoIndexProject(Project* project)
+{
+    if(!m_indexedProjects.insert(project).second) {
+        return;
+    }
+    for(const auto& vt : project->GetFiles()) {
+        m_filesIndex.insert({ &vt.first, project });
+    }
+}
+
+void clCxxWorkspace::DoUnindexProject(Project* project)
+{
+    if(m_indexedProjects.erase(project) == 0) {
+        return;
+    }
+    for(const auto& vt : project->GetFiles()) {
+        auto range = m_filesIndex.equal_range(&vt.first);
+        for(auto iter = range.first; iter != range.second;) {
+            iter = (iter->second == project) ? m_filesIndex.erase(iter) : std::next(iter);
+        }
+    }
+}
+
+void clCxxWorkspace::DoIndexFile(Project* project, const wxString& fullpath)
+{
+    // projects that are not (or no longer) part of the workspace are not indexed
+    if(m_indexedProjects.count(project)) {
+        m_filesIndex.insert({ &fullpath, project });
+    }
+}
+
+void clCxxWorkspace::DoUnindexFile(Project* project, const wxString& fullpath)
+{
+    auto range = m_filesIndex.equal_range(&fullpath);
+    for(auto iter = range.first; iter != range.second; ++iter) {
+        if(iter->second == project) {
+            m_filesIndex.erase(iter);
+            break;
+        }
+    }
+}
+
+void clCxxWorkspace::DoClearFilesIndex()
+{
+    m_filesIndex.clear();
+    m_indexedProjects.clear();
 }
 
 void clCxxWorkspace::GetProjectFiles(const wxString& projectName, wxArrayString& files) const
@@ -1253,15 +1437,93 @@ void clCxxWorkspace::DoUnselectActiveProject()
 
 void clCxxWorkspace::DoLoadProjectsFromXml(wxXmlNode* parentNode, const wxString& folder,
                                            std::vector<wxXmlNode*>& removedChildren)
+{
+    std::vector<std::pair<wxXmlNode*, wxString>> nodes;
+    DoCollectProjectsXml(parentNode, folder, nodes);
+    if(nodes.empty()) {
+        return;
+    }
+
+    // The projects are constructed here: the default settings of a new project are read from the global
+    // configuration
+    std::vector<ProjectPtr> projects;
+    std::vector<wxString> paths;
+    projects.reserve(nodes.size());
+    paths.reserve(nodes.size());
+    for(const auto& node : nodes) {
+        wxFileName projectFile(node.first->GetAttribute(wxT("Path"), wxEmptyString));
+        if(projectFile.IsRelative()) {
+            projectFile.MakeAbsolute(m_fileName.GetPath());
+        }
+        paths.push_back(projectFile.GetFullPath());
+        projects.push_back(ProjectPtr(new Project()));
+    }
+
+    // Parse the project files concurrently. The tree of a project file that did not change since the last open is
+    // rebuilt from the snapshot instead
+    wxFileName snapshotFile(GetPrivateFolder(), GetWorkspaceFileName().GetName() + ".snapshot");
+    clCxxWorkspaceSnapshot snapshot;
+    snapshot.Load(snapshotFile.GetFullPath());
+
+    std::vector<clCxxWorkspaceSnapshot::FileStat> stats(projects.size());
+    std::vector<char> loaded(projects.size(), 0);
+    std::atomic_size_t next(0);
+    std::atomic_size_t parsed(0);
+    auto worker = [&]() {
+        for(size_t i = next++; i < projects.size(); i = next++) {
+            wxXmlNode* root = nullptr;
+            if(clCxxWorkspaceSnapshot::Stat(paths[i], stats[i])) {
+                root = snapshot.CreateXml(paths[i], stats[i]);
+            }
+            if(!root) {
+                ++parsed;
+            }
+            loaded[i] = projects[i]->DoLoadXml(paths[i], root);
+        }
+    };
+    size_t threadsCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), projects.size());
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadsCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for(std::thread& thr : threads) {
+        thr.join();
+    }
+    size_t snapshotCount = snapshot.GetCount();
+    snapshot.Close();
+
+    // Add them to the workspace in the order of the workspace file
+    for(size_t i = 0; i < projects.size(); ++i) {
+        if(!loaded[i] || !projects[i]->DoFinishLoad()) {
+            clWARNING() << "Corrupted project file:" << paths[i] << endl;
+            removedChildren.push_back(nodes[i].first);
+            loaded[i] = 0;
+            continue;
+        }
+        DoAddProject(projects[i]);
+        projects[i]->SetWorkspaceFolder(nodes[i].second);
+    }
+
+    // Write a new snapshot if it misses any project
+    if(parsed == 0 && snapshotCount == projects.size()) {
+        return;
+    }
+    for(size_t i = 0; i < projects.size(); ++i) {
+        if(loaded[i] && stats[i].modified != 0) {
+            snapshot.Add(paths[i], stats[i], projects[i]->m_doc.GetRoot());
+        }
+    }
+    snapshot.Save(snapshotFile.GetFullPath());
+}
+
+void clCxxWorkspace::DoCollectProjectsXml(wxXmlNode* parentNode, const wxString& folder,
+                                          std::vector<std::pair<wxXmlNode*, wxString>>& nodes)
 {
     wxXmlNode* child = parentNode->GetChildren();
     while(child) {
         if(child->GetName() == wxT("Project")) {
-            wxString projectPath = child->GetAttribute(wxT("Path"), wxEmptyString);
-            wxString errmsg;
-            if(!DoAddProject(projectPath, folder, errmsg)) {
-                removedChildren.push_back(child);
-            }
+            nodes.push_back({ child, folder });
         } else if(child->GetName() == wxT("VirtualDirectory")) {
             // Virtual directory
             wxString currentFolder = folder;
@@ -1270,7 +1532,7 @@ void clCxxWorkspace::DoLoadProjectsFromXml(wxXmlNode* parentNode, const wxString
                 currentFolder << "/";
             }
             currentFolder << vdName;
-            DoLoadProjectsFromXml(child, currentFolder, removedChildren);
+            DoCollectProjectsXml(child, currentFolder, nodes);
         } else if((child->GetName() == wxT("WorkspaceParserPaths")) ||
                   (child->GetName() == wxT("WorkspaceParserMacros"))) {
             wxString swtlw = XmlUtils::ReadString(m_doc.GetRoot(), "SWTLW");
@@ -1419,6 +1681,13 @@ bool clCxxWorkspace::DoLoadWorkspace(const wxString& fileName, wxString& errMsg)
 
     // Update the build matrix
     DoUpdateBuildMatrix();
+
+    // Start expanding the backticks of the projects in the background: the code completion and the compile commands
+    // generation ask for them right after the workspace is loaded
+    m_backticks.reset(new clBacktickCache(m_fileName.GetPath()));
+    for(const auto& vt : m_projects) {
+        vt.second->PrefetchBacktickExpansions();
+    }
     return true;
 }
 
@@ -1528,23 +1797,15 @@ size_t clCxxWorkspace::GetExcludeFilesForConfig(std::vector<wxString>& files, co
     return files.size();
 }
 
-void clCxxWorkspace::ClearBacktickCache() { m_backticks.clear(); }
-
-bool clCxxWorkspace::HasBacktick(const wxString& backtick) const { return m_backticks.count(backtick) != 0; }
-
-void clCxxWorkspace::SetBacktickValue(const wxString& backtick, const wxString& value)
-{
-    m_backticks.erase(backtick);
-    m_backticks.insert({ backtick, value });
-}
-
-bool clCxxWorkspace::GetBacktickValue(const wxString& backtick, wxString& value) const
+void clCxxWorkspace::ClearBacktickCache()
 {
-    if(!HasBacktick(backtick)) {
-        return false;
+    if(m_backticks) {
+        // the settings changed: the outputs may differ, do not serve the old ones
+        m_backticks->Clear();
+        for(const auto& vt : m_projects) {
+            vt.second->PrefetchBacktickExpansions();
+        }
     }
-    value = m_backticks.find(backtick)->second;
-    return true;
 }
 
 void clCxxWorkspace::OnBuildHotspotClicked(clBuildEvent& event)
@@ -27,6 +27,7 @@
 
 #include "IWorkspace.h"
 #include "JSON.h"
+#include "clBacktickCache.hpp"
 #include "cl_command_event.h"
 #include "codelite_exports.h"
 #include "configuration_mapping.h"
@@ -37,6 +38,7 @@
 #include "wxStringHash.h"
 
 #include <map>
+#include <unordered_set>
 #include <wx/event.h>
 #include <wx/filename.h>
 #include <wx/string.h>
@@ -56,6 +58,7 @@ class LocalWorkspace;
 class WXDLLIMPEXP_SDK clCxxWorkspace : public IWorkspace
 {
     friend class clCxxWorkspaceST;
+    friend class Project;
 
 public:
     void GetProjectFiles(const wxString& projectName, wxArrayString& files) const override;
@@ -71,6 +74,16 @@ public:
     typedef std::unordered_map<wxString, ProjectPtr> ProjectMap_t;
 
 protected:
+    /// The keys of the files index point to the keys of the files table of the projects, the paths are not copied
+    struct FilePathHash {
+        size_t operator()(const wxString* path) const { return std::hash<wxString>()(*path); }
+    };
+    struct FilePathEqual {
+        bool operator()(const wxString* a, const wxString* b) const { return *a == *b; }
+    };
+    /// file full path -> the projects holding it
+    typedef std::unordered_multimap<const wxString*, Project*, FilePathHash, FilePathEqual> FilesIndex_t;
+
     wxXmlDocument m_doc;
     wxFileName m_fileName;
     ProjectMap_t m_projects;
@@ -79,7 +92,9 @@ protected:
     bool m_saveOnExit;
     BuildMatrixPtr m_buildMatrix;
     LocalWorkspace* m_localWorkspace = nullptr;
-    wxStringMap_t m_backticks;
+    clBacktickCache::ptr_t m_backticks;
+    FilesIndex_t m_filesIndex;
+    std::unordered_set<const Project*> m_indexedProjects;
 
 public:
     /// Constructor
@@ -98,10 +113,13 @@ public:
      */
     LocalWorkspace* GetLocalWorkspace() const { return m_localWorkspace; }
 
-    // Backtick cache
-    bool HasBacktick(const wxString& backtick) const;
-    bool GetBacktickValue(const wxString& backtick, wxString& value) const;
-    void SetBacktickValue(const wxString& backtick, const wxString& value);
+    /**
+     * @brief the outputs of the backtick compiler options of the projects. Null when no workspace is opened
+     */
+    clBacktickCache::ptr_t GetBacktickCache() const { return m_backticks; }
+    /**
+     * @brief drop the expanded backticks and expand them again, in the background
+     */
     void ClearBacktickCache();
 
 private:
@@ -112,10 +130,17 @@ private:
     void DoUnselectActiveProject();
 
     /**
-     * @brief load projects from the XML file
+     * @brief load projects from the XML file. The project files are parsed concurrently, the projects are added to
+     * the workspace in the order of the workspace file
      */
     void DoLoadProjectsFromXml(wxXmlNode* parentNode, const wxString& folder, std::vector<wxXmlNode*>& removedChildren);
 
+    /**
+     * @brief collect the project nodes under `parentNode`, with the workspace folder holding them
+     */
+    void DoCollectProjectsXml(wxXmlNode* parentNode, const wxString& folder,
+                              std::vector<std::pair<wxXmlNode*, wxString>>& nodes);
+
     // return the wxXmlNode instance for the give path
     // the path is separated by "/"
     // return NULL if no such virtual directory exists
@@ -146,6 +171,18 @@ private:
      */
     void OnBuildHotspotClicked(clBuildEvent& event);
 
+    /**
+     * @brief files index maintenance. Projects are indexed when added to the workspace, the files they add or remove
+     * afterwards are reported by the project itself
+     */
+    void DoIndexProject(Project* project);
+    void DoUnindexProject(Project* project);
+    void DoIndexFile(Project* project, const wxString& fullpath);
+    void DoUnindexFile(Project* project, const wxString& fullpath);
+    void DoClearFilesIndex();
+
+    wxStringMap_t DoGetCompilersGlobalPaths() const;
+
 public:
     /**
      * @brief move 'projectName' to folder. Create the folder if it does not exists
@@ -158,6 +195,17 @@ public:
      */
     bool CreateWorkspaceFolder(const wxString& path);
 
+    /**
+     * @brief collect the files of `projects`, or of all the projects of the workspace if `projects` is empty. Unlike
+     * GetProjectFiles(), the file objects are returned and no path is copied
+     */
+    void GetFilesOfProjects(const wxArrayString& projects, clProjectFile::Vec_t& files) const;
+
+    /**
+     * @brief return true if `fullpath` is part of any project of the workspace
+     */
+    bool IsFileInWorkspace(const wxString& fullpath) const;
+
     /**
      * @brief delete workspace folder. Notice that this will also remove (but not delete) all the projects from the
      * workspace
@@ -178,6 +226,13 @@ public:
      */
     cJSON* CreateCompileCommandsJSON(bool createCompileFlagsTxt, wxArrayString* generated_paths) const;
 
+    /**
+     * @brief write the 'compile_commands.json' file of the workspace projects (only the enabled ones) to `fn`.
+     * The entries of each project are cached in the private folder and regenerated only when the project changes.
+     * The file is left untouched when its content is the same, `changed` tells which case happened
+     */
+    bool WriteCompileCommandsJSON(const wxFileName& fn, bool& changed) const;
+
     wxString GetFileName() const override { return GetWorkspaceFileName().GetFullPath(); }
     wxString GetDir() const override { return GetWorkspaceFileName().GetPath(); }
 
@@ -484,13 +539,9 @@ public:
     clEnvList_t GetEnvironment() const override;
 
 private:
-    /**
-     * Do the actual add project
-     * \param path project file path
-     * \param errMsg [output] incase an error, report the error to the caller
-     */
-    ProjectPtr DoAddProject(const wxString& path, const wxString& projectVirtualFolder, wxString& errMsg);
     ProjectPtr DoAddProject(ProjectPtr proj);
+    /// add `proj`, replacing the project of the same name if any
+    void DoReplaceProject(ProjectPtr proj);
 
     void RemoveProjectFromBuildMatrix(ProjectPtr prj);
 
@@ -140,17 +140,10 @@ void wxTerminalCtrl::Run(const wxString& command)
 
 void wxTerminalCtrl::AppendText(wxStringView text)
 {
-    wxString window_title;
-    m_outputView->StyleAndAppend(text, &window_title);
+    // the window title and the completions are reported once the output is rendered
+    m_outputView->StyleAndAppend(text);
     m_outputView->SetCaretEnd();
     m_inputCtrl->SetWritePositionEnd();
-
-    if (!window_title.empty()) {
-        wxTerminalEvent titleEvent(wxEVT_TERMINAL_CTRL_SET_TITLE);
-        titleEvent.SetEventObject(this);
-        titleEvent.SetString(window_title);
-        GetEventHandler()->AddPendingEvent(titleEvent);
-    }
 }
 
 void wxTerminalCtrl::GenerateCtrlC()
@@ -342,9 +335,6 @@ void wxTerminalCtrl::ProcessOutputBuffer()
             break;
         }
     }
-
-    // see if we need to prompt for password
-    m_inputCtrl->CallAfter(&wxTerminalInputCtrl::NotifyTerminalOutput);
 }
 
 void wxTerminalCtrl::ProcessIdle()
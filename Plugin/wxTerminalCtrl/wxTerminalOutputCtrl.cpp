@@ -5,6 +5,7 @@
 #include "Platform/Platform.hpp"
 #include "StringUtils.h"
 #include "ThemeImporters/ThemeImporterBase.hpp"
+#include "clAnsiEscapeCodeHandler.hpp"
 #include "clIdleEventThrottler.hpp"
 #include "clModuleLogger.hpp"
 #include "clSystemSettings.h"
@@ -15,6 +16,7 @@
 #include "imanager.h"
 #include "procutils.h"
 #include "wxTerminalCtrl.h"
+#include "wxTerminalEvent.hpp"
 #include "wxTerminalInputCtrl.hpp"
 
 #include <wx/menu.h>
@@ -52,6 +54,29 @@ struct EditorEnabler {
     }
     ~EditorEnabler() { m_ctrl->SetEditable(false); }
 };
+
+/// repaint interval for the output, roughly the display refresh rate
+constexpr int FLUSH_INTERVAL_MS = 16;
+
+/// the number of UTF-8 bytes used to encode `ch`
+size_t utf8_length(wxChar ch)
+{
+    unsigned int c = ch;
+    if (c < 0x80) {
+        return 1;
+    } else if (c < 0x800) {
+        return 2;
+    } else if (c >= 0xD800 && c <= 0xDBFF) {
+        // high surrogate: the pair is encoded as 4 bytes
+        return 4;
+    } else if (c >= 0xDC00 && c <= 0xDFFF) {
+        // low surrogate: already counted by the high surrogate
+        return 0;
+    } else if (c < 0x10000) {
+        return 3;
+    }
+    return 4;
+}
 } // namespace
 
 wxTerminalOutputCtrl::wxTerminalOutputCtrl(wxWindow* parent, wxWindowID winid)
@@ -93,11 +118,11 @@ void wxTerminalOutputCtrl::Initialise(const wxFont& font, const wxColour& bg_col
     m_ctrl->SetEditable(false);
     m_ctrl->SetWordChars(R"#(\:~abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_$/.-)#");
     m_ctrl->IndicatorSetStyle(INDICATOR_HYPERLINK, wxSTC_INDIC_PLAIN);
-    auto lexer = ColoursAndFontsManager::Get().GetLexer("terminal");
-    if (lexer) {
-        lexer->Apply(m_ctrl);
-        m_ctrl->IndicatorSetForeground(INDICATOR_HYPERLINK, clColours::Blue(lexer->IsDark()));
-    }
+    m_styleProvider = new wxSTCStyleProvider(m_ctrl);
+    ApplyTheme();
+
+    m_flushTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &wxTerminalOutputCtrl::OnFlushTimer, this, m_flushTimer->GetId());
 
     GetSizer()->Add(m_ctrl, 1, wxEXPAND);
     GetSizer()->Fit(this);
@@ -110,7 +135,10 @@ void wxTerminalOutputCtrl::Initialise(const wxFont& font, const wxColour& bg_col
 
 wxTerminalOutputCtrl::~wxTerminalOutputCtrl()
 {
-    wxDELETE(m_stcRenderer);
+    m_flushTimer->Stop();
+    Unbind(wxEVT_TIMER, &wxTerminalOutputCtrl::OnFlushTimer, this, m_flushTimer->GetId());
+    wxDELETE(m_flushTimer);
+    wxDELETE(m_styleProvider);
     m_ctrl->Unbind(wxEVT_CHAR_HOOK, &wxTerminalOutputCtrl::OnKeyDown, this);
     m_ctrl->Unbind(wxEVT_LEFT_UP, &wxTerminalOutputCtrl::OnLeftUp, this);
     EventNotifier::Get()->Unbind(wxEVT_SYS_COLOURS_CHANGED, &wxTerminalOutputCtrl::OnThemeChanged, this);
@@ -118,9 +146,7 @@ wxTerminalOutputCtrl::~wxTerminalOutputCtrl()
 
 void wxTerminalOutputCtrl::AppendText(const wxString& buffer)
 {
-    EditorEnabler d{ m_ctrl };
-    m_ctrl->AppendText(buffer);
-    RequestScrollToEnd();
+    StyleAndAppend(wxStringView{ buffer.wc_str(), buffer.length() });
 }
 
 long wxTerminalOutputCtrl::GetLastPosition() const { return m_ctrl->GetLastPosition(); }
@@ -156,11 +182,170 @@ wxString wxTerminalOutputCtrl::GetLineText(int lineNumber) const { return m_ctrl
 
 void wxTerminalOutputCtrl::ReloadSettings() { ApplyTheme(); }
 
-void wxTerminalOutputCtrl::StyleAndAppend(wxStringView buffer, [[maybe_unused]] wxString* window_title)
+void wxTerminalOutputCtrl::StyleAndAppend(wxStringView buffer)
 {
-    EditorEnabler enabler{ m_ctrl };
-    m_ctrl->AppendText(buffer.data());
-    RequestScrollToEnd();
+    // Coalesce the output and repaint at most once per frame. Window title changes are reported
+    // by Flush() once the output is processed
+    m_pendingOutput.append(buffer.data(), buffer.length());
+    if (!m_flushTimer->IsRunning()) {
+        m_flushTimer->StartOnce(FLUSH_INTERVAL_MS);
+    }
+}
+
+void wxTerminalOutputCtrl::OnFlushTimer(wxTimerEvent& event)
+{
+    wxUnusedVar(event);
+    Flush();
+}
+
+void wxTerminalOutputCtrl::Flush()
+{
+    int lines_on_screen = m_ctrl->LinesOnScreen();
+    if (lines_on_screen > 0) {
+        m_screen.SetScreenRows(lines_on_screen);
+    }
+
+    if (!m_pendingOutput.empty()) {
+        wxStringView sv{ m_pendingOutput.wc_str(), m_pendingOutput.length() };
+        size_t consumed = m_outputHandler.ProcessBuffer(sv, &m_screen);
+        // keep any incomplete escape sequence for the next round
+        m_pendingOutput.erase(0, consumed);
+    }
+
+    auto damage = m_screen.TakeDamage();
+    if (!damage.IsEmpty()) {
+        EditorEnabler enabler{ m_ctrl };
+        size_t last_row = m_screen.GetRowCount() - 1;
+        if (damage.full || damage.rows_dropped >= (size_t)m_ctrl->GetLineCount()) {
+            m_ctrl->ClearAll();
+            RenderRows(0, last_row, false);
+        } else {
+            if (damage.rows_dropped > 0) {
+                // rows evicted from the scrollback
+                m_ctrl->DeleteRange(0, m_ctrl->PositionFromLine(damage.rows_dropped));
+            }
+            if (damage.first_row != wxString::npos) {
+                RenderRows(damage.first_row, damage.last_row, true);
+            }
+        }
+        SetCaretEnd();
+        RequestScrollToEnd();
+
+        // the completion box is built from the rendered lines
+        if (m_terminal && m_terminal->GetInputCtrl()) {
+            m_terminal->GetInputCtrl()->CallAfter(&wxTerminalInputCtrl::NotifyTerminalOutput);
+        }
+    }
+
+    wxString title;
+    if (m_screen.TakeWindowTitle(&title) && m_terminal) {
+        wxTerminalEvent titleEvent(wxEVT_TERMINAL_CTRL_SET_TITLE);
+        titleEvent.SetEventObject(m_terminal);
+        titleEvent.SetString(title);
+        m_terminal->GetEventHandler()->AddPendingEvent(titleEvent);
+    }
+}
+
+void wxTerminalOutputCtrl::RenderRows(size_t from, size_t to, bool terminate_last_row)
+{
+    // Each row of the screen model is a line in the control. Replace the lines [from, to] with the model rows
+    // in a single call, passing the text and the style bytes together
+    size_t stc_lines = m_ctrl->GetLineCount();
+    size_t last_row = m_screen.GetRowCount() - 1;
+
+    int start_pos = 0;
+    int end_pos = 0;
+    bool prepend_eol = false;
+    bool append_eol = false;
+    if (from >= stc_lines) {
+        // new rows, append them
+        from = stc_lines;
+        to = last_row;
+        start_pos = end_pos = m_ctrl->GetLastPosition();
+        prepend_eol = true;
+    } else if (terminate_last_row && to < last_row && (to + 1) < stc_lines) {
+        // rows in the middle of the document, keep the line that follows
+        start_pos = m_ctrl->PositionFromLine(from);
+        end_pos = m_ctrl->PositionFromLine(to + 1);
+        append_eol = true;
+    } else {
+        // replace everything from `from` to the end of the document
+        to = last_row;
+        start_pos = m_ctrl->PositionFromLine(from);
+        end_pos = m_ctrl->GetLastPosition();
+    }
+
+    std::string styled;
+    char default_style = (char)GetStyleForAttribute(0);
+    auto append_eol_func = [&styled, default_style]() {
+        styled.push_back('\n');
+        styled.push_back(default_style);
+    };
+
+    if (prepend_eol) {
+        append_eol_func();
+    }
+
+    wxString line;
+    for (size_t i = from; i <= to; ++i) {
+        if (i > from) {
+            append_eol_func();
+        }
+
+        const auto& row = m_screen.GetRow(i);
+        line.clear();
+        for (const auto& cell : row) {
+            line.Append(cell.ch);
+        }
+
+        const wxScopedCharBuffer utf8 = line.ToUTF8();
+        size_t byte_index = 0;
+        for (const auto& cell : row) {
+            char style = (char)GetStyleForAttribute(cell.attr);
+            size_t count = utf8_length(cell.ch);
+            for (size_t n = 0; n < count && byte_index < utf8.length(); ++n) {
+                styled.push_back(utf8.data()[byte_index++]);
+                styled.push_back(style);
+            }
+        }
+
+        // should not happen, unless the conversion replaced characters
+        for (; byte_index < utf8.length(); ++byte_index) {
+            styled.push_back(utf8.data()[byte_index]);
+            styled.push_back(default_style);
+        }
+    }
+
+    if (append_eol) {
+        append_eol_func();
+    }
+
+    wxMemoryBuffer buffer;
+    buffer.AppendData(styled.data(), styled.length());
+
+    m_ctrl->DeleteRange(start_pos, end_pos - start_pos);
+    m_ctrl->SetSelection(start_pos, start_pos);
+    m_ctrl->AddStyledText(buffer);
+}
+
+int wxTerminalOutputCtrl::GetStyleForAttribute(unsigned short attr)
+{
+    if (attr < m_attrStyles.size() && m_attrStyles[attr] != wxNOT_FOUND) {
+        return m_attrStyles[attr];
+    }
+
+    if (attr >= m_attrStyles.size()) {
+        m_attrStyles.resize(attr + 1, wxNOT_FOUND);
+    }
+
+    // attribute 0 is the default text attribute, use the default style of the control for it
+    int style = 0;
+    if (attr != 0) {
+        const auto& colours = m_screen.GetAttribute(attr);
+        style = m_styleProvider->GetStyle(colours.first, colours.second);
+    }
+    m_attrStyles[attr] = style;
+    return style;
 }
 
 void wxTerminalOutputCtrl::ShowCommandLine()
@@ -177,27 +362,15 @@ void wxTerminalOutputCtrl::SetCaretEnd()
     m_ctrl->SetCurrentPos(GetLastPosition());
 }
 
-int wxTerminalOutputCtrl::Truncate()
-{
-    if (GetNumberOfLines() > 1000) {
-        // Start removing lines from the top
-        long linesToRemove = (GetNumberOfLines() - 1000);
-        long startPos = 0;
-        long endPos = XYToPosition(0, linesToRemove);
-        this->Remove(startPos, endPos);
-        return endPos - startPos;
-    }
-    return 0;
-}
-
 wxChar wxTerminalOutputCtrl::GetLastChar() const { return m_ctrl->GetCharAt(m_ctrl->GetLastPosition() - 1); }
 
 int wxTerminalOutputCtrl::GetCurrentStyle() { return 0; }
 
 void wxTerminalOutputCtrl::Clear()
 {
-    EditorEnabler d{ m_ctrl };
-    m_ctrl->ClearAll();
+    m_pendingOutput.clear();
+    m_screen.Clear();
+    Flush();
 }
 
 void wxTerminalOutputCtrl::DoScrollToEnd()
@@ -226,7 +399,16 @@ void wxTerminalOutputCtrl::ApplyTheme()
     auto lexer = ColoursAndFontsManager::Get().GetLexer("terminal");
     if (lexer) {
         lexer->Apply(m_ctrl);
+        m_ctrl->IndicatorSetForeground(INDICATOR_HYPERLINK, clColours::Blue(lexer->IsDark()));
+        m_screen.SetUseDarkThemeColours(lexer->IsDark());
     }
+
+    // escape sequences are interpreted by the screen model, the text is styled by us
+    m_ctrl->SetLexer(wxSTC_LEX_CONTAINER);
+    m_styleProvider->Clear();
+    m_attrStyles.clear();
+    m_screen.SetDefaultAttributes(m_styleProvider->GetDefaultStyle());
+    Flush();
     m_ctrl->Refresh();
 }
 
@@ -5,14 +5,17 @@
 #include "cl_command_event.h"
 #include "codelite_exports.h"
 #include "wxTerminalAnsiEscapeHandler.hpp"
-#include "wxTerminalAnsiRendererSTC.hpp"
 #include "wxTerminalColourHandler.h"
+#include "wxTerminalScreenBuffer.hpp"
 
+#include <vector>
 #include <wx/stc/stc.h>
 #include <wx/textctrl.h>
+#include <wx/timer.h>
 
 class wxTerminalCtrl;
 class wxTerminalInputCtrl;
+struct wxSTCStyleProvider;
 
 class WXDLLIMPEXP_SDK wxTerminalOutputCtrl : public wxWindow
 {
@@ -58,7 +61,11 @@ class WXDLLIMPEXP_SDK wxTerminalOutputCtrl : public wxWindow
 
     wxStyledTextCtrl* m_ctrl = nullptr;
     wxTerminalAnsiEscapeHandler m_outputHandler;
-    wxTerminalAnsiRendererSTC* m_stcRenderer = nullptr;
+    wxTerminalScreenBuffer m_screen;
+    wxSTCStyleProvider* m_styleProvider = nullptr;
+    std::vector<int> m_attrStyles;
+    wxString m_pendingOutput;
+    wxTimer* m_flushTimer = nullptr;
 
     wxEvtHandler* m_sink = nullptr;
     wxTextAttr m_defaultAttr;
@@ -88,6 +95,12 @@ protected:
     void OnEnterWindow(wxMouseEvent& event);
     void OnLeaveWindow(wxMouseEvent& event);
     void DoPatternClicked(const wxString& pattern);
+    void OnFlushTimer(wxTimerEvent& event);
+
+    /// process the pending output into the screen model and repaint the damaged rows
+    void Flush();
+    void RenderRows(size_t from, size_t to, bool terminate_last_row);
+    int GetStyleForAttribute(unsigned short attr);
 
 public:
     explicit wxTerminalOutputCtrl(wxTerminalCtrl* parent, wxWindowID winid = wxNOT_FOUND,
@@ -102,7 +115,7 @@ public:
 
     // API
     void AppendText(const wxString& buffer);
-    void StyleAndAppend(wxStringView buffer, wxString* window_title);
+    void StyleAndAppend(wxStringView buffer);
     long GetLastPosition() const;
     wxString GetRange(int from, int to) const;
     bool PositionToXY(long pos, long* x, long* y) const;
@@ -120,7 +133,6 @@ public:
     void ReloadSettings();
     void ShowCommandLine();
     void SetCaretEnd();
-    int Truncate();
     wxChar GetLastChar() const;
     void Clear();
     void SetAttributes(const wxColour& bg_colour, const wxColour& text_colour, const wxFont& font)
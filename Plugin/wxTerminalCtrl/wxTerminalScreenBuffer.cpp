@@ -0,0 +1,329 @@
+#include "wxTerminalScreenBuffer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+wxTerminalScreenBuffer::wxTerminalScreenBuffer(size_t scrollback)
+{
+    m_attributes.push_back({ *wxWHITE, *wxBLACK });
+    SetScrollback(scrollback);
+}
+
+wxTerminalScreenBuffer::~wxTerminalScreenBuffer() {}
+
+void wxTerminalScreenBuffer::SetScrollback(size_t rows)
+{
+    m_rows.clear();
+    m_rows.resize(std::max<size_t>(rows, 1));
+    Clear();
+}
+
+void wxTerminalScreenBuffer::Clear()
+{
+    wxTerminalAnsiRendererInterface::Clear();
+    for (auto& row : m_rows) {
+        row.clear();
+    }
+    m_head = 0;
+    m_count = 1; // there is always a row for the caret
+    m_curAttrIndex = 0;
+    MarkAllDirty();
+}
+
+void wxTerminalScreenBuffer::MarkAllDirty()
+{
+    m_firstRowNumber = 0;
+    m_droppedRows = 0;
+    m_dirtyFirst = wxString::npos;
+    m_dirtyLast = wxString::npos;
+    m_fullDamage = true;
+}
+
+void wxTerminalScreenBuffer::MarkDirty(size_t index)
+{
+    size_t row_number = m_firstRowNumber + index;
+    if (m_dirtyFirst == wxString::npos || row_number < m_dirtyFirst) {
+        m_dirtyFirst = row_number;
+    }
+    if (m_dirtyLast == wxString::npos || row_number > m_dirtyLast) {
+        m_dirtyLast = row_number;
+    }
+}
+
+wxTerminalScreenBuffer::Damage wxTerminalScreenBuffer::TakeDamage()
+{
+    Damage damage;
+    damage.full = m_fullDamage;
+    damage.rows_dropped = m_droppedRows;
+    if (!m_fullDamage && m_dirtyLast != wxString::npos && m_dirtyLast >= m_firstRowNumber) {
+        // rows that were modified and then evicted are no longer interesting
+        damage.first_row = std::max(m_dirtyFirst, m_firstRowNumber) - m_firstRowNumber;
+        damage.last_row = std::min(m_dirtyLast - m_firstRowNumber, m_count - 1);
+    }
+
+    m_fullDamage = false;
+    m_droppedRows = 0;
+    m_dirtyFirst = wxString::npos;
+    m_dirtyLast = wxString::npos;
+    return damage;
+}
+
+bool wxTerminalScreenBuffer::TakeWindowTitle(wxString* title)
+{
+    if (!m_titleChanged) {
+        return false;
+    }
+    m_titleChanged = false;
+    *title = m_windowTitle;
+    return true;
+}
+
+void wxTerminalScreenBuffer::AppendRow()
+{
+    if (m_count < m_rows.size()) {
+        RowAt(m_count).clear();
+        ++m_count;
+    } else {
+        // the buffer is full: recycle the oldest row
+        m_head = (m_head + 1) % m_rows.size();
+        RowAt(m_count - 1).clear();
+        ++m_firstRowNumber;
+        ++m_droppedRows;
+    }
+    MarkDirty(m_count - 1);
+}
+
+void wxTerminalScreenBuffer::EnsureCaretRow()
+{
+    if (m_pos.y < 0) {
+        m_pos.y = 0;
+    }
+    while ((size_t)m_pos.y >= m_count) {
+        size_t count_before = m_count;
+        AppendRow();
+        if (count_before == m_count) {
+            // a row was evicted, the caret moves up with the contents
+            m_pos.y = m_count - 1;
+            break;
+        }
+    }
+}
+
+void wxTerminalScreenBuffer::FillRow(Row_t& row, size_t from, size_t to)
+{
+    if (row.size() < to) {
+        row.resize(to);
+    }
+    for (size_t i = from; i < to; ++i) {
+        row[i].ch = wxT(' ');
+        row[i].attr = 0;
+    }
+}
+
+void wxTerminalScreenBuffer::PutChar(wxChar ch)
+{
+    EnsureCaretRow();
+    Row_t& row = RowAt(m_pos.y);
+    size_t x = m_pos.x;
+    if (row.size() <= x) {
+        FillRow(row, row.size(), x + 1);
+    }
+    row[x].ch = ch;
+    row[x].attr = m_curAttrIndex;
+    ++m_pos.x;
+    MarkDirty(m_pos.y);
+}
+
+void wxTerminalScreenBuffer::AddString(wxStringView str)
+{
+    for (wxChar ch : str) {
+        switch (ch) {
+        case wxT('\n'):
+            LineFeed();
+            break;
+        case wxT('\t'):
+            Tab();
+            break;
+        case wxT('\a'):
+            Bell();
+            break;
+        case wxT('\r'):
+            CarriageReturn();
+            break;
+        default:
+            if ((unsigned)ch >= 0x20) {
+                PutChar(ch);
+            }
+            break;
+        }
+    }
+}
+
+void wxTerminalScreenBuffer::Bell() {}
+
+void wxTerminalScreenBuffer::Backspace()
+{
+    if (m_pos.x > 0) {
+        --m_pos.x;
+    }
+}
+
+void wxTerminalScreenBuffer::Tab()
+{
+    EnsureCaretRow();
+    size_t next_stop = (m_pos.x / 8 + 1) * 8;
+    Row_t& row = RowAt(m_pos.y);
+    if (row.size() < next_stop) {
+        FillRow(row, row.size(), next_stop);
+        MarkDirty(m_pos.y);
+    }
+    m_pos.x = next_stop;
+}
+
+void wxTerminalScreenBuffer::LineFeed()
+{
+    // the escape handler reports "\r\n" as a line feed, so we also move to the start of the line
+    m_pos.x = 0;
+    ++m_pos.y;
+    EnsureCaretRow();
+}
+
+void wxTerminalScreenBuffer::FormFeed() { Clear(); }
+
+void wxTerminalScreenBuffer::CarriageReturn() { m_pos.x = 0; }
+
+void wxTerminalScreenBuffer::MoveCaret(long n, wxDirection direction)
+{
+    long top = GetScreenTop();
+    long bottom = m_count - 1;
+    switch (direction) {
+    case wxRIGHT:
+        m_pos.x += n;
+        break;
+    case wxLEFT:
+        m_pos.x = wxMax(m_pos.x - n, 0);
+        break;
+    case wxUP:
+        m_pos.y = wxMax(m_pos.y - n, top);
+        break;
+    case wxDOWN:
+        m_pos.y = wxMin(m_pos.y + n, bottom);
+        break;
+    default:
+        break;
+    }
+}
+
+void wxTerminalScreenBuffer::SetCaretX(long n) { m_pos.x = wxMax(n - 1, 0); }
+
+void wxTerminalScreenBuffer::SetCaretY(long n)
+{
+    m_pos.y = GetScreenTop() + wxMax(n - 1, 0);
+    EnsureCaretRow();
+}
+
+void wxTerminalScreenBuffer::ClearLine(size_t dir)
+{
+    EnsureCaretRow();
+    Row_t& row = RowAt(m_pos.y);
+    size_t x = m_pos.x;
+    if ((dir & wxRIGHT) && (dir & wxLEFT)) {
+        row.clear();
+    } else if (dir & wxRIGHT) {
+        if (row.size() > x) {
+            row.resize(x);
+        }
+    } else if (dir & wxLEFT) {
+        FillRow(row, 0, std::min(x + 1, row.size()));
+    }
+    MarkDirty(m_pos.y);
+}
+
+void wxTerminalScreenBuffer::EraseCharacter(int n)
+{
+    if (n <= 0) {
+        return;
+    }
+    EnsureCaretRow();
+    Row_t& row = RowAt(m_pos.y);
+    FillRow(row, m_pos.x, m_pos.x + n);
+    MarkDirty(m_pos.y);
+}
+
+void wxTerminalScreenBuffer::ClearDisplay(size_t dir)
+{
+    if ((dir & wxUP) && (dir & wxDOWN)) {
+        Clear();
+        return;
+    }
+
+    EnsureCaretRow();
+    if (dir & wxDOWN) {
+        // clear from the caret to the end of the screen
+        ClearLine(wxRIGHT);
+        for (size_t i = m_pos.y + 1; i < m_count; ++i) {
+            RowAt(i).clear();
+            MarkDirty(i);
+        }
+    } else if (dir & wxUP) {
+        // clear from the top of the screen to the caret
+        for (size_t i = GetScreenTop(); i < (size_t)m_pos.y; ++i) {
+            RowAt(i).clear();
+            MarkDirty(i);
+        }
+        ClearLine(wxLEFT);
+    }
+}
+
+void wxTerminalScreenBuffer::SetWindowTitle(wxStringView window_title)
+{
+    m_windowTitle = wxString(window_title.data(), window_title.length());
+    m_titleChanged = true;
+}
+
+void wxTerminalScreenBuffer::ResetStyle()
+{
+    m_curAttr = m_defaultAttr;
+    m_curAttrIndex = 0;
+}
+
+void wxTerminalScreenBuffer::SetTextColour(const wxColour& col)
+{
+    wxTerminalAnsiRendererInterface::SetTextColour(col);
+    m_curAttrIndex = GetAttributeIndex(m_curAttr.GetTextColour(), m_curAttr.GetBackgroundColour());
+}
+
+void wxTerminalScreenBuffer::SetDefaultAttributes(const wxTextAttr& attr)
+{
+    m_defaultAttr = attr;
+    m_curAttr = attr;
+    m_curAttrIndex = 0;
+
+    // attribute 0 is always the default one
+    m_attributes[0] = { attr.GetTextColour(), attr.GetBackgroundColour() };
+    MarkAllDirty();
+}
+
+unsigned short wxTerminalScreenBuffer::GetAttributeIndex(const wxColour& fg, const wxColour& bg)
+{
+    // the number of distinct colours used by a terminal session is small, a linear scan is good enough
+    for (size_t i = 0; i < m_attributes.size(); ++i) {
+        if (m_attributes[i].first == fg && m_attributes[i].second == bg) {
+            return i;
+        }
+    }
+
+    if (m_attributes.size() >= std::numeric_limits<unsigned short>::max()) {
+        return 0;
+    }
+    m_attributes.push_back({ fg, bg });
+    return m_attributes.size() - 1;
+}
+
+const std::pair<wxColour, wxColour>& wxTerminalScreenBuffer::GetAttribute(unsigned short index) const
+{
+    if (index >= m_attributes.size()) {
+        return m_attributes[0];
+    }
+    return m_attributes[index];
+}
@@ -0,0 +1,114 @@
+#ifndef WXTERMINALSCREENBUFFER_HPP
+#define WXTERMINALSCREENBUFFER_HPP
+
+#include "codelite_exports.h"
+#include "wxTerminalAnsiRendererInterface.hpp"
+
+#include <utility>
+#include <vector>
+#include <wx/colour.h>
+#include <wx/string.h>
+
+/// a single character cell on the terminal grid
+struct WXDLLIMPEXP_SDK wxTerminalCell {
+    wxChar ch = wxT(' ');
+    /// index into the screen buffer attributes table
+    unsigned short attr = 0;
+};
+
+/// The terminal grid model.
+///
+/// Rows of cells are stored in a ring buffer of a fixed capacity (the scrollback). The rows storage is allocated once
+/// and recycled when the oldest row is evicted, so appending output never re-allocates the grid.
+/// The model is driven by `wxTerminalAnsiEscapeHandler` and records the rows that were modified since the last call to
+/// `TakeDamage()`, allowing the view to repaint only what changed
+class WXDLLIMPEXP_SDK wxTerminalScreenBuffer : public wxTerminalAnsiRendererInterface
+{
+public:
+    typedef std::vector<wxTerminalCell> Row_t;
+
+    struct Damage {
+        /// number of rows that were evicted from the top of the buffer
+        size_t rows_dropped = 0;
+        /// range of modified rows (indexes into the current rows), `wxString::npos` when no row was modified
+        size_t first_row = wxString::npos;
+        size_t last_row = wxString::npos;
+        /// the entire buffer was reset, the view should redraw everything
+        bool full = false;
+
+        bool IsEmpty() const { return !full && rows_dropped == 0 && first_row == wxString::npos; }
+    };
+
+private:
+    std::vector<Row_t> m_rows;
+    size_t m_head = 0;
+    size_t m_count = 0;
+    size_t m_screenRows = 24;
+    std::vector<std::pair<wxColour, wxColour>> m_attributes;
+    unsigned short m_curAttrIndex = 0;
+
+    // damage tracking, using absolute row numbers
+    size_t m_firstRowNumber = 0;
+    size_t m_dirtyFirst = wxString::npos;
+    size_t m_dirtyLast = wxString::npos;
+    size_t m_droppedRows = 0;
+    bool m_fullDamage = true;
+    bool m_titleChanged = false;
+
+protected:
+    Row_t& RowAt(size_t index) { return m_rows[(m_head + index) % m_rows.size()]; }
+    void AppendRow();
+    void MarkDirty(size_t index);
+    void MarkAllDirty();
+    void PutChar(wxChar ch);
+    void EnsureCaretRow();
+    void FillRow(Row_t& row, size_t from, size_t to);
+    size_t GetScreenTop() const { return m_count > m_screenRows ? m_count - m_screenRows : 0; }
+    unsigned short GetAttributeIndex(const wxColour& fg, const wxColour& bg);
+
+public:
+    explicit wxTerminalScreenBuffer(size_t scrollback = 5000);
+    virtual ~wxTerminalScreenBuffer();
+
+    /// set the maximum number of rows kept by the buffer. This resets the buffer
+    void SetScrollback(size_t rows);
+    size_t GetScrollback() const { return m_rows.size(); }
+
+    /// set the number of rows visible on screen. Absolute cursor positioning is relative to the screen
+    void SetScreenRows(size_t rows) { m_screenRows = rows == 0 ? 1 : rows; }
+
+    size_t GetRowCount() const { return m_count; }
+    const Row_t& GetRow(size_t index) const { return m_rows[(m_head + index) % m_rows.size()]; }
+
+    /// return the foreground / background colours of attribute `index`
+    const std::pair<wxColour, wxColour>& GetAttribute(unsigned short index) const;
+    size_t GetAttributesCount() const { return m_attributes.size(); }
+
+    /// return the damage accumulated since the previous call and reset it
+    Damage TakeDamage();
+
+    /// return true and set `title` if the window title was changed since the previous call
+    bool TakeWindowTitle(wxString* title);
+
+    // wxTerminalAnsiRendererInterface
+    void Clear() override;
+    void Bell() override;
+    void Backspace() override;
+    void Tab() override;
+    void LineFeed() override;
+    void FormFeed() override;
+    void CarriageReturn() override;
+    void AddString(wxStringView str) override;
+    void MoveCaret(long n, wxDirection direction) override;
+    void SetCaretX(long n) override;
+    void SetCaretY(long n) override;
+    void ClearLine(size_t dir = wxRIGHT | wxLEFT) override;
+    void EraseCharacter(int n) override;
+    void ClearDisplay(size_t dir = wxUP | wxDOWN) override;
+    void SetWindowTitle(wxStringView window_title) override;
+    void ResetStyle() override;
+    void SetTextColour(const wxColour& col) override;
+    void SetDefaultAttributes(const wxTextAttr& attr) override;
+};
+
+#endif // WXTERMINALSCREENBUFFER_HPP
@@ -1,24 +1,38 @@
 #include "SmartCompletionUsageDB.h"
 #include "cl_standard_paths.h"
 #include "file_logger.h"
+#include <chrono>
 #include <wx/filename.h>
 
+// The pending usage is written every FLUSH_INTERVAL seconds
+#define FLUSH_INTERVAL 10
+
 SmartCompletionUsageDB::SmartCompletionUsageDB() {}
 
 SmartCompletionUsageDB::~SmartCompletionUsageDB() { Close(); }
 
 void SmartCompletionUsageDB::Open()
 {
-    try {
-        if(m_db.IsOpen()) return;
+    if(IsOpen()) return;
 
+    UsageMap_t prunedCC, prunedGTA;
+    try {
         wxFileName fn(clStandardPaths::Get().GetUserDataDir(), "SmartCompletions.db");
         fn.AppendDir("config");
         m_db.Open(fn.GetFullPath());
         CreateScheme();
+        LoadTable("CC_USAGE", m_ccTable, prunedCC);
+        LoadTable("GOTO_ANYTHING_USAGE", m_gtaTable, prunedGTA);
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "Failed to open SmartCompletions DB:" << e.GetMessage() << clEndl;
     }
+
+    // the entries that faded away are deleted by the first write
+    m_pending = Batch();
+    m_pending.cc.swap(prunedCC);
+    m_pending.gta.swap(prunedGTA);
+    m_shutdown = false;
+    m_thread = new std::thread(&SmartCompletionUsageDB::WriterMain, this);
 }
 
 void SmartCompletionUsageDB::CreateScheme()
@@ -37,7 +51,8 @@ void SmartCompletionUsageDB::CreateScheme()
         sql.Clear();
         sql << "CREATE TABLE IF NOT EXISTS CC_USAGE(ID INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, "
             << "NAME TEXT, " // The scope type: 0 for namespace, 1 for class
-            << "WEIGHT INTEGER)";
+            << "WEIGHT INTEGER, "
+            << "LAST_USED INTEGER)";
         m_db.ExecuteUpdate(sql);
 
         sql.Clear();
@@ -47,64 +62,149 @@ void SmartCompletionUsageDB::CreateScheme()
         sql.Clear();
         sql << "CREATE TABLE IF NOT EXISTS GOTO_ANYTHING_USAGE(ID INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, "
             << "NAME TEXT, " // The scope type: 0 for namespace, 1 for class
-            << "WEIGHT INTEGER)";
+            << "WEIGHT INTEGER, "
+            << "LAST_USED INTEGER)";
         m_db.ExecuteUpdate(sql);
 
         sql.Clear();
         sql << "CREATE UNIQUE INDEX IF NOT EXISTS GOTO_ANYTHING_USAGE_IDX1 ON GOTO_ANYTHING_USAGE(NAME)";
         m_db.ExecuteUpdate(sql);
 
+        // The tables created by older versions have no LAST_USED column
+        for(const wxString& table : { "CC_USAGE", "GOTO_ANYTHING_USAGE" }) {
+            bool hasLastUsed = false;
+            wxSQLite3ResultSet res = m_db.ExecuteQuery("PRAGMA table_info(" + table + ")");
+            while(res.NextRow()) {
+                if(res.GetString(1).CmpNoCase("LAST_USED") == 0) {
+                    hasLastUsed = true;
+                }
+            }
+            res.Finalize();
+            if(!hasLastUsed) {
+                m_db.ExecuteUpdate("ALTER TABLE " + table + " ADD COLUMN LAST_USED INTEGER");
+            }
+        }
+
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "SmartCompletionUsageDB::CreateScheme():" << e.GetMessage() << clEndl;
     }
 }
 
-void SmartCompletionUsageDB::LoadCCUsageTable(std::unordered_map<wxString, int>& weightTable)
+void SmartCompletionUsageDB::LoadTable(const wxString& table, SmartCompletionUsageTable& usageTable,
+                                       UsageMap_t& pruned)
 {
     try {
-        weightTable.clear();
-        wxSQLite3ResultSet res = m_db.ExecuteQuery("select NAME,WEIGHT from CC_USAGE");
+        usageTable.Clear();
+        time_t now = time(nullptr);
+        wxSQLite3ResultSet res = m_db.ExecuteQuery("select NAME,WEIGHT,LAST_USED from " + table);
         while(res.NextRow()) {
             wxString k = res.GetString(0);
-            int v = res.GetInt(1);
-            weightTable[k] = v;
+            double score = res.GetDouble(1);
+            // the usage recorded by older versions starts to decay now
+            time_t lastUsed = res.IsNull(2) ? now : (time_t)res.GetInt64(2).GetValue();
+            if(SmartCompletionUsageTable::Decay(score, lastUsed, now) < SmartCompletionUsageTable::MIN_SCORE) {
+                pruned.insert({ k, Usage() });
+                continue;
+            }
+            usageTable.Set(k, score, lastUsed);
         }
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
     }
 }
 
-void SmartCompletionUsageDB::LoadGTAUsageTable(std::unordered_map<wxString, int>& weightTable)
+void SmartCompletionUsageDB::StoreCCUsage(const wxString& key)
 {
-    try {
-        weightTable.clear();
-        wxSQLite3ResultSet res = m_db.ExecuteQuery("select NAME,WEIGHT from GOTO_ANYTHING_USAGE");
-        while(res.NextRow()) {
-            wxString k = res.GetString(0);
-            int v = res.GetInt(1);
-            weightTable[k] = v;
+    time_t now = time(nullptr);
+    double score = m_ccTable.Add(key, now);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.cc[key] = { score, now };
+}
+
+void SmartCompletionUsageDB::StoreGTAUsage(const wxString& key)
+{
+    time_t now = time(nullptr);
+    double score = m_gtaTable.Add(key, now);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.gta[key] = { score, now };
+}
+
+void SmartCompletionUsageDB::WriteTable(const wxString& table, const UsageMap_t& usage)
+{
+    if(usage.empty()) return;
+
+    wxSQLite3Statement replaceSt =
+        m_db.PrepareStatement("replace into " + table + " (ID, NAME, WEIGHT, LAST_USED) values (NULL, ?, ?, ?)");
+    wxSQLite3Statement deleteSt = m_db.PrepareStatement("delete from " + table + " where NAME=?");
+    for(const auto& vt : usage) {
+        if(vt.second.score < SmartCompletionUsageTable::MIN_SCORE) {
+            deleteSt.Bind(1, vt.first);
+            deleteSt.ExecuteUpdate();
+            deleteSt.Reset();
+        } else {
+            replaceSt.Bind(1, vt.first);
+            replaceSt.Bind(2, vt.second.score);
+            replaceSt.Bind(3, wxLongLong(vt.second.lastUsed));
+            replaceSt.ExecuteUpdate();
+            replaceSt.Reset();
         }
-    } catch (const wxSQLite3Exception& e) {
-        clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
     }
 }
 
-void SmartCompletionUsageDB::StoreCCUsage(const wxString& key, int weight)
+void SmartCompletionUsageDB::WriteBatch(const Batch& batch)
 {
+    if(!m_db.IsOpen() || (!batch.clear && batch.cc.empty() && batch.gta.empty())) return;
+
     try {
         m_db.Begin();
-        wxSQLite3Statement st = m_db.PrepareStatement("replace into CC_USAGE (ID, NAME, WEIGHT) values (NULL, ?, ?)");
-        st.Bind(1, key);
-        st.Bind(2, weight);
-        st.ExecuteUpdate();
+        if(batch.clear) {
+            m_db.ExecuteUpdate("delete from CC_USAGE");
+            m_db.ExecuteUpdate("delete from GOTO_ANYTHING_USAGE");
+        }
+        WriteTable("CC_USAGE", batch.cc);
+        WriteTable("GOTO_ANYTHING_USAGE", batch.gta);
         m_db.Commit();
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
+        try {
+            m_db.Rollback();
+        } catch (const wxSQLite3Exception&) {
+        }
+    }
+}
+
+void SmartCompletionUsageDB::WriterMain()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true) {
+        m_cond.wait_for(lock, std::chrono::seconds(FLUSH_INTERVAL), [this]() { return m_shutdown; });
+        bool shutdown = m_shutdown;
+        Batch batch;
+        std::swap(batch, m_pending);
+
+        lock.unlock();
+        WriteBatch(batch);
+        lock.lock();
+
+        if(shutdown) {
+            break;
+        }
     }
 }
 
 void SmartCompletionUsageDB::Close()
 {
+    if(m_thread) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+        }
+        // the writer flushes the pending usage before exiting
+        m_cond.notify_one();
+        m_thread->join();
+        wxDELETE(m_thread);
+    }
+
     if(m_db.IsOpen()) {
         try {
             m_db.Close();
@@ -116,30 +216,11 @@ void SmartCompletionUsageDB::Close()
 
 void SmartCompletionUsageDB::Clear()
 {
-    try {
-        m_db.Begin();
-        wxString sql = "delete from CC_USAGE";
-        m_db.ExecuteUpdate(sql);
+    m_ccTable.Clear();
+    m_gtaTable.Clear();
 
-        sql = "delete from GOTO_ANYTHING_USAGE";
-        m_db.ExecuteUpdate(sql);
-        m_db.Commit();
-    } catch (const wxSQLite3Exception& e) {
-        clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
-    }
-}
-
-void SmartCompletionUsageDB::StoreGTAUsage(const wxString& key, int weight)
-{
-    try {
-        m_db.Begin();
-        wxSQLite3Statement st =
-            m_db.PrepareStatement("replace into GOTO_ANYTHING_USAGE (ID, NAME, WEIGHT) values (NULL, ?, ?)");
-        st.Bind(1, key);
-        st.Bind(2, weight);
-        st.ExecuteUpdate();
-        m_db.Commit();
-    } catch (const wxSQLite3Exception& e) {
-        clWARNING() << "SQLite 3 error:" << e.GetMessage() << clEndl;
-    }
+    // the usage recorded so far is dropped, the usage recorded from now on is written after the clear
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending = Batch();
+    m_pending.clear = true;
 }
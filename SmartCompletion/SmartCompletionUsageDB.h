@@ -1,53 +1,88 @@
 #ifndef SMARTCOMPLETIONUSAGEDB_H
 #define SMARTCOMPLETIONUSAGEDB_H
 
+#include "SmartCompletionUsageTable.hpp"
 #include "wxStringHash.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <wx/string.h>
 #include <wx/wxsqlite3.h>
 
+/// The usage tables and their database.
+///
+/// The tables are loaded when the database is opened and then live in memory: recording a usage only updates the table
+/// and queues the new score. A background thread writes the queued scores to the database, in a single transaction,
+/// every few seconds and when the database is closed
 class SmartCompletionUsageDB
 {
+    struct Usage {
+        double score = 0.0;
+        time_t lastUsed = 0;
+    };
+    typedef std::unordered_map<wxString, Usage> UsageMap_t;
+
+    struct Batch {
+        bool clear = false;
+        UsageMap_t cc;
+        UsageMap_t gta;
+    };
+
     wxSQLite3Database m_db;
+    SmartCompletionUsageTable m_ccTable;
+    SmartCompletionUsageTable m_gtaTable;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread* m_thread = nullptr;
+    Batch m_pending;
+    bool m_shutdown = false;
 
 protected:
     void CreateScheme();
+    void LoadTable(const wxString& table, SmartCompletionUsageTable& usageTable, UsageMap_t& pruned);
+    void WriteTable(const wxString& table, const UsageMap_t& usage);
+    void WriteBatch(const Batch& batch);
+    void WriterMain();
 
 public:
     SmartCompletionUsageDB();
     virtual ~SmartCompletionUsageDB();
 
     /**
-     * @brief open the usage DB
+     * @brief open the usage DB and load its tables. Does nothing if the DB is already open
      */
     void Open();
 
     /**
-     * @brief close the usage DB
+     * @brief write the pending usage and close the usage DB
      */
     void Close();
 
+    bool IsOpen() const { return m_thread != nullptr; }
+
     /**
-     * @brief load the CC weight table from the database
+     * @brief the CC weight table
      */
-    void LoadCCUsageTable(std::unordered_map<wxString, int>& weightTable);
+    SmartCompletionUsageTable& GetCCUsageTable() { return m_ccTable; }
     /**
-     * @brief load the GTA weight table from the database
+     * @brief the GTA weight table
      */
-    void LoadGTAUsageTable(std::unordered_map<wxString, int>& weightTable);
+    SmartCompletionUsageTable& GetGTAUsageTable() { return m_gtaTable; }
 
     /**
-     * @brief write the CC usage to the database
+     * @brief record a use of the CC entry `key`. The database is updated in the background
      */
-    void StoreCCUsage(const wxString& key, int weight);
-    
+    void StoreCCUsage(const wxString& key);
+
     /**
-     * @brief write the GTA usage to the database
+     * @brief record a use of the GTA entry `key`. The database is updated in the background
      */
-    void StoreGTAUsage(const wxString& key, int weight);
-    
+    void StoreGTAUsage(const wxString& key);
+
     /**
-     * @brief clear the content of the database
+     * @brief clear the tables and the content of the database
      */
     void Clear();
 };
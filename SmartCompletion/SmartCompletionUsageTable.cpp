@@ -0,0 +1,126 @@
+#include "SmartCompletionUsageTable.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// a power of 2. The table grows (doubles) to stay at most 2/3 full
+constexpr size_t INITIAL_SLOTS = 256;
+} // namespace
+
+double SmartCompletionUsageTable::Decay(double score, time_t lastUsed, time_t now)
+{
+    if (now <= lastUsed) {
+        return score;
+    }
+    return score * std::exp2(-(double)(now - lastUsed) / (double)HALF_LIFE);
+}
+
+const SmartCompletionUsageTable::Slot* SmartCompletionUsageTable::DoFind(const wxString& key, size_t hash) const
+{
+    if (m_slots.empty()) {
+        return nullptr;
+    }
+
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = m_slots[i];
+        if (slot.key == EMPTY_SLOT) {
+            return nullptr;
+        }
+        if (slot.hash == hash && m_keys[slot.key] == key) {
+            return &slot;
+        }
+    }
+}
+
+SmartCompletionUsageTable::Slot& SmartCompletionUsageTable::DoInsert(const wxString& key, size_t hash)
+{
+    if ((m_keys.size() + 1) * 3 > m_slots.size() * 2) {
+        DoGrow();
+    }
+
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Slot& slot = m_slots[i];
+        if (slot.key == EMPTY_SLOT) {
+            slot.hash = hash;
+            slot.key = m_keys.size();
+            m_keys.push_back(key);
+            return slot;
+        }
+        if (slot.hash == hash && m_keys[slot.key] == key) {
+            return slot;
+        }
+    }
+}
+
+void SmartCompletionUsageTable::DoGrow()
+{
+    std::vector<Slot> slots(m_slots.empty() ? INITIAL_SLOTS : m_slots.size() * 2);
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : m_slots) {
+        if (slot.key == EMPTY_SLOT) {
+            continue;
+        }
+        size_t i = slot.hash & mask;
+        while (slots[i].key != EMPTY_SLOT) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+    m_slots.swap(slots);
+}
+
+double SmartCompletionUsageTable::Add(const wxString& key, time_t now)
+{
+    Slot& slot = DoInsert(key, std::hash<wxString>()(key));
+    double score = Decay(slot.score, slot.lastUsed, now) + 1.0;
+    slot.score = score;
+    slot.lastUsed = now;
+    return score;
+}
+
+void SmartCompletionUsageTable::Set(const wxString& key, double score, time_t lastUsed)
+{
+    Slot& slot = DoInsert(key, std::hash<wxString>()(key));
+    slot.score = score;
+    slot.lastUsed = lastUsed;
+}
+
+double SmartCompletionUsageTable::GetScore(const wxString& key, time_t now) const
+{
+    const Slot* slot = DoFind(key, std::hash<wxString>()(key));
+    return slot ? Decay(slot->score, slot->lastUsed, now) : 0.0;
+}
+
+int SmartCompletionUsageTable::GetWeight(const wxString& key, time_t now) const
+{
+    const Slot* slot = DoFind(key, std::hash<wxString>()(key));
+    if (!slot) {
+        return 0;
+    }
+    // an entry that was used keeps a positive weight
+    return std::max(1, (int)std::lround(Decay(slot->score, slot->lastUsed, now) * 100.0));
+}
+
+void SmartCompletionUsageTable::GetScores(const wxString& prefix, time_t now,
+                                          std::vector<std::pair<wxString, double>>& scores) const
+{
+    for (const Slot& slot : m_slots) {
+        if (slot.key == EMPTY_SLOT) {
+            continue;
+        }
+        const wxString& key = m_keys[slot.key];
+        if (key.StartsWith(prefix)) {
+            scores.push_back({ key, Decay(slot.score, slot.lastUsed, now) });
+        }
+    }
+}
+
+void SmartCompletionUsageTable::Clear()
+{
+    m_slots.clear();
+    m_keys.clear();
+}
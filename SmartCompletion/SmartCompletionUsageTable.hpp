@@ -0,0 +1,85 @@
+#ifndef SMARTCOMPLETIONUSAGETABLE_HPP
+#define SMARTCOMPLETIONUSAGETABLE_HPP
+
+#include "wxStringHash.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <utility>
+#include <vector>
+#include <wx/string.h>
+
+/// The usage of the entries of a category (code completion entries, GotoAnything entries...) with decaying weights.
+///
+/// Every use of an entry adds 1 to its score, and the score halves every HALF_LIFE seconds: the entries used recently
+/// and often come first, old habits fade away. The table is a flat, open addressing hash table of small slots (hash,
+/// score, time of the last use); the keys are kept aside and only compared on a hash hit.
+///
+/// The table is not thread safe: it is updated and queried from the main thread
+class SmartCompletionUsageTable
+{
+public:
+    /// 30 days
+    static constexpr time_t HALF_LIFE = 30 * 24 * 3600;
+    /// the entries with a lower score are not worth keeping
+    static constexpr double MIN_SCORE = 0.05;
+
+protected:
+    static constexpr uint32_t EMPTY_SLOT = (uint32_t)-1;
+
+    struct Slot {
+        size_t hash = 0;
+        /// index in m_keys, EMPTY_SLOT for a free slot
+        uint32_t key = EMPTY_SLOT;
+        float score = 0.0;
+        uint32_t lastUsed = 0;
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<wxString> m_keys;
+
+protected:
+    const Slot* DoFind(const wxString& key, size_t hash) const;
+    Slot& DoInsert(const wxString& key, size_t hash);
+    void DoGrow();
+
+public:
+    SmartCompletionUsageTable() = default;
+    ~SmartCompletionUsageTable() = default;
+
+    /**
+     * @brief the score of `score`, last updated at `lastUsed`, at the time `now`
+     */
+    static double Decay(double score, time_t lastUsed, time_t now);
+
+    /**
+     * @brief record a use of `key` at `now` and return its new score
+     */
+    double Add(const wxString& key, time_t now);
+
+    /**
+     * @brief set the score of `key`, as it was at `lastUsed`
+     */
+    void Set(const wxString& key, double score, time_t lastUsed);
+
+    /**
+     * @brief the score of `key` at `now`, 0 if it was never used
+     */
+    double GetScore(const wxString& key, time_t now) const;
+
+    /**
+     * @brief the score of `key` at `now` as an integer weight (a hundredth of a use), 0 if it was never used
+     */
+    int GetWeight(const wxString& key, time_t now) const;
+
+    /**
+     * @brief collect the keys starting with `prefix` and their score at `now`
+     */
+    void GetScores(const wxString& prefix, time_t now, std::vector<std::pair<wxString, double>>& scores) const;
+
+    size_t GetCount() const { return m_keys.size(); }
+    bool IsEmpty() const { return m_keys.empty(); }
+    void Clear();
+};
+
+#endif // SMARTCOMPLETIONUSAGETABLE_HPP
@@ -13,8 +13,6 @@ SmartCompletionsConfig& SmartCompletionsConfig::Load()
     clConfig conf("SmartCompletions.conf");
     conf.ReadItem(this);
     m_db.Open();
-    m_db.LoadCCUsageTable(m_CCweight);
-    m_db.LoadGTAUsageTable(m_GTAweight);
     return *this;
 }
 
@@ -3,8 +3,6 @@
 
 #include "SmartCompletionUsageDB.h"
 #include "cl_config.h"
-#include "wxStringHash.h"
-#include <unordered_map>
 
 class SmartCompletionsConfig : public clConfigItem
 {
@@ -18,8 +16,6 @@ public:
 
 protected:
     size_t m_flags;
-    std::unordered_map<wxString, int> m_CCweight;
-    std::unordered_map<wxString, int> m_GTAweight;
     SmartCompletionUsageDB m_db;
 
 public:
@@ -31,8 +27,8 @@ public:
 
     bool IsEnabled() const { return m_flags & kEnabled; }
     void SetEnabled(bool b) { b ? m_flags |= kEnabled : m_flags &= ~kEnabled; }
-    std::unordered_map<wxString, int>& GetCCWeightTable() { return m_CCweight; }
-    std::unordered_map<wxString, int>& GetGTAWeightTable() { return m_GTAweight; }
+    SmartCompletionUsageTable& GetCCWeightTable() { return m_db.GetCCUsageTable(); }
+    SmartCompletionUsageTable& GetGTAWeightTable() { return m_db.GetGTAUsageTable(); }
     SmartCompletionUsageDB& GetUsageDb() { return m_db; }
 };
 
@@ -3,6 +3,7 @@
 #include "codelite_events.h"
 #include "event_notifier.h"
 #include "macros.h"
+#include "open_resource_dialog.h"
 #include <algorithm>
 #include <queue>
 #include <wx/menu.h>
@@ -35,6 +36,8 @@ SmartCompletion::SmartCompletion(IManager* manager)
     EventNotifier::Get()->Bind(wxEVT_CCBOX_SHOWING, &SmartCompletion::OnCodeCompletionShowing, this);
     EventNotifier::Get()->Bind(wxEVT_GOTO_ANYTHING_SORT_NEEDED, &SmartCompletion::OnGotoAnythingSort, this);
     EventNotifier::Get()->Bind(wxEVT_GOTO_ANYTHING_SELECTED, &SmartCompletion::OnGotoAnythingSelectionMade, this);
+    EventNotifier::Get()->Bind(wxEVT_OPEN_RESOURCE_USAGE_NEEDED, &SmartCompletion::OnOpenResourceUsageNeeded, this);
+    EventNotifier::Get()->Bind(wxEVT_OPEN_RESOURCE_FILES_OPENED, &SmartCompletion::OnOpenResourceFilesOpened, this);
     m_config.Load();
     m_pCCWeight = &m_config.GetCCWeightTable();
     m_pGTAWeight = &m_config.GetGTAWeightTable();
@@ -60,10 +63,13 @@ void SmartCompletion::CreatePluginMenu(wxMenu* pluginsMenu)
 void SmartCompletion::UnPlug()
 {
     m_config.Save();
+    m_config.GetUsageDb().Close();
     EventNotifier::Get()->Unbind(wxEVT_CCBOX_SELECTION_MADE, &SmartCompletion::OnCodeCompletionSelectionMade, this);
     EventNotifier::Get()->Unbind(wxEVT_CCBOX_SHOWING, &SmartCompletion::OnCodeCompletionShowing, this);
     EventNotifier::Get()->Unbind(wxEVT_GOTO_ANYTHING_SORT_NEEDED, &SmartCompletion::OnGotoAnythingSort, this);
     EventNotifier::Get()->Unbind(wxEVT_GOTO_ANYTHING_SELECTED, &SmartCompletion::OnGotoAnythingSelectionMade, this);
+    EventNotifier::Get()->Unbind(wxEVT_OPEN_RESOURCE_USAGE_NEEDED, &SmartCompletion::OnOpenResourceUsageNeeded, this);
+    EventNotifier::Get()->Unbind(wxEVT_OPEN_RESOURCE_FILES_OPENED, &SmartCompletion::OnOpenResourceFilesOpened, this);
     m_mgr->GetTheApp()->Unbind(wxEVT_MENU, &SmartCompletion::OnSettings, this, XRCID("smart_completion_settings"));
 }
 
@@ -75,16 +81,8 @@ void SmartCompletion::OnCodeCompletionSelectionMade(clCodeCompletionEvent& event
 
     CHECK_PTR_RET(event.GetEntry());
 
-    // Collect info about this match
-    WeightTable_t& T = *m_pCCWeight;
-    // we have an associated tag
-    wxString k = event.GetEntry()->GetText();
-    if(T.count(k) == 0) {
-        T[k] = 1;
-    } else {
-        T[k]++;
-    }
-    m_config.GetUsageDb().StoreCCUsage(k, T[k]);
+    // Collect info about this match. The DB is updated in the background
+    m_config.GetUsageDb().StoreCCUsage(event.GetEntry()->GetText());
 }
 
 void SmartCompletion::OnCodeCompletionShowing(clCodeCompletionEvent& event)
@@ -100,12 +98,13 @@ void SmartCompletion::OnCodeCompletionShowing(clCodeCompletionEvent& event)
     // so we split the list into 2: entries with weight geater than 0 and 0
     wxCodeCompletionBoxEntry::Vec_t importantEntries;
     wxCodeCompletionBoxEntry::Vec_t normalEntries;
+    time_t now = time(nullptr);
     wxCodeCompletionBoxEntry::Vec_t::iterator iter = entries.begin();
     for(; iter != entries.end(); ++iter) {
         wxCodeCompletionBoxEntry::Ptr_t entry = (*iter);
-        wxString k = entry->GetText();
-        if(m_pCCWeight->count(k)) {
-            entry->SetWeight((*m_pCCWeight)[k]);
+        int weight = m_pCCWeight->GetWeight(entry->GetText(), now);
+        if(weight > 0) {
+            entry->SetWeight(weight);
             importantEntries.push_back(entry);
         } else {
             normalEntries.push_back(entry);
@@ -139,14 +138,15 @@ void SmartCompletion::OnGotoAnythingSort(clGotoEvent& event)
     // Sort the entries by their weight
     clGotoEntry::Vec_t& entries = event.GetEntries();
     WeightTable_t& T = *m_pGTAWeight;
+    time_t now = time(nullptr);
     // We dont want to mess with the default sorting. We just want to place the ones with weight at the top
     // so we split the list into 2: entries with weight geater than 0 and 0
     std::vector<std::pair<int, clGotoEntry>> importantEntries;
     clGotoEntry::Vec_t normalEntries;
     std::for_each(entries.begin(), entries.end(), [&](const clGotoEntry& entry) {
-        if(T.count(entry.GetDesc())) {
+        int weight = T.GetWeight(entry.GetDesc(), now);
+        if(weight > 0) {
             // This item has weight
-            int weight = T[entry.GetDesc()];
             importantEntries.push_back({ weight, entry });
         } else {
             normalEntries.push_back(entry);
@@ -172,14 +172,40 @@ void SmartCompletion::OnGotoAnythingSelectionMade(clGotoEvent& event)
     if(!m_config.IsEnabled())
         return;
 
-    // Collect info about this match
-    WeightTable_t& T = *m_pGTAWeight;
+    // Collect info about this match. The DB is updated in the background
+    m_config.GetUsageDb().StoreGTAUsage(event.GetEntry().GetDesc());
+}
+
+// The open resource dialog usage is kept in the GTA table, under this prefix
+#define OPEN_RESOURCE_PREFIX "open_resource:"
+
+void SmartCompletion::OnOpenResourceUsageNeeded(clCommandEvent& event)
+{
+    event.Skip();
+    if(!m_config.IsEnabled())
+        return;
+
+    // The files the user opened, most used first
+    const wxString prefix = OPEN_RESOURCE_PREFIX;
+    std::vector<std::pair<wxString, double>> files;
+    m_pGTAWeight->GetScores(prefix, time(nullptr), files);
+    std::sort(files.begin(), files.end(), [](const std::pair<wxString, double>& a,
+                                             const std::pair<wxString, double>& b) { return a.second > b.second; });
+
+    wxArrayString& strings = event.GetStrings();
+    strings.reserve(strings.size() + files.size());
+    for(const auto& p : files) {
+        strings.Add(p.first.Mid(prefix.length()));
+    }
+}
+
+void SmartCompletion::OnOpenResourceFilesOpened(clCommandEvent& event)
+{
+    event.Skip();
+    if(!m_config.IsEnabled())
+        return;
 
-    const wxString& key = event.GetEntry().GetDesc();
-    if(T.count(key) == 0) {
-        T[key] = 1;
-    } else {
-        T[key]++;
+    for(const wxString& file : event.GetStrings()) {
+        m_config.GetUsageDb().StoreGTAUsage(OPEN_RESOURCE_PREFIX + file);
     }
-    m_config.GetUsageDb().StoreGTAUsage(key, T[key]);
 }
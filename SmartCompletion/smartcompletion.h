@@ -5,12 +5,10 @@
 #include "cl_command_event.h"
 #include "database/entry.h"
 #include "plugin.h"
-#include "wxStringHash.h"
-#include <unordered_map>
 
 class SmartCompletion : public IPlugin
 {
-    typedef std::unordered_map<wxString, int> WeightTable_t;
+    typedef SmartCompletionUsageTable WeightTable_t;
     WeightTable_t* m_pCCWeight;
     WeightTable_t* m_pGTAWeight;
     typedef std::pair<TagEntryPtr, int> QueueElement_t;
@@ -21,6 +19,8 @@ protected:
     void OnCodeCompletionShowing(clCodeCompletionEvent& event);
     void OnGotoAnythingSort(clGotoEvent& event);
     void OnGotoAnythingSelectionMade(clGotoEvent& event);
+    void OnOpenResourceUsageNeeded(clCommandEvent& event);
+    void OnOpenResourceFilesOpened(clCommandEvent& event);
     void OnSettings(wxCommandEvent& e);
 
 public:
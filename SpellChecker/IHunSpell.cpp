@@ -49,9 +49,13 @@
 #include "CorrectSpellingDlg.h"
 #include "IHunSpell.h"
 #include "ctags_manager.h"
+#include "lexer_configuration.h"
 #include "scGlobals.h"
 #include "spellcheck.h"
 
+#include <algorithm>
+#include <array>
+#include <string_view>
 #include <wx/arrimpl.cpp>
 #include <wx/filename.h>
 #include <wx/regex.h>
@@ -166,6 +170,25 @@ void HighlightWord(IEditor* editor, int pos)
     editor->SetUserIndicator(indicator_start, len);
 }
 
+/// The delimiters are ASCII: the bytes of the UTF-8 sequences are never delimiters
+const std::array<bool, 256>& GetDelimitersTable()
+{
+    static const std::array<bool, 256> table = []() {
+        std::array<bool, 256> t{};
+        for (size_t i = 0; i < s_defDelimiters.length(); ++i) {
+            t[(unsigned char)s_defDelimiters[i].GetValue()] = true;
+        }
+        return t;
+    }();
+    return table;
+}
+
+size_t HashLine(std::string_view text, std::string_view styles)
+{
+    size_t h = std::hash<std::string_view>()(text);
+    return h ^ (std::hash<std::string_view>()(styles) + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
 } // namespace
 
 // ------------------------------------------------------------
@@ -178,12 +201,14 @@ IHunSpell::IHunSpell()
     , m_pPlugIn(nullptr)
     , m_pSpellDlg(nullptr)
     , m_scanners(0)
+    , m_cancel(false)
 {
     InitLanguageList();
 }
 // ------------------------------------------------------------
 IHunSpell::~IHunSpell()
 {
+    StopContinuousCheck();
     CloseEngine();
 
     if (m_pSpellDlg != NULL)
@@ -196,6 +221,8 @@ bool IHunSpell::InitEngine()
     if (m_pSpell != NULL)
         return true;
 
+    std::lock_guard<std::mutex> lock(m_mutex);
+    InvalidateWords();
     m_ignoreList = CustomDictionary(0, StringHashOptionalCase(m_caseSensitiveUserDictionary),
                                     StringCompareOptionalCase(m_caseSensitiveUserDictionary));
     m_userDict = CustomDictionary(0, StringHashOptionalCase(m_caseSensitiveUserDictionary),
@@ -233,6 +260,8 @@ bool IHunSpell::InitEngine()
 // ------------------------------------------------------------
 void IHunSpell::CloseEngine()
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    InvalidateWords();
     if (m_pSpell != NULL) {
         Hunspell_destroy(m_pSpell);
         SaveUserDict(m_userDictPath + s_userDict);
@@ -241,6 +270,12 @@ void IHunSpell::CloseEngine()
 }
 // ------------------------------------------------------------
 bool IHunSpell::CheckWord(const wxString& word) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return DoCheckWord(word);
+}
+// ------------------------------------------------------------
+bool IHunSpell::DoCheckWord(const wxString& word) const
 {
     static thread_local wxRegEx rehex(s_dectHex, wxRE_ADVANCED);
 
@@ -276,6 +311,7 @@ wxArrayString IHunSpell::GetSuggestions(const wxString& misspelled)
     wxArrayString suggestions;
     suggestions.Empty();
 
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (m_pSpell) {
         char** wlst;
 
@@ -298,6 +334,15 @@ void IHunSpell::CheckSpelling()
     CHECK_PTR_RET(pEditor);
     CHECK_COND_RET(InitEngine());
 
+    if (m_pPlugIn->GetCheckContinuous()) {
+        CheckSpellingContinuous(pEditor);
+        return;
+    }
+
+    // the interactive check moves and clears the indicators of the continuous check
+    StopContinuousCheck();
+    ResetContinuousCheck(pEditor);
+
     bool error = false;
     wxString text = pEditor->GetEditorText() + " ";
 
@@ -327,10 +372,10 @@ void IHunSpell::CheckSpelling()
         // Now parse each line separately
         wxStringTokenizer tkz(lines[line_number], s_defDelimiters);
         int offset = 0;
+        int line_start_pos = pEditor->PosFromLine(line_number);
         while (tkz.HasMoreTokens()) {
             wxString token = tkz.GetNextToken();
 
-            int line_start_pos = pEditor->PosFromLine(line_number);
             int pos = tkz.GetPosition() - token.length() + line_start_pos;
             // incase the current token real length is greater than the normal len
             // include it in the offset
@@ -399,6 +444,219 @@ void IHunSpell::CheckSpelling()
     }
 }
 // ------------------------------------------------------------
+bool IHunSpell::CheckSpellingContinuous(IEditor* editor)
+{
+    CHECK_PTR_RET_FALSE(editor);
+    if (m_thread) {
+        // the previous check is still running
+        return false;
+    }
+    CHECK_COND_RET_FALSE(InitEngine());
+
+    auto pass = std::make_shared<ContinuousCheckPass>();
+    pass->editor = editor;
+    pass->modificationCount = editor->GetModificationCount();
+    pass->generation = m_generation;
+
+    auto state = m_editorsState.find(editor);
+    if (state != m_editorsState.end() && state->second.generation == m_generation) {
+        pass->previousLines = state->second.lines;
+    }
+
+    auto strings = ALLOWED_STYLES_STRINGS.find(editor->GetLexerId());
+    if (strings != ALLOWED_STYLES_STRINGS.end()) {
+        pass->stringStyles = &strings->second;
+    }
+    auto comments = ALLOWED_STYLES_COMMENTS.find(editor->GetLexerId());
+    if (comments != ALLOWED_STYLES_COMMENTS.end()) {
+        pass->commentStyles = &comments->second;
+    }
+
+    // the only access to the editor: a copy of its text and styles
+    wxStyledTextCtrl* ctrl = editor->GetCtrl();
+    pass->styledText = ctrl->GetStyledText(0, ctrl->GetLength());
+
+    LOG_IF_TRACE { clDEBUG1() << "SpellChecker: checking file:" << editor->GetFileName() << endl; }
+    m_cancel.store(false);
+    m_pass = pass;
+    m_thread = new std::thread([this, pass]() {
+        DoCheckPass(*pass);
+        m_pPlugIn->CallAfter([this, pass]() { OnCheckPassDone(pass); });
+    });
+    return true;
+}
+// ------------------------------------------------------------
+void IHunSpell::DoCheckPass(ContinuousCheckPass& pass)
+{
+    // split the snapshot into the text and the styles
+    const char* styled = static_cast<const char*>(pass.styledText.GetData());
+    size_t length = pass.styledText.GetDataLen() / 2;
+    std::string text(length, 0);
+    std::string styles(length, 0);
+    std::vector<size_t> lineStarts = { 0 };
+    for (size_t i = 0; i < length; ++i) {
+        text[i] = styled[2 * i];
+        styles[i] = styled[2 * i + 1];
+        if (text[i] == '\n') {
+            lineStarts.push_back(i + 1);
+        }
+    }
+    pass.styledText.Clear();
+
+    size_t count = lineStarts.size();
+    lineStarts.push_back(length);
+    pass.lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t start = lineStarts[i];
+        size_t len = lineStarts[i + 1] - start;
+        pass.lines.push_back(HashLine({ text.data() + start, len }, { styles.data() + start, len }));
+    }
+
+    // skip the head and the tail of the document that did not change since the previous check
+    const std::vector<size_t>& previous = pass.previousLines;
+    size_t head = 0;
+    while (head < count && head < previous.size() && previous[head] == pass.lines[head]) {
+        ++head;
+    }
+    size_t tail = 0;
+    while (tail < count - head && tail < previous.size() - head &&
+           previous[previous.size() - 1 - tail] == pass.lines[count - 1 - tail]) {
+        ++tail;
+    }
+    pass.checkedStart = lineStarts[head];
+    pass.checkedEnd = lineStarts[count - tail];
+
+    const std::array<bool, 256>& delimiters = GetDelimitersTable();
+    auto is_style_allowed = [](const std::unordered_set<int>* allowed, int style) {
+        return !allowed /* no limit */ || allowed->count(style);
+    };
+
+    std::vector<posLen> tokens;
+    for (size_t line = head; line < count - tail; ++line) {
+        if (m_cancel.load()) {
+            return;
+        }
+
+        tokens.clear();
+        size_t pos = lineStarts[line];
+        size_t end = lineStarts[line + 1];
+        while (pos < end) {
+            if (delimiters[(unsigned char)text[pos]]) {
+                ++pos;
+                continue;
+            }
+
+            size_t start = pos;
+            size_t chars = 0;
+            for (; pos < end && !delimiters[(unsigned char)text[pos]]; ++pos) {
+                if (((unsigned char)text[pos] & 0xC0) != 0x80) {
+                    ++chars;
+                }
+            }
+
+            // ignore token shorter then MIN_TOKEN_LEN
+            if (chars <= MIN_TOKEN_LEN) {
+                continue;
+            }
+
+            // Check the style at the middle of the token
+            int style = (unsigned char)styles[start + (pos - start) / 2];
+            if (!is_style_allowed(pass.stringStyles, style) && !is_style_allowed(pass.commentStyles, style)) {
+                continue;
+            }
+            tokens.push_back({ (int)start, (int)(pos - start) });
+        }
+
+        if (tokens.empty()) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pSpell == NULL) {
+            // the engine was closed
+            return;
+        }
+
+        for (const posLen& token : tokens) {
+            std::string word(text.data() + token.first, token.second);
+            auto iter = m_wordsCache.find(word);
+            if (iter == m_wordsCache.end()) {
+                iter = m_wordsCache.insert({ word, DoCheckWord(wxString::FromUTF8(word.data(), word.length())) }).first;
+            }
+
+            if (!iter->second) {
+                pass.misspelled.push_back(token);
+            }
+        }
+    }
+}
+// ------------------------------------------------------------
+void IHunSpell::OnCheckPassDone(std::shared_ptr<ContinuousCheckPass> pass)
+{
+    if (pass != m_pass) {
+        // the check was stopped
+        return;
+    }
+    m_pass.reset();
+    m_thread->join();
+    wxDELETE(m_thread);
+
+    // the dictionaries changed while checking
+    CHECK_COND_RET(pass->generation == m_generation);
+    CHECK_COND_RET(m_pPlugIn->GetCheckContinuous());
+
+    // the editor must still be open, and unmodified: the results are positions in the snapshot
+    IEditor::List_t editors;
+    ::clGetManager()->GetAllEditors(editors);
+    CHECK_COND_RET(std::find(editors.begin(), editors.end(), pass->editor) != editors.end());
+    CHECK_COND_RET(pass->editor->GetModificationCount() == pass->modificationCount);
+
+    // the indicators of the lines that did not change moved along with their text
+    if (pass->checkedEnd > pass->checkedStart) {
+        wxStyledTextCtrl* ctrl = pass->editor->GetCtrl();
+        ctrl->SetIndicatorCurrent(INDICATOR_USER);
+        ctrl->IndicatorClearRange(pass->checkedStart, pass->checkedEnd - pass->checkedStart);
+        for (const posLen& word : pass->misspelled) {
+            pass->editor->SetUserIndicator(word.first, word.second);
+        }
+    }
+
+    EditorState& state = m_editorsState[pass->editor];
+    state.generation = pass->generation;
+    state.lines.swap(pass->lines);
+    LOG_IF_TRACE
+    {
+        clDEBUG1() << "SpellChecker: checked" << pass->checkedEnd - pass->checkedStart << "bytes of"
+                   << pass->editor->GetFileName() << endl;
+    }
+}
+// ------------------------------------------------------------
+void IHunSpell::StopContinuousCheck()
+{
+    if (m_thread) {
+        m_cancel.store(true);
+        m_thread->join();
+        wxDELETE(m_thread);
+    }
+    // its result, if already posted, is discarded
+    m_pass.reset();
+}
+// ------------------------------------------------------------
+void IHunSpell::ResetContinuousCheck(IEditor* editor)
+{
+    if (editor) {
+        m_editorsState.erase(editor);
+    } else {
+        m_editorsState.clear();
+    }
+}
+// ------------------------------------------------------------
+void IHunSpell::InvalidateWords()
+{
+    m_wordsCache.clear();
+    ++m_generation;
+}
+// ------------------------------------------------------------
 // tools
 // ------------------------------------------------------------
 wxString IHunSpell::GetCharacterEncoding()
@@ -416,7 +674,9 @@ void IHunSpell::AddWordToIgnoreList(const wxString& word)
     if (word.IsEmpty())
         return;
 
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_ignoreList.insert(word);
+    InvalidateWords();
 }
 // ------------------------------------------------------------
 void IHunSpell::AddWordToUserDict(const wxString& word)
@@ -424,7 +684,9 @@ void IHunSpell::AddWordToUserDict(const wxString& word)
     if (word.IsEmpty())
         return;
 
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_userDict.insert(word);
+    InvalidateWords();
 }
 // ------------------------------------------------------------
 bool IHunSpell::LoadUserDict(const wxString& filename)
@@ -581,6 +843,8 @@ void IHunSpell::EnableScannerType(int type, bool state)
 void IHunSpell::SetCaseSensitiveUserDictionary(const bool caseSensitiveUserDictionary)
 {
     if (caseSensitiveUserDictionary != m_caseSensitiveUserDictionary) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        InvalidateWords();
         m_caseSensitiveUserDictionary = caseSensitiveUserDictionary;
 
         // Re-order user dictionary and ignores.
@@ -598,6 +862,8 @@ void IHunSpell::SetCaseSensitiveUserDictionary(const bool caseSensitiveUserDicti
 
 void IHunSpell::AddWord(const wxString& word)
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    InvalidateWords();
 #if wxUSE_STL
     // Implicit conversions are disabled when building with wxUSE_STL=1
     Hunspell_add(m_pSpell, word.mb_str().data());
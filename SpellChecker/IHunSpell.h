@@ -38,11 +38,18 @@
 // ------------------------------------------------------------
 #include "wxStringHash.h"
 
+#include <atomic>
 #include <hunspell/hunspell.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 #include <wx/arrstr.h>
+#include <wx/buffer.h>
 #include <wx/hashmap.h>
 // ------------------------------------------------------------
 WX_DECLARE_STRING_HASH_MAP(wxString, languageMap);
@@ -96,6 +103,24 @@ private:
     bool m_isCaseSensitive;
 };
 
+/// One pass of the continuous check, over a snapshot of an editor. The lines are compared with the previous pass by
+/// their hash (text and styles): only the lines between the unchanged head and tail of the document are checked
+struct ContinuousCheckPass {
+    IEditor* editor = nullptr;
+    wxUint64 modificationCount = 0;
+    size_t generation = 0;
+    wxMemoryBuffer styledText; // text and style bytes, interleaved
+    const std::unordered_set<int>* stringStyles = nullptr;
+    const std::unordered_set<int>* commentStyles = nullptr;
+    std::vector<size_t> previousLines;
+
+    // results
+    std::vector<size_t> lines;
+    int checkedStart = 0; // the range of the checked lines
+    int checkedEnd = 0;
+    std::vector<posLen> misspelled;
+};
+
 class IHunSpell
 {
 public:
@@ -118,6 +143,11 @@ public:
     wxArrayString GetSuggestions(const wxString& misspelled);
     /// makes a spell check for the given plain text. Canceled is set to true when the user cancels.
     void CheckSpelling();
+    /// checks the lines of 'editor' modified since its last continuous check on a worker thread, then highlights the
+    /// misspelled words. Returns false if a check is still running.
+    bool CheckSpellingContinuous(IEditor* editor);
+    /// forgets the continuous checks of 'editor' (of all the editors if NULL): its next check covers all the lines.
+    void ResetContinuousCheck(IEditor* editor = nullptr);
     /// checks for predefined language names, which could be found in path
     void GetAvailableLanguageKeyNames(const wxString& path, wxArrayString& lang);
     /// returns the base filename for language key without extension
@@ -177,7 +207,17 @@ public:
 protected:
     using CustomDictionary = std::unordered_set<wxString, StringHashOptionalCase, StringCompareOptionalCase>;
 
+    struct EditorState {
+        size_t generation = 0;
+        std::vector<size_t> lines; // hash of each line at the last check
+    };
+
     void InitLanguageList();
+    bool DoCheckWord(const wxString& word) const;
+    void InvalidateWords();
+    void StopContinuousCheck();
+    void DoCheckPass(ContinuousCheckPass& pass);
+    void OnCheckPassDone(std::shared_ptr<ContinuousCheckPass> pass);
 
     bool LoadUserDict(const wxString& filename);
     bool SaveUserDict(const wxString& filename);
@@ -199,5 +239,13 @@ protected:
     partList m_parseValues; // list with position results for CPP parsing
 
     int m_scanners; // flags for scanner types
+
+    mutable std::mutex m_mutex;                         // guards the engine, the dictionaries and the words cache
+    std::unordered_map<std::string, bool> m_wordsCache; // UTF-8 word => correct
+    std::unordered_map<IEditor*, EditorState> m_editorsState;
+    std::thread* m_thread = nullptr; // the running continuous check
+    std::shared_ptr<ContinuousCheckPass> m_pass;
+    std::atomic_bool m_cancel;
+    size_t m_generation = 0; // changes when the results of the previous checks become stale
 };
 #endif // _HUNSPELLINTERFACE_
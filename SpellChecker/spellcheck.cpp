@@ -112,6 +112,7 @@ SpellCheck::~SpellCheck()
     m_topWin->Unbind(wxEVT_CONTEXT_MENU_EDITOR, &SpellCheck::OnContextMenu, this);
     m_topWin->Unbind(wxEVT_WORKSPACE_LOADED, &SpellCheck::OnWspLoaded, this);
     m_topWin->Unbind(wxEVT_WORKSPACE_CLOSED, &SpellCheck::OnWspClosed, this);
+    EventNotifier::Get()->Unbind(wxEVT_EDITOR_CLOSING, &SpellCheck::OnEditorClosing, this);
 
     m_topWin->Unbind(wxEVT_MENU, &SpellCheck::OnSuggestion, this, SPC_SUGGESTION_ID,
                      SPC_SUGGESTION_ID + maxSuggestions - 1);
@@ -157,6 +158,7 @@ void SpellCheck::Init()
     m_topWin->Bind(wxEVT_CONTEXT_MENU_EDITOR, &SpellCheck::OnContextMenu, this);
     m_topWin->Bind(wxEVT_WORKSPACE_LOADED, &SpellCheck::OnWspLoaded, this);
     m_topWin->Bind(wxEVT_WORKSPACE_CLOSED, &SpellCheck::OnWspClosed, this);
+    EventNotifier::Get()->Bind(wxEVT_EDITOR_CLOSING, &SpellCheck::OnEditorClosing, this);
 
     m_topWin->Bind(wxEVT_MENU, &SpellCheck::OnSuggestion, this, SPC_SUGGESTION_ID,
                    SPC_SUGGESTION_ID + maxSuggestions - 1);
@@ -399,10 +401,13 @@ void SpellCheck::OnTimer(wxTimerEvent& e)
         return;
     }
 
+    // The check runs in the background and only covers the lines modified since the previous one
+    if(!m_pEngine->CheckSpellingContinuous(editor)) {
+        return; // still checking, try again on the next tick
+    }
+
     m_pLastEditor = editor;
     m_lastModificationCount = modificationCount;
-    m_pLastEditor->ClearUserIndicators();
-    m_pEngine->CheckSpelling();
     m_forceCheck = false; // consume it
 }
 
@@ -441,6 +446,18 @@ void SpellCheck::OnWspLoaded(clWorkspaceEvent& e)
 // ------------------------------------------------------------
 void SpellCheck::OnWspClosed(clWorkspaceEvent& e) { e.Skip(); }
 // ------------------------------------------------------------
+void SpellCheck::OnEditorClosing(wxCommandEvent& e)
+{
+    e.Skip();
+    IEditor* editor = reinterpret_cast<IEditor*>(e.GetClientData());
+    CHECK_PTR_RET(editor);
+
+    if(editor == m_pLastEditor) {
+        m_pLastEditor = nullptr;
+    }
+    m_pEngine->ResetContinuousCheck(editor);
+}
+// ------------------------------------------------------------
 void SpellCheck::OnSuggestion(wxCommandEvent& e)
 {
     const auto editor = GetEditor();
@@ -502,6 +519,7 @@ void SpellCheck::ClearIndicatorsFromEditors()
     for(; iter != editors.end(); ++iter) {
         (*iter)->ClearUserIndicators();
     }
+    m_pEngine->ResetContinuousCheck();
 }
 
 // ------------------------------------------------------------
@@ -68,6 +68,7 @@ public:
     void OnTimer(wxTimerEvent& e);
     void OnWspLoaded(clWorkspaceEvent& e);
     void OnWspClosed(clWorkspaceEvent& e);
+    void OnEditorClosing(wxCommandEvent& e);
     void OnSuggestion(wxCommandEvent& e);
     void OnIgnoreWord(wxCommandEvent& e);
     void OnAddWord(wxCommandEvent& e);
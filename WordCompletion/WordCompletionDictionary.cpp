@@ -2,6 +2,8 @@
 #include "event_notifier.h"
 #include "codelite_events.h"
 #include <algorithm>
+#include <unordered_set>
+#include <vector>
 #include "globals.h"
 #include "ieditor.h"
 #include "imanager.h"
@@ -10,8 +12,8 @@
 WordCompletionDictionary::WordCompletionDictionary()
 {
     EventNotifier::Get()->Bind(wxEVT_ACTIVE_EDITOR_CHANGED, &WordCompletionDictionary::OnEditorChanged, this);
+    EventNotifier::Get()->Bind(wxEVT_EDITOR_CLOSING, &WordCompletionDictionary::OnEditorClosing, this);
     EventNotifier::Get()->Bind(wxEVT_ALL_EDITORS_CLOSED, &WordCompletionDictionary::OnAllEditorsClosed, this);
-    EventNotifier::Get()->Bind(wxEVT_FILE_SAVED, &WordCompletionDictionary::OnFileSaved, this);
 
     m_thread = new WordCompletionThread(this);
     m_thread->Start();
@@ -20,8 +22,15 @@ WordCompletionDictionary::WordCompletionDictionary()
 WordCompletionDictionary::~WordCompletionDictionary()
 {
     EventNotifier::Get()->Unbind(wxEVT_ACTIVE_EDITOR_CHANGED, &WordCompletionDictionary::OnEditorChanged, this);
+    EventNotifier::Get()->Unbind(wxEVT_EDITOR_CLOSING, &WordCompletionDictionary::OnEditorClosing, this);
     EventNotifier::Get()->Unbind(wxEVT_ALL_EDITORS_CLOSED, &WordCompletionDictionary::OnAllEditorsClosed, this);
-    EventNotifier::Get()->Unbind(wxEVT_FILE_SAVED, &WordCompletionDictionary::OnFileSaved, this);
+
+    // Stop listening to the editors that are still open
+    IEditor::List_t allEditors;
+    ::clGetManager()->GetAllEditors(allEditors);
+    for(IEditor* editor : allEditors) {
+        editor->GetCtrl()->Unbind(wxEVT_STC_MODIFIED, &WordCompletionDictionary::OnEditorModified, this);
+    }
 
     m_thread->Stop();   // Stop the thread
     wxDELETE(m_thread); // Delete it
@@ -31,93 +40,151 @@ void WordCompletionDictionary::OnEditorChanged(wxCommandEvent& event)
 {
     event.Skip();
 
-    // 1) Get a list of all open editors and set the compare it to the current cached files
+    // 1) Get a list of all open editors and set the compare it to the current cached editors
     //    and delete all "closed" editors
     // 2) Request to cache the newly opened file's words
     IEditor::List_t allEditors;
-    wxArrayString openEditors, cachedEditors, closedEditors;
     ::clGetManager()->GetAllEditors(allEditors);
 
-    std::for_each(allEditors.begin(), allEditors.end(), [&](IEditor* editor) {
-        openEditors.Add(editor->GetFileName().GetFullPath());
-    });
-
-    std::for_each(m_files.begin(), m_files.end(), [&](const std::pair<wxString, wxStringSet_t>& p) {
-        cachedEditors.Add(p.first);
-    });
-
-    // std::set_difference requires that both arrays will be sorted
-    openEditors.Sort();
-    cachedEditors.Sort();
+    std::unordered_set<wxStyledTextCtrl*> openEditors;
+    for(IEditor* editor : allEditors) {
+        openEditors.insert(editor->GetCtrl());
+    }
 
-    // Create a new array "closedEditors" which contains list of files that exists
-    // in the cachedEditors but not in openEditors list
-    std::set_difference(cachedEditors.begin(),
-                        cachedEditors.end(),
-                        openEditors.begin(),
-                        openEditors.end(),
-                        std::back_inserter(closedEditors));
+    std::vector<wxStyledTextCtrl*> closedEditors;
+    for(const auto& p : m_editors) {
+        if(openEditors.count(p.first) == 0) {
+            closedEditors.push_back(p.first);
+        }
+    }
 
-    for(size_t i = 0; i < closedEditors.size(); ++i) {
-        m_files.erase(closedEditors.Item(i));
+    // The controls of the closed editors are already destroyed
+    for(wxStyledTextCtrl* ctrl : closedEditors) {
+        DoRemoveEditor(ctrl, false);
     }
 
     // 2: cache the active editor
-    DoCacheActiveEditor(false);
+    DoCacheActiveEditor();
+}
+
+void WordCompletionDictionary::OnEditorClosing(wxCommandEvent& event)
+{
+    event.Skip();
+    IEditor* editor = reinterpret_cast<IEditor*>(event.GetClientData());
+    CHECK_PTR_RET(editor);
+    DoRemoveEditor(editor->GetCtrl(), true);
 }
 
 void WordCompletionDictionary::OnSuggestThread(const WordCompletionThreadReply& reply)
 {
-    // Remove the current file's dictionary
-    std::map<wxString, wxStringSet_t>::iterator iter = m_files.find(reply.filename.GetFullPath());
-    if(iter != m_files.end()) m_files.erase(iter);
+    auto iter = m_editors.find(reply.ctrl);
+    if(iter == m_editors.end() || !iter->second.pending || iter->second.requestId != reply.requestId) {
+        // closed in the meanwhile, or superseded by another request
+        return;
+    }
+
+    Editor& editor = iter->second;
+    if(editor.modified) {
+        // the reply does not match the editor content anymore
+        DoQueueEditor(iter->first, editor);
+        return;
+    }
 
     // Keep the words
-    m_files.insert(std::make_pair(reply.filename.GetFullPath(), reply.suggest));
+    editor.pending = false;
+    m_index.SetDocument(reply.ctrl, reply.lines);
 }
 
 void WordCompletionDictionary::OnAllEditorsClosed(wxCommandEvent& event)
 {
     event.Skip();
-    m_files.clear();
+    m_editors.clear();
+    m_index.Clear();
 }
 
-void WordCompletionDictionary::DoCacheActiveEditor(bool overwrite)
+void WordCompletionDictionary::OnEditorModified(wxStyledTextEvent& event)
+{
+    event.Skip();
+    if(!(event.GetModificationType() & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))) {
+        return;
+    }
+
+    wxStyledTextCtrl* stc = dynamic_cast<wxStyledTextCtrl*>(event.GetEventObject());
+    CHECK_PTR_RET(stc);
+    auto iter = m_editors.find(stc);
+    if(iter == m_editors.end()) {
+        return;
+    }
+
+    Editor& editor = iter->second;
+    if(editor.pending) {
+        editor.modified = true;
+        return;
+    }
+
+    // Shift the lines of the index as the editor did, then parse the modified lines again
+    int line = stc->LineFromPosition(event.GetPosition());
+    int linesAdded = event.GetLinesAdded();
+    if(linesAdded > 0) {
+        m_index.InsertLines(stc, line + 1, linesAdded);
+    } else if(linesAdded < 0) {
+        m_index.DeleteLines(stc, line + 1, -linesAdded);
+    }
+
+    int lastLine = line + std::max(linesAdded, 0);
+    wxString text = stc->GetTextRange(stc->PositionFromLine(line), stc->GetLineEndPosition(lastLine));
+    std::vector<wxArrayString> lines;
+    WordCompletionThread::ParseLines(text, lines);
+    for(size_t i = 0; i < lines.size() && (line + (int)i) <= lastLine; ++i) {
+        m_index.UpdateLine(stc, line + i, lines[i]);
+    }
+}
+
+void WordCompletionDictionary::DoCacheActiveEditor()
 {
     // Step 2: cache the active editor (if not already cached)
     IEditor* activeEditor = ::clGetManager()->GetActiveEditor();
     CHECK_PTR_RET(activeEditor);
 
-    if(!overwrite && m_files.count(activeEditor->GetFileName().GetFullPath()))
-        return; // we already have this file in the cache
-        
-    m_files.erase(activeEditor->GetFileName().GetFullPath());
-    
-    // Insert a dummy entry, so we won't queue this file if not needed
-    m_files.insert(std::make_pair(activeEditor->GetFileName().GetFullPath(), wxStringSet_t()));
-    
-    // Queue this file
-    wxStyledTextCtrl* stc = activeEditor->GetCtrl();
-    
+    wxStyledTextCtrl* ctrl = activeEditor->GetCtrl();
+    if(m_editors.count(ctrl))
+        return; // we already have this editor in the cache, the index follows its modifications
+
+    Editor& editor = m_editors[ctrl];
+    ctrl->Bind(wxEVT_STC_MODIFIED, &WordCompletionDictionary::OnEditorModified, this);
+    DoQueueEditor(ctrl, editor);
+}
+
+void WordCompletionDictionary::DoQueueEditor(wxStyledTextCtrl* ctrl, Editor& editor)
+{
+    editor.pending = true;
+    editor.modified = false;
+    editor.requestId = ++m_lastRequestId;
+
     // Invoke the thread to parse and suggets words for this file
     WordCompletionThreadRequest* req = new WordCompletionThreadRequest;
-    req->buffer = stc->GetText();
-    req->filename = activeEditor->GetFileName();
+    req->buffer = ctrl->GetText();
+    req->ctrl = ctrl;
+    req->requestId = editor.requestId;
     req->filter = "filter";
     m_thread->Add(req);
 }
 
-void WordCompletionDictionary::OnFileSaved(clCommandEvent& event)
+void WordCompletionDictionary::DoRemoveEditor(wxStyledTextCtrl* ctrl, bool unbind)
 {
-    event.Skip();
-    DoCacheActiveEditor(true);
+    auto iter = m_editors.find(ctrl);
+    if(iter == m_editors.end()) {
+        return;
+    }
+
+    if(unbind) {
+        ctrl->Unbind(wxEVT_STC_MODIFIED, &WordCompletionDictionary::OnEditorModified, this);
+    }
+    m_index.RemoveDocument(ctrl);
+    m_editors.erase(iter);
 }
 
-wxStringSet_t WordCompletionDictionary::GetWords() const
+void WordCompletionDictionary::FindWords(const wxString& filter, bool prefix, wxStringSet_t& words) const
 {
-    wxStringSet_t words;
-    std::for_each(m_files.begin(), m_files.end(), [&](const std::pair<wxString, wxStringSet_t>& p){
-        words.insert(p.second.begin(), p.second.end());
-    });
-    return words;
+    m_index.Find(filter, prefix, words);
 }
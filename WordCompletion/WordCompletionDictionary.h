@@ -29,22 +29,42 @@
 #include "macros.h"
 #include <wx/string.h>
 #include <wx/event.h>
+#include "WordCompletionIndex.hpp"
 #include "WordCompletionThread.h"
 #include "WordCompletionRequestReply.h"
 #include "cl_command_event.h"
+#include <unordered_map>
 
+class wxStyledTextCtrl;
+class wxStyledTextEvent;
 class WordCompletionDictionary : public wxEvtHandler
 {
-    std::map<wxString, wxStringSet_t> m_files;
+    struct Editor {
+        /// the request sent to the thread last, its reply is the only one accepted
+        size_t requestId = 0;
+        /// the thread is parsing this editor
+        bool pending = false;
+        /// the editor was modified while the thread was parsing it
+        bool modified = false;
+    };
+
+    /// the editors being indexed. Keyed by control, as the documents of the index: the file name of an editor changes
+    /// on "Save As" and the untitled editors share their name
+    std::unordered_map<wxStyledTextCtrl*, Editor> m_editors;
+    WordCompletionIndex m_index;
     WordCompletionThread* m_thread;
+    size_t m_lastRequestId = 0;
 
 protected:
     void OnEditorChanged(wxCommandEvent& event);
+    void OnEditorClosing(wxCommandEvent& event);
     void OnAllEditorsClosed(wxCommandEvent& event);
-    void OnFileSaved(clCommandEvent& event);
+    void OnEditorModified(wxStyledTextEvent& event);
 
 private:
-    void DoCacheActiveEditor(bool overwrite);
+    void DoCacheActiveEditor();
+    void DoQueueEditor(wxStyledTextCtrl* ctrl, Editor& editor);
+    void DoRemoveEditor(wxStyledTextCtrl* ctrl, bool unbind);
 
 public:
     WordCompletionDictionary();
@@ -57,9 +77,10 @@ public:
     void OnSuggestThread(const WordCompletionThreadReply& reply);
     
     /**
-     * @brief return a set of words from the current editors
+     * @brief add to `words` the words of the open editors that start with `filter` (or contain it, when `prefix` is
+     * false)
      */
-    wxStringSet_t GetWords() const;
+    void FindWords(const wxString& filter, bool prefix, wxStringSet_t& words) const;
 };
 
 #endif // WORDCOMPLETIONDICTIONARY_H
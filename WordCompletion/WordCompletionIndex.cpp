@@ -0,0 +1,176 @@
+#include "WordCompletionIndex.hpp"
+
+#include <algorithm>
+
+WordCompletionIndex::WordId WordCompletionIndex::Intern(const wxString& word)
+{
+    auto iter = m_ids.find(word);
+    if (iter != m_ids.end()) {
+        return iter->second;
+    }
+
+    WordId id;
+    if (!m_freeIds.empty()) {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+        m_words[id] = word;
+    } else {
+        id = m_words.size();
+        m_words.push_back(word);
+        m_documentsCount.push_back(0);
+    }
+    m_ids.insert({ word, id });
+    m_sorted.insert({ word.Lower(), id });
+    return id;
+}
+
+void WordCompletionIndex::Release(WordId id)
+{
+    if (--m_documentsCount[id] > 0) {
+        return;
+    }
+
+    // no document contains this word anymore
+    const wxString& word = m_words[id];
+    m_sorted.erase({ word.Lower(), id });
+    m_ids.erase(word);
+    m_words[id].clear();
+    m_freeIds.push_back(id);
+}
+
+void WordCompletionIndex::AddLineWords(Document& doc, std::vector<WordId>& line, const wxArrayString& words)
+{
+    line.reserve(words.size());
+    for (const wxString& word : words) {
+        WordId id = Intern(word);
+        line.push_back(id);
+        if (doc.counts[id]++ == 0) {
+            ++m_documentsCount[id];
+        }
+    }
+}
+
+void WordCompletionIndex::RemoveLineWords(Document& doc, std::vector<WordId>& line)
+{
+    for (WordId id : line) {
+        auto iter = doc.counts.find(id);
+        if (iter == doc.counts.end()) {
+            continue;
+        }
+        if (--iter->second == 0) {
+            doc.counts.erase(iter);
+            Release(id);
+        }
+    }
+    line.clear();
+}
+
+void WordCompletionIndex::SetDocument(wxStyledTextCtrl* ctrl, const std::vector<wxArrayString>& lines)
+{
+    RemoveDocument(ctrl);
+
+    Document& doc = m_documents[ctrl];
+    doc.lines.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        AddLineWords(doc, doc.lines[i], lines[i]);
+    }
+}
+
+void WordCompletionIndex::RemoveDocument(wxStyledTextCtrl* ctrl)
+{
+    auto iter = m_documents.find(ctrl);
+    if (iter == m_documents.end()) {
+        return;
+    }
+
+    for (const auto& vt : iter->second.counts) {
+        Release(vt.first);
+    }
+    m_documents.erase(iter);
+}
+
+void WordCompletionIndex::Clear()
+{
+    m_words.clear();
+    m_documentsCount.clear();
+    m_freeIds.clear();
+    m_ids.clear();
+    m_sorted.clear();
+    m_documents.clear();
+}
+
+void WordCompletionIndex::InsertLines(wxStyledTextCtrl* ctrl, size_t line, size_t count)
+{
+    auto iter = m_documents.find(ctrl);
+    if (iter == m_documents.end()) {
+        return;
+    }
+
+    Document& doc = iter->second;
+    line = std::min(line, doc.lines.size());
+    doc.lines.insert(doc.lines.begin() + line, count, std::vector<WordId>());
+}
+
+void WordCompletionIndex::DeleteLines(wxStyledTextCtrl* ctrl, size_t line, size_t count)
+{
+    auto iter = m_documents.find(ctrl);
+    if (iter == m_documents.end()) {
+        return;
+    }
+
+    Document& doc = iter->second;
+    if (line >= doc.lines.size()) {
+        return;
+    }
+    count = std::min(count, doc.lines.size() - line);
+    for (size_t i = line; i < line + count; ++i) {
+        RemoveLineWords(doc, doc.lines[i]);
+    }
+    doc.lines.erase(doc.lines.begin() + line, doc.lines.begin() + line + count);
+}
+
+void WordCompletionIndex::UpdateLine(wxStyledTextCtrl* ctrl, size_t line, const wxArrayString& words)
+{
+    auto iter = m_documents.find(ctrl);
+    if (iter == m_documents.end()) {
+        return;
+    }
+
+    Document& doc = iter->second;
+    if (line >= doc.lines.size()) {
+        doc.lines.resize(line + 1);
+    }
+
+    // add the new words before removing the old ones: the words that stay are not released and interned again
+    std::vector<WordId> updated;
+    AddLineWords(doc, updated, words);
+    RemoveLineWords(doc, doc.lines[line]);
+    doc.lines[line].swap(updated);
+}
+
+void WordCompletionIndex::Find(const wxString& filter, bool prefix, wxStringSet_t& words) const
+{
+    wxString lcFilter = filter.Lower();
+    if (lcFilter.empty()) {
+        for (const auto& vt : m_ids) {
+            words.insert(vt.first);
+        }
+        return;
+    }
+
+    if (prefix) {
+        // the words starting with the filter are next to each other
+        for (auto iter = m_sorted.lower_bound({ lcFilter, 0 }); iter != m_sorted.end(); ++iter) {
+            if (!iter->first.StartsWith(lcFilter)) {
+                break;
+            }
+            words.insert(m_words[iter->second]);
+        }
+    } else {
+        for (const auto& vt : m_sorted) {
+            if (vt.first.Contains(lcFilter)) {
+                words.insert(m_words[vt.second]);
+            }
+        }
+    }
+}
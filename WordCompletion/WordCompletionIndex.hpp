@@ -0,0 +1,92 @@
+#ifndef WORDCOMPLETIONINDEX_HPP
+#define WORDCOMPLETIONINDEX_HPP
+
+#include "macros.h"
+#include "wxStringHash.h"
+
+#include <set>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+class wxStyledTextCtrl;
+
+/// The words of the open documents, kept up to date line by line.
+///
+/// Every distinct word is stored once, in an interned table, and the documents refer to it by id: per line (to update
+/// a modified line range without parsing the whole document again) and with an occurrences count. A word leaves the
+/// table when no document contains it anymore. The lower case words are kept sorted, so the words that start with a
+/// prefix are found without scanning the table. A document is identified by its editor control: several editors can
+/// share a name (e.g. the untitled ones), and the name changes on "Save As".
+///
+/// The index is not thread safe: it is updated and queried from the main thread
+class WordCompletionIndex
+{
+public:
+    typedef uint32_t WordId;
+
+protected:
+    struct Document {
+        /// the words of each line
+        std::vector<std::vector<WordId>> lines;
+        /// word => number of occurrences in this document
+        std::unordered_map<WordId, uint32_t> counts;
+    };
+
+    std::vector<wxString> m_words;
+    /// id => number of documents containing the word, 0 for a free slot
+    std::vector<uint32_t> m_documentsCount;
+    std::vector<WordId> m_freeIds;
+    std::unordered_map<wxString, WordId> m_ids;
+    /// (lower case word, id) of every word in the table
+    std::set<std::pair<wxString, WordId>> m_sorted;
+    std::unordered_map<wxStyledTextCtrl*, Document> m_documents;
+
+protected:
+    WordId Intern(const wxString& word);
+    void Release(WordId id);
+    void AddLineWords(Document& doc, std::vector<WordId>& line, const wxArrayString& words);
+    void RemoveLineWords(Document& doc, std::vector<WordId>& line);
+
+public:
+    WordCompletionIndex() = default;
+    ~WordCompletionIndex() = default;
+
+    /**
+     * @brief set the words of the document of `ctrl`, line by line, replacing the previous ones
+     */
+    void SetDocument(wxStyledTextCtrl* ctrl, const std::vector<wxArrayString>& lines);
+    void RemoveDocument(wxStyledTextCtrl* ctrl);
+    bool HasDocument(wxStyledTextCtrl* ctrl) const { return m_documents.count(ctrl) != 0; }
+    void Clear();
+
+    /**
+     * @brief `count` lines were inserted before `line`. They have no words until UpdateLine() is called
+     */
+    void InsertLines(wxStyledTextCtrl* ctrl, size_t line, size_t count);
+
+    /**
+     * @brief `count` lines, starting at `line`, were deleted
+     */
+    void DeleteLines(wxStyledTextCtrl* ctrl, size_t line, size_t count);
+
+    /**
+     * @brief replace the words of `line`
+     */
+    void UpdateLine(wxStyledTextCtrl* ctrl, size_t line, const wxArrayString& words);
+
+    /**
+     * @brief add to `words` the words of all the documents that start with `filter` (or contain it, when `prefix` is
+     * false), ignoring case. All the words are returned for an empty filter
+     */
+    void Find(const wxString& filter, bool prefix, wxStringSet_t& words) const;
+
+    /**
+     * @brief the number of distinct words
+     */
+    size_t GetWordsCount() const { return m_ids.size(); }
+};
+
+#endif // WORDCOMPLETIONINDEX_HPP
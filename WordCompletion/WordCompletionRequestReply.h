@@ -28,16 +28,28 @@
 
 #include "worker_thread.h"
 
+#include <vector>
+#include <wx/arrstr.h>
+
+class wxStyledTextCtrl;
+
 struct WordCompletionThreadRequest : public ThreadRequest {
     wxString buffer;
     wxString filter;
     wxFileName filename;
+    /// the editor of the buffer, never accessed by the thread
+    wxStyledTextCtrl* ctrl = nullptr;
+    /// identifies the request among the ones of the same editor
+    size_t requestId = 0;
     bool insertSingleMatch;
 };
 
 struct WordCompletionThreadReply {
-    wxStringSet_t suggest;
+    /// the words of each line of the buffer
+    std::vector<wxArrayString> lines;
     wxFileName filename;
+    wxStyledTextCtrl* ctrl = nullptr;
+    size_t requestId = 0;
     wxString filter;
     bool insertSingleMatch;
 };
@@ -21,30 +21,22 @@ void WordCompletionThread::ProcessRequest(ThreadRequest* request)
     WordCompletionThreadRequest* req = dynamic_cast<WordCompletionThreadRequest*>(request);
     CHECK_PTR_RET(req);
 
-    wxStringSet_t suggestsions;
-    ParseBuffer(req->buffer, suggestsions);
-
     // Parse and send back the reply
     WordCompletionThreadReply reply;
+    ParseLines(req->buffer, reply.lines);
     reply.filename = req->filename;
+    reply.ctrl = req->ctrl;
+    reply.requestId = req->requestId;
     reply.filter = req->filter;
     reply.insertSingleMatch = req->insertSingleMatch;
-    reply.suggest.swap(suggestsions);
     m_dict->CallAfter(&WordCompletionDictionary::OnSuggestThread, reply);
 }
 
-void WordCompletionThread::ParseBuffer(const wxString& buffer, wxStringSet_t& suggest)
+void WordCompletionThread::ParseLines(const wxString& buffer, std::vector<wxArrayString>& lines)
 {
-#if 0
-    wxArrayString filteredWords;
-    wxArrayString words = ::wxStringTokenize(buffer, "\r\n \t->./\\'\"[]()<>*&^%#!@+=:,;{}|/", wxTOKEN_STRTOK);
-    for(size_t i=0; i<words.size(); ++i) {
-        if(!wxIsdigit(words.Item(i).at(0))) {
-            filteredWords.Add(words.Item(i));
-        }
-    }
-    suggest.insert(filteredWords.begin(), filteredWords.end());
-#else
+    // a buffer of N line breaks has N+1 lines, even when they are empty
+    lines.clear();
+    lines.resize(1);
     WordScanner_t scanner = ::WordLexerNew(buffer);
     if(!scanner)
         return;
@@ -54,9 +46,12 @@ void WordCompletionThread::ParseBuffer(const wxString& buffer, wxStringSet_t& su
         switch(token.type) {
         case kWordDelim:
             if(!curword.empty()) {
-                suggest.insert(wxString(curword.c_str(), wxConvUTF8, curword.length()));
+                lines.back().Add(wxString(curword.c_str(), wxConvUTF8, curword.length()));
             }
             curword.clear();
+            if(token.text && token.text[0] == '\n') {
+                lines.emplace_back();
+            }
             break;
 
         case kWordNumber: {
@@ -70,6 +65,8 @@ void WordCompletionThread::ParseBuffer(const wxString& buffer, wxStringSet_t& su
             break;
         }
     }
+    if(!curword.empty()) {
+        lines.back().Add(wxString(curword.c_str(), wxConvUTF8, curword.length()));
+    }
     ::WordLexerDestroy(&scanner);
-#endif
 }
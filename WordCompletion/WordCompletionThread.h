@@ -45,9 +45,9 @@ public:
     virtual void ProcessRequest(ThreadRequest* request);
     
     /**
-     * @brief parse 'buffer' and return set of words to complete
+     * @brief parse 'buffer' and return the words of each of its lines
      */
-    static void ParseBuffer(const wxString& buffer, wxStringSet_t& suggest);
+    static void ParseLines(const wxString& buffer, std::vector<wxArrayString>& lines);
 };
 
 #endif // WORDCOMPLETIONTHREAD_H
@@ -4,7 +4,6 @@
 #include "Keyboard/clKeyboardManager.h"
 #include "WordCompletionDictionary.h"
 #include "WordCompletionSettingsDlg.h"
-#include "WordCompletionThread.h"
 #include "cl_command_event.h"
 #include "event_notifier.h"
 #include "globals.h"
@@ -105,22 +104,10 @@ void WordCompletionPlugin::OnWordComplete(clCodeCompletionEvent& event)
 
     wxString filter = event.GetWord().Lower(); // stc->GetTextRange(start, curPos);
 
-    wxStringSet_t words = m_dictionary->GetWords();
-    // Parse the current bufer (if modified), to include non saved words
-    if(activeEditor->IsEditorModified()) {
-        // For performance (this parsing is done in the main thread)
-        // only parse the visible area of the document
-        wxStringSet_t unsavedBufferWords;
-        wxStyledTextCtrl* stc = activeEditor->GetCtrl();
-        int startPos = stc->PositionFromLine(stc->GetFirstVisibleLine());
-        int endPos = stc->GetCurrentPos();
-
-        wxString buffer = stc->GetTextRange(startPos, endPos);
-        WordCompletionThread::ParseBuffer(buffer, unsavedBufferWords);
-
-        // Merge the results
-        words.insert(unsavedBufferWords.begin(), unsavedBufferWords.end());
-    }
+    // The words of the open editors, the index follows their modifications
+    bool prefix = settings.GetComparisonMethod() == WordCompletionSettings::kComparisonStartsWith;
+    wxStringSet_t words;
+    m_dictionary->FindWords(filter, prefix, words);
 
     // Get the editor keywords and add them
     LexerConf::Ptr_t lexer = ColoursAndFontsManager::Get().GetLexerForFile(activeEditor->GetFileName().GetFullName());
@@ -130,25 +117,19 @@ void WordCompletionPlugin::OnWordComplete(clCodeCompletionEvent& event)
             keywords << lexer->GetKeyWords(i) << " ";
         }
         wxArrayString langWords = ::wxStringTokenize(keywords, "\n\t \r", wxTOKEN_STRTOK);
-        words.insert(langWords.begin(), langWords.end());
+        for(const wxString& word : langWords) {
+            wxString lcWord = word.Lower();
+            if(filter.IsEmpty() || (prefix ? lcWord.StartsWith(filter) : lcWord.Contains(filter))) {
+                words.insert(word);
+            }
+        }
     }
 
+    // Don't suggest what the user has already typed
     wxStringSet_t filterdSet;
-    if(filter.IsEmpty()) {
-        filterdSet.swap(words);
-    } else {
-        for(wxStringSet_t::iterator iter = words.begin(); iter != words.end(); ++iter) {
-            wxString word = *iter;
-            wxString lcWord = word.Lower();
-            if(settings.GetComparisonMethod() == WordCompletionSettings::kComparisonStartsWith) {
-                if(lcWord.StartsWith(filter) && filter != word) {
-                    filterdSet.insert(word);
-                }
-            } else {
-                if(lcWord.Contains(filter) && filter != word) {
-                    filterdSet.insert(word);
-                }
-            }
+    for(const wxString& word : words) {
+        if(filter != word) {
+            filterdSet.insert(word);
         }
     }
     wxCodeCompletionBoxEntry::Vec_t entries;
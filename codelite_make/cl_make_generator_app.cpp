@@ -295,10 +295,14 @@ void clMakeGeneratorApp::DoGenerateCompileCommands()
     }
 
     wxArrayString generated_paths;
-    JSON json(clCxxWorkspaceST::Get()->CreateCompileCommandsJSON(!m_generateCompileCommands, &generated_paths));
-    if(json.isOk()) {
-        // Save the file
-        json.save(fn);
+    if(m_generateCompileCommands) {
+        // an unchanged file is not reported, so clangd is not restarted for nothing
+        bool changed = false;
+        if(clCxxWorkspaceST::Get()->WriteCompileCommandsJSON(fn, changed) && changed) {
+            generated_paths.Add(fn.GetFullPath());
+        }
+    } else {
+        clCxxWorkspaceST::Get()->CreateCompileCommandsJSON(true, &generated_paths);
     }
     for(const wxString& path : generated_paths) {
         wxFprintf(stdout, "%s\n", path);
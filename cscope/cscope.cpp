@@ -305,10 +305,11 @@ wxString Cscope::DoCreateListFile(bool force)
     if(createFileList) {
         std::vector<wxFileName> files;
         if(clFileSystemWorkspace::Get().IsOpen()) {
-            const std::vector<wxFileName>& all_files = clFileSystemWorkspace::Get().GetFiles();
+            const std::vector<clPath>& all_files = clFileSystemWorkspace::Get().GetFiles();
             if(!all_files.empty()) {
                 files.reserve(all_files.size());
-                for(wxFileName fn : all_files) {
+                for(const clPath& path : all_files) {
+                    wxFileName fn = path.ToFileName();
                     wxString ext = fn.GetExt();
                     if(ext == "exe" || ext == "" || ext == "xpm" || ext == "png") {
                         continue;
@@ -10,6 +10,7 @@
 #include "Settings.hpp"
 #include "SimpleTokenizer.hpp"
 #include "clFilesCollector.h"
+#include "clFuzzyMatcher.hpp"
 #include "clTempFile.hpp"
 #include "clWildMatch.hpp"
 #include "ctags_manager.h"
@@ -290,6 +291,25 @@ TEST_FUNC(TestSplitArgsNoArgumentName)
     return true;
 }
 
+TEST_FUNC(TestFuzzyQueryCharactersInOrder)
+{
+    // the characters are found in order, but not at word starts
+    CHECK_BOOL(clFuzzyQuery("rn").Score("string_r.h") > 0);
+    CHECK_BOOL(clFuzzyQuery("ac").Score("xabc-a") > 0);
+    CHECK_BOOL(clFuzzyQuery("rn").Score("src/string.h") > 0);
+
+    std::vector<size_t> positions;
+    CHECK_BOOL(clFuzzyQuery("rn").Score("string_r.h", &positions) > 0);
+    CHECK_SIZE(positions.size(), 2);
+    CHECK_EXPECTED(positions[0], 2);
+    CHECK_EXPECTED(positions[1], 4);
+
+    // the characters are not all there, or not in order
+    CHECK_EXPECTED(clFuzzyQuery("nr").Score("string.h"), -1);
+    CHECK_EXPECTED(clFuzzyQuery("rz").Score("string_r.h"), -1);
+    return true;
+}
+
 TEST_FUNC(TestCompletionHelper_truncate_file_to_location)
 {
     CompletionHelper helper;